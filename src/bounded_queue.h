@@ -0,0 +1,187 @@
+#ifndef __BOUNDED_QUEUE_H__
+#define __BOUNDED_QUEUE_H__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+
+/**
+ * @brief Fixed-capacity lock-free FIFO queue.
+ * @details Any number of threads may push and pop concurrently. Each slot
+ *          carries a sequence number that tells producers and consumers
+ *          whether it is free or filled, so neither side ever waits on a
+ *          lock. The storage is allocated once when the queue is created,
+ *          and a push onto a full queue fails instead of blocking.
+ * @remarks The capacity is rounded up to a power of two.
+ */
+template<typename T>
+class BoundedQueue
+{
+public:
+
+    /**
+     * @brief Constructor for the bounded queue.
+     * @param[in] capacity The maximum number of queued items.
+     */
+    explicit BoundedQueue(size_t capacity)
+        : m_capacity(roundUp(capacity))
+        , m_mask(m_capacity - 1)
+        , m_cells(new Cell[m_capacity])
+        , m_enqueuePos(0)
+        , m_dequeuePos(0)
+    {
+        for (size_t i = 0; i < m_capacity; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Append an item.
+     * @param[in] item The item. Moved from only if it was queued.
+     * @return True if the item was queued; false if the queue is full.
+     */
+    bool push(T&& item)
+    {
+        size_t position = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = m_cells[position & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t difference =
+                static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+
+            if (difference == 0)
+            {
+                // The slot is free; claim it before filling it
+                if (m_enqueuePos.compare_exchange_weak(position, position + 1))
+                {
+                    cell.item = std::move(item);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The slot still holds an item from the previous lap
+                return false;
+            }
+            else
+            {
+                position = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove the oldest item.
+     * @param[out] item Receives the item.
+     * @return True if an item was removed; false if the queue is empty.
+     */
+    bool pop(T& item)
+    {
+        size_t position = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = m_cells[position & m_mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t difference =
+                static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+
+            if (difference == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(position, position + 1))
+                {
+                    item = std::move(cell.item);
+                    cell.item = T();
+                    cell.sequence.store(position + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The slot was not filled yet
+                return false;
+            }
+            else
+            {
+                position = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of queued items.
+     * @return The number of items. Only a snapshot while other threads push
+     *         or pop.
+     */
+    size_t size() const
+    {
+        const size_t dequeuePos = m_dequeuePos.load();
+        const size_t enqueuePos = m_enqueuePos.load();
+        return (enqueuePos > dequeuePos) ? (enqueuePos - dequeuePos) : 0;
+    }
+
+    /**
+     * @brief Get the maximum number of queued items.
+     * @return The capacity.
+     */
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+
+    /// One slot of the queue.
+    struct Cell
+    {
+        /// Tells whether the slot is free or filled for the current lap.
+        std::atomic<size_t> sequence;
+
+        /// The queued item.
+        T item;
+    };
+
+    /**
+     * @brief Round a capacity up to the next power of two.
+     * @param[in] capacity The requested capacity.
+     * @return The capacity used, at least 2.
+     */
+    static size_t roundUp(size_t capacity)
+    {
+        size_t rounded = 2;
+        while (rounded < capacity)
+        {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    /// The number of slots.
+    const size_t m_capacity;
+
+    /// Maps a position to its slot.
+    const size_t m_mask;
+
+    /// The slots.
+    std::unique_ptr<Cell[]> m_cells;
+
+    /// The next position to fill. Kept apart from m_dequeuePos to avoid false sharing.
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+
+    /// The next position to empty.
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+
+}; // End class BoundedQueue
+
+#endif
+
+/**
+ * @}
+ */
@@ -2,181 +2,151 @@
 #include "dds_data.h"
 #include "qos_dictionary.h"
 #include "open_dynamic_data.h"
+#include "flat_sample.h"
+#include "member_accessor.h"
+#include "serialized_sample.h"
 
+#include <QDateTime>
 #include <QMutexLocker>
+#include <QSettings>
+#include <QReadLocker>
+#include <QWriteLocker>
 
 #include <dds/DCPS/Service_Participant.h>
 #include <dds/DCPS/XTypes/Utils.h>
 
 #include <tao/AnyTypeCode/Any.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <limits>
 
 std::unique_ptr<DDSManager> CommonData::m_ddsManager;
-QMap<QString, QList<std::shared_ptr<OpenDynamicData> > > CommonData::m_samples;
-QMap<QString, QStringList> CommonData::m_sampleTimes;
+QMap<QString, std::shared_ptr<TopicSampleStore>> CommonData::m_sampleStores;
 QMap<QString, std::shared_ptr<TopicInfo>> CommonData::m_topicInfo;
-QMap<QString, QList<DDS::DynamicData_var> > CommonData::m_dynamicSamples;
-QMutex CommonData::m_sampleMutex;
+QReadWriteLock CommonData::m_sampleStoresLock;
 QMutex CommonData::m_topicMutex;
-QMutex CommonData::m_dynamicSamplesMutex;
-
-
-//------------------------------------------------------------------------------
-void CommonData::cleanup()
-{
-    {
-        QMutexLocker locker(&m_sampleMutex);
-        m_samples.clear();
-        m_sampleTimes.clear();
-    }
-
-    {
-        QMutexLocker locker(&m_topicMutex);
-        m_topicInfo.clear();
-    }
-
-    m_ddsManager.reset();
-}
-
-
-//------------------------------------------------------------------------------
-void CommonData::storeTopicInfo(const QString& topicName, std::shared_ptr<TopicInfo> info)
+int CommonData::m_defaultHistoryDepth = CommonData::DEFAULT_HISTORY_DEPTH;
+QMap<QString, int> CommonData::m_historyDepths;
+QMutex CommonData::m_historyDepthMutex;
+QMap<QString, IngestPolicy> CommonData::m_ingestPolicies;
+QMutex CommonData::m_ingestPolicyMutex;
+std::atomic<size_t> CommonData::m_memoryBudget(0);
+std::atomic<EvictionPolicy> CommonData::m_evictionPolicy(EvictionPolicy::OldestFirst);
+QMutex CommonData::m_evictionMutex;
+std::atomic<bool> CommonData::m_lazyDecoding(false);
+std::atomic<int> CommonData::m_decodeThreadCount(CommonData::DEFAULT_DECODE_THREADS);
+std::atomic<int> CommonData::m_decodeQueueDepth(CommonData::DEFAULT_DECODE_QUEUE_DEPTH);
+std::shared_ptr<DecodeWorkerPool> CommonData::m_decodeWorkerPool;
+std::vector<std::weak_ptr<DecodeQueue>> CommonData::m_decodeQueues;
+QMutex CommonData::m_decodeWorkerPoolMutex;
+
+
+namespace
 {
-    QMutexLocker locker(&m_topicMutex);
-    m_topicInfo[topicName] = info;
-}
 
-//------------------------------------------------------------------------------
-std::shared_ptr<TopicInfo> CommonData::getTopicInfo(const QString& topicName)
-{
-    QMutexLocker locker(&m_topicMutex);
+/// The maximum number of samples evicted from a store under one lock.
+const size_t EVICTION_QUOTA = 1024;
 
-    if (m_topicInfo.contains(topicName))
-    {
-        return m_topicInfo.value(topicName);
-    }
-    return std::shared_ptr<TopicInfo>();
-}
-
-QVariant CommonData::readMember(const QString& topicName,
-                                const QString& memberName,
-                                unsigned int index)
+/**
+ * @brief Convert the value of a primitive or string member to a QVariant.
+ * @details Works on both OpenDynamicData and FlatSample::Member, which share
+ *          the same read API.
+ * @param[in] member The target member.
+ * @return The value, or "NULL" if the member type is not supported.
+ */
+template<typename Member>
+QVariant memberValue(const Member& member)
 {
     QVariant value;
-    QMutexLocker locker(&m_sampleMutex);
-
-    // Make sure the index is valid
-    QList<std::shared_ptr<OpenDynamicData>>& sampleList = m_samples[topicName];
-    if (static_cast<int>(index) >= sampleList.count())
-    {
-        value = "NULL";
-        return value;
-    }
-
-    const std::shared_ptr<OpenDynamicData> targetSample = sampleList.at(index);
-    if (!targetSample)
-    {
-        value = "NULL";
-        return value;
-    }
-
-    // Find the target member within this sample
-    const std::shared_ptr<OpenDynamicData> targetMember =
-        targetSample->getMember(memberName.toUtf8().data());
-
-    if (!targetMember)
-    {
-        value = "NULL";
-        return value;
-    }
 
     // Store the value into a QVariant
     // The tmpValue may seem redundant, but it's very helpful for debug
-    CORBA::TCKind type = targetMember->getKind();
+    CORBA::TCKind type = member.getKind();
     switch (type)
     {
     case CORBA::tk_long:
     {
-        int32_t tmpValue = targetMember->getValue<int32_t>();
+        int32_t tmpValue = member.template getValue<int32_t>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_short:
     {
-        int16_t tmpValue = targetMember->getValue<int16_t>();
+        int16_t tmpValue = member.template getValue<int16_t>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_ushort:
     {
-        uint16_t tmpValue = targetMember->getValue<uint16_t>();
+        uint16_t tmpValue = member.template getValue<uint16_t>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_ulong:
     {
-        uint32_t tmpValue = targetMember->getValue<uint32_t>();
+        uint32_t tmpValue = member.template getValue<uint32_t>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_float:
     {
-        float tmpValue = targetMember->getValue<float>();
+        float tmpValue = member.template getValue<float>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_double:
     {
-        double tmpValue = targetMember->getValue<double>();
+        double tmpValue = member.template getValue<double>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_boolean:
     {
-        uint32_t tmpValue = targetMember->getValue<uint32_t>();
+        uint32_t tmpValue = member.template getValue<uint32_t>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_char:
     {
-        char tmpValue = targetMember->getValue<char>();
+        char tmpValue = member.template getValue<char>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_wchar:
     {
-        char tmpValue = targetMember->getValue<char>(); // FIXME?
+        char tmpValue = member.template getValue<char>(); // FIXME?
         value = tmpValue;
         break;
     }
     case CORBA::tk_octet:
     {
-        uint8_t tmpValue = targetMember->getValue<uint8_t>();
+        uint8_t tmpValue = member.template getValue<uint8_t>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_longlong:
     {
-        qint64 tmpValue = targetMember->getValue<qint64>();
+        qint64 tmpValue = member.template getValue<qint64>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_ulonglong:
     {
-        quint64 tmpValue = targetMember->getValue<quint64>();
+        quint64 tmpValue = member.template getValue<quint64>();
         value = tmpValue;
         break;
     }
     case CORBA::tk_string:
     {
-        const char* tmpValue = targetMember->getStringValue();
+        const char* tmpValue = member.getStringValue();
         value = tmpValue;
         break;
     }
     case CORBA::tk_enum:
     {
-        const uint32_t tmpValue = targetMember->getValue<uint32_t>();
+        const uint32_t tmpValue = member.template getValue<uint32_t>();
         value = tmpValue;
         break;
     }
@@ -189,51 +159,124 @@ QVariant CommonData::readMember(const QString& topicName,
     return value;
 }
 
-QVariant CommonData::readDynamicMember(const QString& topicName,
-                                       const QString& memberName,
-                                       unsigned int index)
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+void CommonData::cleanup()
 {
-    const QVariant error;
-    QMutexLocker locker(&m_dynamicSamplesMutex);
+    // Stop decoding before the stores and DDS go away. Closing a queue waits
+    // for the worker processing it, and releasing the pool joins the workers.
+    std::shared_ptr<DecodeWorkerPool> pool;
+    std::vector<std::weak_ptr<DecodeQueue>> queues;
+    {
+        QMutexLocker locker(&m_decodeWorkerPoolMutex);
+        std::swap(pool, m_decodeWorkerPool);
+        std::swap(queues, m_decodeQueues);
+    }
 
-    if (!m_dynamicSamples.contains(topicName)) {
-        return error;
+    for (const std::weak_ptr<DecodeQueue>& weakQueue : queues)
+    {
+        const std::shared_ptr<DecodeQueue> queue = weakQueue.lock();
+        if (queue)
+        {
+            queue->close();
+        }
     }
+    pool.reset();
 
-    const QList<DDS::DynamicData_var>& sampleList = m_dynamicSamples[topicName];
-    if (static_cast<int>(index) >= sampleList.count()) {
-        return error;
+    {
+        QWriteLocker locker(&m_sampleStoresLock);
+        m_sampleStores.clear();
     }
 
-    DDS::DynamicData_var sample = sampleList.at(index);
-    DDS::DynamicType_var topic_type = sample->type();
-    OpenDDS::XTypes::MemberPath member_path;
-    if (member_path.resolve_string_path(topic_type, memberName.toStdString()) != DDS::RETCODE_OK) {
-        return error;
+    {
+        QMutexLocker locker(&m_topicMutex);
+        m_topicInfo.clear();
     }
 
-    // The direct parent dynamic data of this member
-    DDS::DynamicData_var parent_data;
+    m_ddsManager.reset();
+}
 
-    // The Id of this member within the direct parent type
-    DDS::MemberId id;
 
-    if (member_path.get_member_from_data(sample, parent_data, id) != DDS::RETCODE_OK) {
-        return error;
+//------------------------------------------------------------------------------
+void CommonData::storeTopicInfo(const QString& topicName, std::shared_ptr<TopicInfo> info)
+{
+    QMutexLocker locker(&m_topicMutex);
+    m_topicInfo[topicName] = info;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<TopicInfo> CommonData::getTopicInfo(const QString& topicName)
+{
+    QMutexLocker locker(&m_topicMutex);
+
+    if (m_topicInfo.contains(topicName))
+    {
+        return m_topicInfo.value(topicName);
     }
+    return std::shared_ptr<TopicInfo>();
+}
+
+QVariant CommonData::readMember(const TopicSampleStore& store,
+                                const MemberAccessor& accessor,
+                                unsigned int index)
+{
+    QVariant value;
 
-    DDS::DynamicType_var parent_type = parent_data->type();
-    DDS::DynamicTypeMember_var dtm;
-    if (parent_type->get_member(dtm, id) != DDS::RETCODE_OK) {
+    // Read flat samples in place instead of building the tree
+    const std::shared_ptr<const FlatSample> flatSample = store.flatSample(index);
+    if (flatSample)
+    {
+        const FlatSample::Member targetMember = accessor.find(*flatSample);
+        if (!targetMember)
+        {
+            value = "NULL";
+            return value;
+        }
+        return memberValue(targetMember);
+    }
+
+    // Make sure the index is valid
+    const std::shared_ptr<OpenDynamicData> targetSample = store.sample(index);
+    if (!targetSample)
+    {
+        value = "NULL";
+        return value;
+    }
+
+    // Find the target member within this sample
+    const std::shared_ptr<OpenDynamicData> targetMember = accessor.find(targetSample);
+    if (!targetMember)
+    {
+        value = "NULL";
+        return value;
+    }
+
+    return memberValue(*targetMember);
+}
+
+QVariant CommonData::readDynamicMember(const MemberAccessor& accessor,
+                                       DDS::DynamicData_ptr sample)
+{
+    const QVariant error;
+
+    if (!sample) {
         return error;
     }
 
-    DDS::MemberDescriptor_var md;
-    if (dtm->get_descriptor(md) != DDS::RETCODE_OK) {
+    // The direct parent dynamic data of this member
+    DDS::DynamicData_var parent_data;
+
+    // The Id of this member within the direct parent type
+    DDS::MemberId id;
+
+    if (!accessor.find(sample, parent_data, id)) {
         return error;
     }
 
-    const DDS::TypeKind member_tk = md->type()->get_kind();
+    DDS::DynamicType_ptr member_type = accessor.memberType();
+    const DDS::TypeKind member_tk = member_type->get_kind();
     DDS::ReturnCode_t rc = DDS::RETCODE_OK;
 
     switch (member_tk) {
@@ -360,7 +403,7 @@ QVariant CommonData::readDynamicMember(const QString& topicName,
           rc = parent_data->get_int32_value(tmp, id);
           if (rc == DDS::RETCODE_OK) {
               DDS::String8_var name;
-              rc = OpenDDS::XTypes::get_enumerator_name(name, tmp, md->type());
+              rc = OpenDDS::XTypes::get_enumerator_name(name, tmp, member_type);
               if (rc == DDS::RETCODE_OK) {
                   return name.in();
               }
@@ -385,115 +428,346 @@ QVariant CommonData::readValue(const QString& topicName,
         return QVariant();
     }
 
-    if (topicInfo->typeMode() == TypeDiscoveryMode::TypeCode)
-    {
-        return readMember(topicName, memberName, index);
-    }
-    return readDynamicMember(topicName, memberName, index);
+    const MemberAccessor accessor(*topicInfo, memberName.toStdString());
+    return readValue(topicName, accessor, index);
 }
 
 
 //------------------------------------------------------------------------------
-void CommonData::flushSamples(const QString& topicName)
+std::shared_ptr<const MemberAccessor> CommonData::compileMember(const QString& topicName,
+                                                                const QString& memberName)
 {
     std::shared_ptr<TopicInfo> topicInfo = getTopicInfo(topicName);
     if (!topicInfo)
     {
-        return;
+        return nullptr;
     }
 
-    if (topicInfo->typeMode() == TypeDiscoveryMode::TypeCode)
+    return std::make_shared<MemberAccessor>(*topicInfo, memberName.toStdString());
+}
+
+
+//------------------------------------------------------------------------------
+QVariant CommonData::readValue(const QString& topicName,
+                               const MemberAccessor& accessor,
+                               unsigned int index)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+
+    if (!accessor.isDynamic())
     {
-        flushStaticSamples(topicName);
+        if (!store)
+        {
+            return QVariant("NULL");
+        }
+        return readMember(*store, accessor, index);
     }
-    else
+
+    if (!store)
     {
-        flushDynamicSamples(topicName);
+        return QVariant();
     }
+    DDS::DynamicData_var sample = store->dynamicSample(index);
+    return readDynamicMember(accessor, sample.in());
 }
 
-void CommonData::flushStaticSamples(const QString& topicName)
+
+//------------------------------------------------------------------------------
+QVariant CommonData::readValue(const MemberAccessor& accessor,
+                               const TopicSample& slot,
+                               const std::shared_ptr<OpenDynamicData>& tree)
 {
-    QMutexLocker locker(&m_sampleMutex);
-    SampleMap::iterator it = m_samples.find(topicName);
-    if (it != m_samples.end())
+    if (accessor.isDynamic())
     {
-        m_samples.erase(it);
+        return readDynamicMember(accessor, slot.dynamicSample.in());
+    }
 
-        SampleTimeMap::iterator it2 = m_sampleTimes.find(topicName);
-        Q_ASSERT(it2 != m_sampleTimes.end());
-        m_sampleTimes.erase(it2);
+    if (slot.flat)
+    {
+        const FlatSample::Member targetMember = accessor.find(*slot.flat);
+        return targetMember ? memberValue(targetMember) : QVariant("NULL");
     }
+
+    const std::shared_ptr<OpenDynamicData> targetMember = tree ? accessor.find(tree) : nullptr;
+    return targetMember ? memberValue(*targetMember) : QVariant("NULL");
 }
 
-void CommonData::flushDynamicSamples(const QString& topicName)
+
+//------------------------------------------------------------------------------
+std::vector<TopicSample> CommonData::copySlotsSince(const QString& topicName,
+                                                    uint64_t& sequence)
 {
-    QMutexLocker locker(&m_dynamicSamplesMutex);
-    DynamicSampleMap::iterator it = m_dynamicSamples.find(topicName);
-    if (it != m_dynamicSamples.end())
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    std::vector<TopicSample> history =
+        store ? store->copySlotsSince(sequence) : std::vector<TopicSample>();
+    if (!history.empty())
     {
-        m_dynamicSamples.erase(it);
+        sequence = history.back().sequence;
+    }
+    return history;
+}
+
 
-        SampleTimeMap::iterator it2 = m_sampleTimes.find(topicName);
-        Q_ASSERT(it2 != m_sampleTimes.end());
-        m_sampleTimes.erase(it2);
+//------------------------------------------------------------------------------
+uint64_t CommonData::newestSequence(const QString& topicName)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    uint64_t sequence = 0;
+    if (store)
+    {
+        store->newestSequence(sequence);
     }
+    return sequence;
 }
 
 
 //------------------------------------------------------------------------------
-void CommonData::storeSample(const QString& topicName,
-                             const QString& sampleName,
-                             const std::shared_ptr<OpenDynamicData> sample)
+int CommonData::readColumns(const QString& topicName,
+                            const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                            size_t first,
+                            size_t count,
+                            SampleColumns& columns,
+                            ColumnFormat format)
 {
-    QMutexLocker locker(&m_sampleMutex);
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    const std::vector<TopicSample> history =
+        store ? store->copySlots(first, count) : std::vector<TopicSample>();
+    return extractColumns(history, accessors, columns, format);
+}
 
-    QList<std::shared_ptr<OpenDynamicData>>& sampleList = m_samples[topicName];
-    QStringList& timesList = m_sampleTimes[topicName];
 
-    // Store a pointer to the new sample
-    sampleList.push_front(sample);
-    timesList.push_front(sampleName);
+//------------------------------------------------------------------------------
+int CommonData::readColumnsInTimeRange(const QString& topicName,
+                                       const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                                       int64_t fromTime,
+                                       int64_t toTime,
+                                       SampleColumns& columns,
+                                       ColumnFormat format)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    const std::vector<TopicSample> history =
+        store ? store->copySlotsInTimeRange(fromTime, toTime) : std::vector<TopicSample>();
+    return extractColumns(history, accessors, columns, format);
+}
 
-    // Cleanup
-    while (sampleList.size() > MAX_SAMPLES)
+
+//------------------------------------------------------------------------------
+int CommonData::readColumnsSince(const QString& topicName,
+                                 const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                                 uint64_t& sequence,
+                                 SampleColumns& columns,
+                                 ColumnFormat format,
+                                 size_t limit)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    const std::vector<TopicSample> history =
+        store ? store->copySlotsSince(sequence, limit) : std::vector<TopicSample>();
+    if (!history.empty())
     {
-       sampleList.pop_back();
-       timesList.pop_back();
+        sequence = history.back().sequence;
     }
+    return extractColumns(history, accessors, columns, format);
 }
 
+
 //------------------------------------------------------------------------------
-void CommonData::storeDynamicSample(const QString& topicName,
-                                    const QString& sampleName,
-                                    const DDS::DynamicData_var sample)
+int CommonData::readMatrixSince(const QString& topicName,
+                                const MemberAccessor& accessor,
+                                uint64_t& sequence,
+                                SampleMatrix& matrix)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    const std::vector<TopicSample> history =
+        store ? store->copySlotsSince(sequence) : std::vector<TopicSample>();
+    if (!history.empty())
+    {
+        sequence = history.back().sequence;
+    }
+
+    matrix.sourceTimes.clear();
+    matrix.values.clear();
+
+    // One scratch buffer is reused for the elements of every sample
+    std::vector<double> elements;
+    for (const TopicSample& slot : history)
+    {
+        std::shared_ptr<OpenDynamicData> tree = slot.sample;
+        if (!tree && !slot.flat && slot.serialized)
+        {
+            tree = slot.serialized->decode();
+        }
+
+        if (!accessor.readNumbers(slot, tree, elements))
+        {
+            continue;
+        }
+
+        if (matrix.width == 0)
+        {
+            matrix.width = static_cast<int>(elements.size());
+        }
+        if (matrix.width == 0)
+        {
+            continue;
+        }
+
+        const int copied = std::min(matrix.width, static_cast<int>(elements.size()));
+        const int offset = matrix.values.size();
+        matrix.values.resize(offset + matrix.width);
+        double* row = matrix.values.data() + offset;
+        std::copy(elements.begin(), elements.begin() + copied, row);
+        std::fill(row + copied, row + matrix.width, std::numeric_limits<double>::quiet_NaN());
+        matrix.sourceTimes.append(slot.sourceTime);
+    }
+
+    return matrix.sourceTimes.count();
+}
+
+
+//------------------------------------------------------------------------------
+int CommonData::extractColumns(const std::vector<TopicSample>& history,
+                               const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                               SampleColumns& columns,
+                               ColumnFormat format)
+{
+    const int rows = static_cast<int>(history.size());
+    const int memberCount = accessors.count();
+    const bool doubles = (format == ColumnFormat::Double);
+
+    columns.sourceTimes.resize(rows);
+    columns.receptionTimes.resize(rows);
+    columns.values.resize(doubles ? memberCount : 0);
+    columns.integers.resize(doubles ? 0 : memberCount);
+    for (int m = 0; m < memberCount; ++m)
+    {
+        if (doubles)
+        {
+            columns.values[m].fill(std::numeric_limits<double>::quiet_NaN(), rows);
+        }
+        else
+        {
+            columns.integers[m].fill(0, rows);
+        }
+    }
+
+    // Fill row by row, so each sample is decoded at most once
+    std::vector<double*> valuePointers;
+    std::vector<int64_t*> integerPointers;
+    for (int m = 0; m < memberCount; ++m)
+    {
+        if (doubles)
+        {
+            valuePointers.push_back(columns.values[m].data());
+        }
+        else
+        {
+            integerPointers.push_back(columns.integers[m].data());
+        }
+    }
+
+    for (int row = 0; row < rows; ++row)
+    {
+        const TopicSample& slot = history[row];
+        columns.sourceTimes[row] = slot.sourceTime;
+        columns.receptionTimes[row] = slot.receptionTime;
+
+        // Lazily stored samples are decoded here, bypassing the decode cache
+        // so a bulk read doesn't evict the samples the user is looking at.
+        std::shared_ptr<OpenDynamicData> tree = slot.sample;
+        if (!tree && !slot.flat && slot.serialized)
+        {
+            tree = slot.serialized->decode();
+        }
+
+        for (int m = 0; m < memberCount; ++m)
+        {
+            const std::shared_ptr<const MemberAccessor>& accessor = accessors.at(m);
+            if (!accessor || !accessor->isValid())
+            {
+                continue;
+            }
+
+            if (doubles)
+            {
+                accessor->readNumber(slot, tree, valuePointers[m][row]);
+            }
+            else
+            {
+                accessor->readNumber(slot, tree, integerPointers[m][row]);
+            }
+        }
+    }
+
+    return rows;
+}
+
+
+//------------------------------------------------------------------------------
+bool CommonData::trackMember(const QString& topicName,
+                             const QString& memberName,
+                             ColumnType type,
+                             size_t capacity)
 {
-    QMutexLocker locker(&m_dynamicSamplesMutex);
+    const std::shared_ptr<const MemberAccessor> accessor = compileMember(topicName, memberName);
+    if (!accessor || !accessor->isValid())
+    {
+        return false;
+    }
 
-    QList<DDS::DynamicData_var>& sampleList = m_dynamicSamples[topicName];
-    QStringList& timesList = m_sampleTimes[topicName];
+    getSampleStore(topicName)->trackMember(accessor, type, capacity);
+    return true;
+}
 
-    // Add new sample
-    sampleList.push_front(sample);
-    timesList.push_front(sampleName);
 
-    // Cleanup
-    while (sampleList.size() > MAX_SAMPLES)
+//------------------------------------------------------------------------------
+void CommonData::untrackMember(const QString& topicName, const QString& memberName)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store)
     {
-        sampleList.pop_back();
-        timesList.pop_back();
+        store->untrackMember(memberName.toStdString());
     }
 }
 
+
+//------------------------------------------------------------------------------
+void CommonData::flushSamples(const QString& topicName)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store)
+    {
+        store->clear();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void CommonData::storeSample(const QString& topicName,
+                             int64_t sourceTime,
+                             int64_t receptionTime,
+                             const std::shared_ptr<OpenDynamicData> sample)
+{
+    getSampleStore(topicName)->storeSample(sourceTime, receptionTime, sample);
+}
+
+//------------------------------------------------------------------------------
+void CommonData::storeDynamicSample(const QString& topicName,
+                                    int64_t sourceTime,
+                                    int64_t receptionTime,
+                                    const DDS::DynamicData_var sample)
+{
+    getSampleStore(topicName)->storeDynamicSample(sourceTime, receptionTime, sample);
+}
+
 //------------------------------------------------------------------------------
 std::shared_ptr<OpenDynamicData> CommonData::copySample(const QString& topicName,
                                                         int index)
 {
-    QMutexLocker locker(&m_sampleMutex);
-    if (m_samples.contains(topicName) && m_samples.value(topicName).size() > index)
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store && index >= 0)
     {
         // Don't copy the sample, just point to the shared pointer
-        return m_samples.value(topicName).at(index);
+        return store->sample(index);
     }
     return std::shared_ptr<OpenDynamicData>();
 }
@@ -502,24 +776,361 @@ std::shared_ptr<OpenDynamicData> CommonData::copySample(const QString& topicName
 DDS::DynamicData_var CommonData::copyDynamicSample(const QString& topicName,
                                                    int index)
 {
-    QMutexLocker locker(&m_dynamicSamplesMutex);
-
-    if (m_dynamicSamples.contains(topicName) &&
-        m_dynamicSamples.value(topicName).size() > index) {
-        return m_dynamicSamples.value(topicName).at(index);
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store && index >= 0) {
+        return store->dynamicSample(index);
     }
     return DDS::DynamicData_var();
 }
 
 //------------------------------------------------------------------------------
-QStringList CommonData::getSampleList(const QString& topicName)
+std::shared_ptr<const FlatSample> CommonData::copyFlatSample(const QString& topicName,
+                                                            int index)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store && index >= 0)
+    {
+        return store->flatSample(index);
+    }
+    return std::shared_ptr<const FlatSample>();
+}
+
+//------------------------------------------------------------------------------
+QVector<int64_t> CommonData::getSampleTimes(const QString& topicName)
+{
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store)
+    {
+        return store->sourceTimes();
+    }
+    return QVector<int64_t>();
+}
+
+//------------------------------------------------------------------------------
+int64_t CommonData::toNanoseconds(const DDS::Time_t& time)
+{
+    return (static_cast<int64_t>(time.sec) * 1000000000) +
+           static_cast<int64_t>(time.nanosec);
+}
+
+//------------------------------------------------------------------------------
+int64_t CommonData::currentTimeNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------
+QString CommonData::formatSampleTime(int64_t time)
+{
+    return QDateTime::fromMSecsSinceEpoch(time / 1000000).toString("HH:mm:ss.zzz");
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<TopicSampleStore> CommonData::getSampleStore(const QString& topicName)
 {
-    QMutexLocker locker(&m_sampleMutex);
-    if (m_sampleTimes.contains(topicName))
+    std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store)
     {
-        return m_sampleTimes.value(topicName);
+        return store;
     }
-    return QStringList();
+
+    QWriteLocker locker(&m_sampleStoresLock);
+
+    // Another thread may have created it while we waited for the lock
+    std::shared_ptr<TopicSampleStore>& slot = m_sampleStores[topicName];
+    if (!slot)
+    {
+        slot = std::make_shared<TopicSampleStore>(historyDepth(topicName));
+    }
+    return slot;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<TopicSampleStore> CommonData::findSampleStore(const QString& topicName)
+{
+    QReadLocker locker(&m_sampleStoresLock);
+    return m_sampleStores.value(topicName);
+}
+
+//------------------------------------------------------------------------------
+void CommonData::loadHistorySettings()
+{
+    QSettings settings(SETTINGS_ORG_NAME, SETTINGS_APP_NAME);
+
+    setDefaultHistoryDepth(settings.value("defaultHistoryDepth", DEFAULT_HISTORY_DEPTH).toInt());
+    setMemoryBudget(settings.value("memoryBudget", 0).toULongLong());
+    setEvictionPolicy(settings.value("evictionPolicy").toString() == "fair" ?
+                      EvictionPolicy::FairShare : EvictionPolicy::OldestFirst);
+    setLazyDecoding(settings.value("lazyDecoding", false).toBool());
+    setDecodeThreadCount(settings.value("decodeThreads", DEFAULT_DECODE_THREADS).toInt());
+    setDecodeQueueDepth(settings.value("decodeQueueDepth", DEFAULT_DECODE_QUEUE_DEPTH).toInt());
+
+    settings.beginGroup("historyDepth");
+    const QStringList topicNames = settings.childKeys();
+    for (const QString& topicName : topicNames)
+    {
+        setHistoryDepth(topicName, settings.value(topicName).toInt());
+    }
+    settings.endGroup();
+
+    settings.beginGroup("ingestPolicy");
+    const QStringList policyTopics = settings.childKeys();
+    for (const QString& topicName : policyTopics)
+    {
+        IngestPolicy policy;
+        if (IngestPolicy::fromString(settings.value(topicName).toString(), policy))
+        {
+            setIngestPolicy(topicName, policy);
+        }
+    }
+    settings.endGroup();
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setDefaultHistoryDepth(int depth)
+{
+    QMutexLocker locker(&m_historyDepthMutex);
+    m_defaultHistoryDepth = qBound(1, depth, static_cast<int>(MAX_HISTORY_DEPTH));
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setHistoryDepth(const QString& topicName, int depth)
+{
+    depth = qBound(1, depth, static_cast<int>(MAX_HISTORY_DEPTH));
+    {
+        QMutexLocker locker(&m_historyDepthMutex);
+        m_historyDepths[topicName] = depth;
+    }
+
+    const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+    if (store)
+    {
+        store->setCapacity(depth);
+    }
+}
+
+//------------------------------------------------------------------------------
+int CommonData::historyDepth(const QString& topicName)
+{
+    QMutexLocker locker(&m_historyDepthMutex);
+    return m_historyDepths.value(topicName, m_defaultHistoryDepth);
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setIngestPolicy(const QString& topicName, const IngestPolicy& policy)
+{
+    QMutexLocker locker(&m_ingestPolicyMutex);
+    m_ingestPolicies[topicName] = policy;
+}
+
+//------------------------------------------------------------------------------
+IngestPolicy CommonData::ingestPolicy(const QString& topicName)
+{
+    QMutexLocker locker(&m_ingestPolicyMutex);
+    return m_ingestPolicies.value(topicName);
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setMemoryBudget(size_t bytes)
+{
+    m_memoryBudget = bytes;
+    enforceMemoryBudget();
+}
+
+//------------------------------------------------------------------------------
+size_t CommonData::memoryBudget()
+{
+    return m_memoryBudget;
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setEvictionPolicy(EvictionPolicy policy)
+{
+    m_evictionPolicy = policy;
+}
+
+//------------------------------------------------------------------------------
+EvictionPolicy CommonData::evictionPolicy()
+{
+    return m_evictionPolicy;
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setLazyDecoding(bool enable)
+{
+    m_lazyDecoding = enable;
+}
+
+//------------------------------------------------------------------------------
+bool CommonData::lazyDecoding()
+{
+    return m_lazyDecoding;
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setDecodeThreadCount(int count)
+{
+    m_decodeThreadCount = qBound(1, count, static_cast<int>(MAX_DECODE_THREADS));
+
+    QMutexLocker locker(&m_decodeWorkerPoolMutex);
+    if (m_decodeWorkerPool)
+    {
+        m_decodeWorkerPool->setThreadCount(m_decodeThreadCount);
+    }
+}
+
+//------------------------------------------------------------------------------
+int CommonData::decodeThreadCount()
+{
+    return m_decodeThreadCount;
+}
+
+//------------------------------------------------------------------------------
+void CommonData::setDecodeQueueDepth(int depth)
+{
+    m_decodeQueueDepth = qBound(1, depth, static_cast<int>(MAX_DECODE_QUEUE_DEPTH));
+}
+
+//------------------------------------------------------------------------------
+int CommonData::decodeQueueDepth()
+{
+    return m_decodeQueueDepth;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<DecodeWorkerPool> CommonData::decodeWorkerPool()
+{
+    QMutexLocker locker(&m_decodeWorkerPoolMutex);
+    if (!m_decodeWorkerPool)
+    {
+        m_decodeWorkerPool = std::make_shared<DecodeWorkerPool>(m_decodeThreadCount);
+    }
+    return m_decodeWorkerPool;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<DecodeQueue> CommonData::createDecodeQueue(size_t capacity,
+                                                           DecodeQueue::Handler handler)
+{
+    const std::shared_ptr<DecodeQueue> queue =
+        std::make_shared<DecodeQueue>(decodeWorkerPool(), capacity, std::move(handler));
+
+    QMutexLocker locker(&m_decodeWorkerPoolMutex);
+    m_decodeQueues.erase(std::remove_if(m_decodeQueues.begin(),
+                                        m_decodeQueues.end(),
+                                        [](const std::weak_ptr<DecodeQueue>& weakQueue)
+                                        {
+                                            return weakQueue.expired();
+                                        }),
+                         m_decodeQueues.end());
+    m_decodeQueues.push_back(queue);
+    return queue;
+}
+
+//------------------------------------------------------------------------------
+void CommonData::enforceMemoryBudget()
+{
+    const size_t budget = m_memoryBudget;
+    if (budget == 0 || TopicSampleStore::totalBytes() <= budget)
+    {
+        return;
+    }
+
+    // Another thread is already evicting
+    if (!m_evictionMutex.tryLock())
+    {
+        return;
+    }
+
+    QList<std::shared_ptr<TopicSampleStore>> stores;
+    {
+        QReadLocker locker(&m_sampleStoresLock);
+        stores = m_sampleStores.values();
+    }
+
+    // Each round selects a victim once and evicts from it in a batch until it
+    // is no longer the best candidate, so the stores are not rescanned and
+    // relocked for every sample
+    const EvictionPolicy policy = m_evictionPolicy;
+    while (TopicSampleStore::totalBytes() > budget)
+    {
+        std::shared_ptr<TopicSampleStore> victim;
+        uint64_t oldest = UINT64_MAX;
+        uint64_t runnerUpSequence = UINT64_MAX;
+        size_t largest = 0;
+        size_t runnerUpBytes = 0;
+
+        for (const std::shared_ptr<TopicSampleStore>& store : stores)
+        {
+            // Always keep the newest sample of each topic
+            if (store->size() <= 1)
+            {
+                continue;
+            }
+
+            if (policy == EvictionPolicy::OldestFirst)
+            {
+                uint64_t sequence = 0;
+                if (!store->oldestSequence(sequence))
+                {
+                    continue;
+                }
+
+                if (sequence < oldest)
+                {
+                    runnerUpSequence = oldest;
+                    oldest = sequence;
+                    victim = store;
+                }
+                else if (sequence < runnerUpSequence)
+                {
+                    runnerUpSequence = sequence;
+                }
+            }
+            else
+            {
+                const size_t bytes = store->bytes();
+                if (bytes > largest)
+                {
+                    runnerUpBytes = largest;
+                    largest = bytes;
+                    victim = store;
+                }
+                else if (bytes > runnerUpBytes)
+                {
+                    runnerUpBytes = bytes;
+                }
+            }
+        }
+
+        if (!victim)
+        {
+            break;
+        }
+
+        // Evict down to the runner-up, but always make progress
+        size_t evicted = 0;
+        if (policy == EvictionPolicy::OldestFirst)
+        {
+            evicted = victim->evictOldest(budget, EVICTION_QUOTA, runnerUpSequence, 0);
+        }
+        else
+        {
+            evicted = victim->evictOldest(budget, EVICTION_QUOTA, UINT64_MAX, runnerUpBytes);
+            if (evicted == 0)
+            {
+                evicted = victim->evictOldest(budget, 1, UINT64_MAX, 0);
+            }
+        }
+
+        if (evicted == 0)
+        {
+            break;
+        }
+    }
+
+    m_evictionMutex.unlock();
 }
 
 //------------------------------------------------------------------------------
@@ -16,19 +16,27 @@
 #pragma warning(pop)
 #endif
 
+#include "decode_worker_pool.h"
+#include "topic_sample_store.h"
+
+#include <QReadWriteLock>
 #include <QStringList>
 #include <QVariant>
 #include <QString>
+#include <QVector>
 #include <QMutex>
 #include <QList>
 #include <QMap>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <cstdint>
+#include <vector>
 
 
 class DDSManager;
+class MemberAccessor;
 class OpenDynamicData;
 class TopicSampleTableModel;
 
@@ -78,6 +86,62 @@ enum class TypeDiscoveryMode
     DynamicType
 };
 
+/// How samples are evicted across topics once the memory budget is exceeded.
+enum class EvictionPolicy
+{
+    /// Evict the oldest sample of any topic first.
+    OldestFirst,
+    /// Evict from the topic using the most memory, so each topic keeps a fair share.
+    FairShare
+};
+
+/// The value type of the columns filled by CommonData::readColumns.
+enum class ColumnFormat
+{
+    /// Fill SampleColumns::values. Missing values are NaN.
+    Double,
+    /// Fill SampleColumns::integers. Missing values are 0. Exact for 64-bit integers.
+    Int64
+};
+
+/**
+ * @brief Member values of a range of samples, one column per member.
+ * @details Row i of every column belongs to the same sample. Rows are ordered
+ *          oldest first, the way they are plotted and exported.
+ */
+struct SampleColumns
+{
+    /// The source timestamps in nanoseconds since the Unix epoch.
+    QVector<int64_t> sourceTimes;
+
+    /// The reception times in nanoseconds since the Unix epoch.
+    QVector<int64_t> receptionTimes;
+
+    /// One column per member accessor, filled for ColumnFormat::Double.
+    QVector<QVector<double>> values;
+
+    /// One column per member accessor, filled for ColumnFormat::Int64.
+    QVector<QVector<int64_t>> integers;
+};
+
+/**
+ * @brief The elements of one array or sequence member over a range of samples.
+ * @details Row i holds the elements of sample i, oldest first. The rows are
+ *          stored back to back in one buffer, so a whole sample is one
+ *          contiguous run of width values.
+ */
+struct SampleMatrix
+{
+    /// The source timestamps in nanoseconds since the Unix epoch.
+    QVector<int64_t> sourceTimes;
+
+    /// The number of values per row.
+    int width = 0;
+
+    /// The rows, each width values long. Missing elements are NaN.
+    QVector<double> values;
+};
+
 /**
  * @brief Stores information on discovered DDS topics.
  */
@@ -320,8 +384,26 @@ class CommonData
 {
 public:
 
-    /// The maximum number of samples to store in the history.
-    static const int MAX_SAMPLES = 500;
+    /// The default number of samples to store in the history of each topic.
+    static const int DEFAULT_HISTORY_DEPTH = 500;
+
+    /// The largest history depth that may be configured for a topic.
+    static const int MAX_HISTORY_DEPTH = 10000000;
+
+    /// The default number of points kept for each tracked member.
+    static const int DEFAULT_TRACKED_DEPTH = 100000;
+
+    /// The default number of threads decoding received samples.
+    static const int DEFAULT_DECODE_THREADS = 2;
+
+    /// The largest number of decode threads that may be configured.
+    static const int MAX_DECODE_THREADS = 64;
+
+    /// The default number of received samples each topic may queue for decoding.
+    static const int DEFAULT_DECODE_QUEUE_DEPTH = 4096;
+
+    /// The largest decode queue depth that may be configured.
+    static const int MAX_DECODE_QUEUE_DEPTH = 1048576;
 
     /// The shared DDS manager object.
     static std::unique_ptr<DDSManager> m_ddsManager;
@@ -354,6 +436,211 @@ public:
                               const QString& memberName,
                               unsigned int index = 0);
 
+    /**
+     * @brief Resolve a topic member path once for repeated reads.
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberName The name of the topic member.
+     * @return The member accessor or nullptr if the topic is unknown.
+     */
+    static std::shared_ptr<const MemberAccessor> compileMember(const QString& topicName,
+                                                               const QString& memberName);
+
+    /**
+     * @brief Read the value of a DDS sample through a member accessor.
+     * @details Same result as the member name overload, without parsing the
+     *          member path on every call.
+     * @param[in] topicName The name of the topic.
+     * @param[in] accessor The member accessor from compileMember().
+     * @param[in] index The sample index. 0 is the newest.
+     * @return A QVariant containing the sample value.
+     */
+    static QVariant readValue(const QString& topicName,
+                              const MemberAccessor& accessor,
+                              unsigned int index = 0);
+
+    /**
+     * @brief Read the value of a copied history slot through a member accessor.
+     * @details Every member of a row read this way comes from the same
+     *          sample, however many samples arrive meanwhile.
+     * @param[in] accessor The member accessor from compileMember().
+     * @param[in] slot The history slot, from copySlotsSince().
+     * @param[in] tree The decoded tree of the slot. Only used for TypeCode
+     *            slots that are not stored flat.
+     * @return A QVariant containing the sample value.
+     */
+    static QVariant readValue(const MemberAccessor& accessor,
+                              const TopicSample& slot,
+                              const std::shared_ptr<OpenDynamicData>& tree);
+
+    /**
+     * @brief Copy the history slots of a topic stored since a cursor.
+     * @param[in] topicName The name of the topic.
+     * @param[in,out] sequence The sequence of the newest sample already read.
+     *                Start at newestSequence(). Set to the newest sample copied.
+     * @return The slots, oldest first.
+     */
+    static std::vector<TopicSample> copySlotsSince(const QString& topicName,
+                                                   uint64_t& sequence);
+
+    /**
+     * @brief Get the insertion order of the newest sample of a topic.
+     * @param[in] topicName The name of the topic.
+     * @return The sequence of the newest sample, or 0 if there is none.
+     */
+    static uint64_t newestSequence(const QString& topicName);
+
+    /**
+     * @brief Read numeric member values from a range of samples at once.
+     * @details The history is locked once for the whole range, and values
+     *          are written straight into the column buffers without QVariant.
+     *          String and complex members read as missing.
+     * @param[in] topicName The name of the topic.
+     * @param[in] accessors The members to read, one column each.
+     * @param[in] first The index of the newest sample to read. 0 is the newest.
+     * @param[in] count The maximum number of samples to read.
+     * @param[out] columns The values, replacing any previous content.
+     * @param[in] format The column type to fill.
+     * @return The number of rows read.
+     */
+    static int readColumns(const QString& topicName,
+                           const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                           size_t first,
+                           size_t count,
+                           SampleColumns& columns,
+                           ColumnFormat format = ColumnFormat::Double);
+
+    /**
+     * @brief Read numeric member values from the samples within a time range.
+     * @details Same as readColumns, for the samples whose source timestamp
+     *          lies within [fromTime, toTime].
+     * @param[in] topicName The name of the topic.
+     * @param[in] accessors The members to read, one column each.
+     * @param[in] fromTime The earliest source timestamp in nanoseconds.
+     * @param[in] toTime The latest source timestamp in nanoseconds.
+     * @param[out] columns The values, replacing any previous content.
+     * @param[in] format The column type to fill.
+     * @return The number of rows read.
+     */
+    static int readColumnsInTimeRange(const QString& topicName,
+                                      const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                                      int64_t fromTime,
+                                      int64_t toTime,
+                                      SampleColumns& columns,
+                                      ColumnFormat format = ColumnFormat::Double);
+
+    /**
+     * @brief Read numeric member values from the samples stored since a cursor.
+     * @details Same as readColumns, for every sample stored after the one the
+     *          cursor points at. Lets a consumer see each sample once.
+     * @param[in] topicName The name of the topic.
+     * @param[in] accessors The members to read, one column each.
+     * @param[in,out] sequence The sequence of the newest sample already read.
+     *                Start at 0. Set to the newest sample read.
+     * @param[out] columns The values, replacing any previous content.
+     * @param[in] format The column type to fill.
+     * @param[in] limit The maximum number of rows to read. Only the newest
+     *            samples are decoded, and the older ones are skipped.
+     * @return The number of rows read.
+     */
+    static int readColumnsSince(const QString& topicName,
+                                const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                                uint64_t& sequence,
+                                SampleColumns& columns,
+                                ColumnFormat format = ColumnFormat::Double,
+                                size_t limit = SIZE_MAX);
+
+    /**
+     * @brief Read a numeric array or sequence member from the samples stored
+     *        since a cursor.
+     * @details Each sample is read with one MemberAccessor::readNumbers call
+     *          and copied as one row, so the cost is O(elements) per sample.
+     *          Longer samples are cut to the matrix width and shorter ones
+     *          are padded with NaN.
+     * @param[in] topicName The name of the topic.
+     * @param[in] accessor The array or sequence member to read.
+     * @param[in,out] sequence The sequence of the newest sample already read.
+     *                Start at 0. Set to the newest sample read.
+     * @param[in,out] matrix The rows, replacing any previous content. If the
+     *                width is 0, it is set to the length of the first sample
+     *                holding the member.
+     * @return The number of rows read.
+     */
+    static int readMatrixSince(const QString& topicName,
+                               const MemberAccessor& accessor,
+                               uint64_t& sequence,
+                               SampleMatrix& matrix);
+
+    /**
+     * @brief Start recording a numeric member of a topic as samples arrive.
+     * @details Graphs and exports can then read the values from a compact
+     *          column instead of the sample history. Every call must be
+     *          matched by untrackMember().
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberName The name of the topic member.
+     * @param[in] type The storage type of the values.
+     * @param[in] capacity The maximum number of points to keep.
+     * @return True if the member is tracked; false if it wasn't found.
+     */
+    static bool trackMember(const QString& topicName,
+                            const QString& memberName,
+                            ColumnType type = ColumnType::Double,
+                            size_t capacity = DEFAULT_TRACKED_DEPTH);
+
+    /**
+     * @brief Stop recording a member once its last user is gone.
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberName The name of the topic member.
+     */
+    static void untrackMember(const QString& topicName, const QString& memberName);
+
+    /**
+     * @brief Copy the newest points of a tracked member, oldest first.
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberName The name of the topic member.
+     * @param[out] times The source timestamps in nanoseconds.
+     * @param[out] values The values converted to T.
+     * @param[in] maxCount The maximum number of points to copy.
+     * @return The number of points copied, or -1 if the member isn't tracked.
+     */
+    template<typename T>
+    static int readTrackedMember(const QString& topicName,
+                                 const QString& memberName,
+                                 QVector<int64_t>& times,
+                                 QVector<T>& values,
+                                 size_t maxCount = DEFAULT_TRACKED_DEPTH)
+    {
+        const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+        if (!store)
+        {
+            return -1;
+        }
+        return store->readTracked(memberName.toStdString(), times, values, maxCount);
+    }
+
+    /**
+     * @brief Copy the points of a tracked member stored after a cursor, oldest first.
+     * @param[in] topicName The name of the topic.
+     * @param[in] memberName The name of the topic member.
+     * @param[in] sequence The sequence of the newest sample already read.
+     * @param[out] sequences The sequence of the sample of each point.
+     * @param[out] values The values converted to T.
+     * @return The number of points copied, or -1 if the member isn't tracked.
+     */
+    template<typename T>
+    static int readTrackedSince(const QString& topicName,
+                                const QString& memberName,
+                                uint64_t sequence,
+                                QVector<uint64_t>& sequences,
+                                QVector<T>& values)
+    {
+        const std::shared_ptr<TopicSampleStore> store = findSampleStore(topicName);
+        if (!store)
+        {
+            return -1;
+        }
+        return store->readTrackedSince(memberName.toStdString(), sequence, sequences, values);
+    }
+
     /**
      * @brief Delete all data samples for a specified topic.
      * @param[in] topicName The name of the topic.
@@ -363,16 +650,19 @@ public:
     /**
      * @brief Store a new data sample for a specified topic
      * @param[in] topicName The name of the topic.
-     * @param[in] sampleName The name (timestamp) of the data sample.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receptionTime The reception time in nanoseconds.
      * @param[in] sample The data sample of the topic.
      */
     static void storeSample(const QString& topicName,
-                            const QString& sampleName,
+                            int64_t sourceTime,
+                            int64_t receptionTime,
                             const std::shared_ptr<OpenDynamicData> sample);
 
     /// Store a new sample represented by a DynamicData object.
     static void storeDynamicSample(const QString& topicName,
-                                   const QString& sampleName,
+                                   int64_t sourceTime,
+                                   int64_t receptionTime,
                                    DDS::DynamicData_var sample);
 
     /**
@@ -387,49 +677,221 @@ public:
 
     static DDS::DynamicData_var copyDynamicSample(const QString& topicName,
                                                   int index);
+
     /**
-     * @brief Get a list of sample names (timestamps) for a given topic.
+     * @brief Get a flat sample for a specified topic without decoding it.
+     * @param[in] topicName Get a sample of this topic.
+     * @param[in] index The sample index position. The newest is on the front.
+     * @return The flat sample or nullptr if the index wasn't found or the
+     *         sample was not stored flat.
+     */
+    static std::shared_ptr<const FlatSample> copyFlatSample(const QString& topicName,
+                                                            int index);
+
+    /**
+     * @brief Get the source timestamps of the samples for a given topic.
      * @param[in] topicName The name of the topic.
-     * @return A stringlist of sample names.
+     * @return The timestamps in nanoseconds since the Unix epoch, newest first.
      */
-    static QStringList getSampleList(const QString& topicName);
+    static QVector<int64_t> getSampleTimes(const QString& topicName);
 
-private:
+    /**
+     * @brief Convert a DDS timestamp to nanoseconds since the Unix epoch.
+     * @param[in] time The DDS timestamp.
+     * @return The timestamp in nanoseconds.
+     */
+    static int64_t toNanoseconds(const DDS::Time_t& time);
+
+    /**
+     * @brief Get the current wall clock time.
+     * @return The time in nanoseconds since the Unix epoch.
+     */
+    static int64_t currentTimeNanoseconds();
+
+    /**
+     * @brief Format a sample timestamp for display.
+     * @param[in] time The timestamp in nanoseconds since the Unix epoch.
+     * @return The local time formatted as "HH:mm:ss.zzz".
+     */
+    static QString formatSampleTime(int64_t time);
+
+    /**
+     * @brief Get the sample store for a given topic, creating it if needed.
+     * @details Monitors should keep the returned store rather than looking it
+     *          up for every sample. Flushing a topic clears the store in place.
+     * @param[in] topicName The name of the topic.
+     * @return The sample store of the topic.
+     */
+    static std::shared_ptr<TopicSampleStore> getSampleStore(const QString& topicName);
+
+    /**
+     * @brief Load the history depths, memory budget, eviction policy,
+     *        decoding options and ingest policies from the application settings.
+     */
+    static void loadHistorySettings();
+
+    /**
+     * @brief Set the history depth used by topics without their own depth.
+     * @param[in] depth The maximum number of samples to keep.
+     */
+    static void setDefaultHistoryDepth(int depth);
+
+    /**
+     * @brief Set the history depth of a topic.
+     * @details An existing store for the topic is resized immediately.
+     * @param[in] topicName The name of the topic.
+     * @param[in] depth The maximum number of samples to keep.
+     */
+    static void setHistoryDepth(const QString& topicName, int depth);
+
+    /**
+     * @brief Get the history depth of a topic.
+     * @param[in] topicName The name of the topic.
+     * @return The maximum number of samples kept for the topic.
+     */
+    static int historyDepth(const QString& topicName);
+
+    /**
+     * @brief Set how a topic handles samples it can't keep up with.
+     * @details Applies to monitors opened afterwards. A table page applies a
+     *          changed policy to its open monitor itself.
+     * @param[in] topicName The name of the topic.
+     * @param[in] policy The ingest policy.
+     */
+    static void setIngestPolicy(const QString& topicName, const IngestPolicy& policy);
+
+    /**
+     * @brief Get how a topic handles samples it can't keep up with.
+     * @param[in] topicName The name of the topic.
+     * @return The ingest policy of the topic. Drop newest by default.
+     */
+    static IngestPolicy ingestPolicy(const QString& topicName);
+
+    /**
+     * @brief Set the memory budget shared by all topic histories.
+     * @param[in] bytes The budget in bytes or 0 for no limit.
+     */
+    static void setMemoryBudget(size_t bytes);
+
+    /**
+     * @brief Get the memory budget shared by all topic histories.
+     * @return The budget in bytes or 0 for no limit.
+     */
+    static size_t memoryBudget();
+
+    /**
+     * @brief Set how samples are evicted when the memory budget is exceeded.
+     * @param[in] policy The eviction policy.
+     */
+    static void setEvictionPolicy(EvictionPolicy policy);
+
+    /**
+     * @brief Get how samples are evicted when the memory budget is exceeded.
+     * @return The eviction policy.
+     */
+    static EvictionPolicy evictionPolicy();
+
+    /**
+     * @brief Enable or disable lazy decoding of TypeCode samples.
+     * @details When enabled, samples are stored serialized and only decoded
+     *          when they are read. Topics with a filter still decode on
+     *          receipt, since the filter needs the decoded sample.
+     * @param[in] enable True to store samples serialized.
+     */
+    static void setLazyDecoding(bool enable);
+
+    /**
+     * @brief Get whether TypeCode samples are decoded lazily.
+     * @return True if samples are stored serialized.
+     */
+    static bool lazyDecoding();
+
+    /**
+     * @brief Set the number of threads decoding received samples.
+     * @details A running worker pool is resized immediately.
+     * @param[in] count The number of threads.
+     */
+    static void setDecodeThreadCount(int count);
 
-    static QVariant readMember(const QString& topicName,
-                               const QString& memberName,
-                               unsigned int index = 0);
+    /**
+     * @brief Get the number of threads decoding received samples.
+     * @return The number of threads.
+     */
+    static int decodeThreadCount();
 
-    static QVariant readDynamicMember(const QString& topicName,
-                                      const QString& memberName,
-                                      unsigned int index = 0);
+    /**
+     * @brief Set how many received samples each topic may queue for decoding.
+     * @details Applies to topics opened afterwards. Samples arriving at a
+     *          full queue are dropped.
+     * @param[in] depth The maximum number of queued samples.
+     */
+    static void setDecodeQueueDepth(int depth);
 
-    /// Called by flushSamples() depending on whether a recorder or a dynamic data reader is used.
-    static void flushStaticSamples(const QString& topicName);
-    static void flushDynamicSamples(const QString& topicName);
+    /**
+     * @brief Get how many received samples each topic may queue for decoding.
+     * @return The maximum number of queued samples.
+     */
+    static int decodeQueueDepth();
 
     /**
-     * @brief Stores the data samples from DDS.
-     * @details The key is the topic name and the value is the data sample. The
-     *          first sample is always the latest and the last sample is last.
+     * @brief Get the worker pool decoding the received samples of all topics.
+     * @details The pool is started on first use.
+     * @return The worker pool.
      */
-    using SampleMap = QMap<QString, QList<std::shared_ptr<OpenDynamicData>>>;
-    static SampleMap m_samples;
+    static std::shared_ptr<DecodeWorkerPool> decodeWorkerPool();
 
     /**
-     * @brief Store list of DynamicData objects for each topic.
-     * The timestamps for the samples are also stored in m_sampleTimes.
+     * @brief Create the decode queue of a topic on the shared worker pool.
+     * @details The queue is closed by cleanup() if it still exists then.
+     * @param[in] capacity The maximum number of samples waiting.
+     * @param[in] handler Processes the samples a batch at a time.
+     * @return The new queue.
      */
-    using DynamicSampleMap = QMap<QString, QList<DDS::DynamicData_var>>;
-    static DynamicSampleMap m_dynamicSamples;
+    static std::shared_ptr<DecodeQueue> createDecodeQueue(size_t capacity,
+                                                          DecodeQueue::Handler handler);
 
     /**
-     * @brief Stores the data sample times.
-     * @details The key is the topic name and the value is the data time. The
-     *          first sample is always the latest and the last sample is last.
+     * @brief Evict samples across topics until the memory budget is met.
+     * @details The newest sample of every topic is always kept. Only one
+     *          thread evicts at a time; other callers return immediately.
      */
-    using SampleTimeMap = QMap<QString, QStringList>;
-    static SampleTimeMap m_sampleTimes;
+    static void enforceMemoryBudget();
+
+private:
+
+    /**
+     * @brief Get the sample store for a given topic without creating it.
+     * @param[in] topicName The name of the topic.
+     * @return The sample store of the topic or nullptr if not found.
+     */
+    static std::shared_ptr<TopicSampleStore> findSampleStore(const QString& topicName);
+
+    static QVariant readMember(const TopicSampleStore& store,
+                               const MemberAccessor& accessor,
+                               unsigned int index);
+
+    static QVariant readDynamicMember(const MemberAccessor& accessor,
+                                      DDS::DynamicData_ptr sample);
+
+    /**
+     * @brief Fill the columns from slots copied out of a sample store.
+     * @param[in] history The history slots, oldest first.
+     * @param[in] accessors The members to read, one column each.
+     * @param[out] columns The values, replacing any previous content.
+     * @param[in] format The column type to fill.
+     * @return The number of rows read.
+     */
+    static int extractColumns(const std::vector<TopicSample>& history,
+                              const QVector<std::shared_ptr<const MemberAccessor>>& accessors,
+                              SampleColumns& columns,
+                              ColumnFormat format);
+
+    /**
+     * @brief Stores the sample history of each topic.
+     * @details The key is the topic name and the value is the store that owns
+     *          the samples and the lock protecting them.
+     */
+    static QMap<QString, std::shared_ptr<TopicSampleStore>> m_sampleStores;
 
     /**
      * @brief Stores information about the topics on the bus.
@@ -438,14 +900,53 @@ private:
      */
     static QMap<QString, std::shared_ptr<TopicInfo>> m_topicInfo;
 
-    /// Mutex for protecting access to m_samples.
-    static QMutex m_sampleMutex;
+    /// Lock for protecting the m_sampleStores registry, not the samples.
+    static QReadWriteLock m_sampleStoresLock;
 
     /// Mutex for protecting access to m_topicInfo.
     static QMutex m_topicMutex;
 
-    /// Mutex for protecting access to m_dynamicSamples.
-    static QMutex m_dynamicSamplesMutex;
+    /// The history depth of topics without their own depth.
+    static int m_defaultHistoryDepth;
+
+    /// The history depth of individual topics. The key is the topic name.
+    static QMap<QString, int> m_historyDepths;
+
+    /// Mutex for protecting access to m_defaultHistoryDepth and m_historyDepths.
+    static QMutex m_historyDepthMutex;
+
+    /// The ingest policy of individual topics. The key is the topic name.
+    static QMap<QString, IngestPolicy> m_ingestPolicies;
+
+    /// Mutex for protecting access to m_ingestPolicies.
+    static QMutex m_ingestPolicyMutex;
+
+    /// The memory budget in bytes shared by all topic histories. 0 is no limit.
+    static std::atomic<size_t> m_memoryBudget;
+
+    /// How samples are evicted when the memory budget is exceeded.
+    static std::atomic<EvictionPolicy> m_evictionPolicy;
+
+    /// Ensures only one thread evicts samples at a time.
+    static QMutex m_evictionMutex;
+
+    /// True if TypeCode samples are stored serialized and decoded on demand.
+    static std::atomic<bool> m_lazyDecoding;
+
+    /// The number of threads decoding received samples.
+    static std::atomic<int> m_decodeThreadCount;
+
+    /// The number of received samples each topic may queue for decoding.
+    static std::atomic<int> m_decodeQueueDepth;
+
+    /// The worker pool decoding received samples. Created on first use.
+    static std::shared_ptr<DecodeWorkerPool> m_decodeWorkerPool;
+
+    /// The decode queues created on m_decodeWorkerPool, closed by cleanup().
+    static std::vector<std::weak_ptr<DecodeQueue>> m_decodeQueues;
+
+    /// Mutex for protecting access to m_decodeWorkerPool and m_decodeQueues.
+    static QMutex m_decodeWorkerPoolMutex;
 
 };
 
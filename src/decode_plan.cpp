@@ -0,0 +1,945 @@
+#include "decode_plan.h"
+#include "flat_sample.h"
+#include "open_dynamic_data.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+
+namespace
+{
+
+/// Follow the alias trail until we have the true type.
+CORBA::TypeCode_var unalias(CORBA::TypeCode_ptr typeCode)
+{
+    // Both paths return a new reference
+    if (!typeCode || typeCode->kind() != CORBA::tk_alias)
+    {
+        return CORBA::TypeCode::_duplicate(typeCode);
+    }
+    return TAO::unaliased_typecode(typeCode);
+}
+
+/// Mirrors OpenDynamicData::isPrimitive().
+bool isPrimitiveKind(CORBA::TCKind kind)
+{
+    switch (kind)
+    {
+    case CORBA::tk_long:
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong:
+    case CORBA::tk_float:
+    case CORBA::tk_double:
+    case CORBA::tk_char:
+    case CORBA::tk_wchar:
+    case CORBA::tk_octet:
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+    case CORBA::tk_boolean:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// The size of one value of a primitive kind in memory, or 0 for other kinds.
+uint32_t primitiveSize(CORBA::TCKind kind)
+{
+    switch (kind)
+    {
+    case CORBA::tk_char:
+    case CORBA::tk_octet:
+        return 1;
+    case CORBA::tk_boolean:
+        return sizeof(CORBA::Boolean);
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+        return 2;
+    case CORBA::tk_wchar:
+        return sizeof(CORBA::WChar);
+    case CORBA::tk_long:
+    case CORBA::tk_ulong:
+    case CORBA::tk_enum:
+    case CORBA::tk_float:
+        return 4;
+    case CORBA::tk_double:
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Read the elements of a primitive array or sequence.
+ * @param[in,out] builder Creates the nodes of the output representation.
+ * @param[in] node The array or sequence node with its elements created.
+ * @param[in] count The number of elements.
+ * @param[in] read Reads the given number of values into a buffer.
+ * @return True on success; false otherwise.
+ */
+template<typename T, typename Builder, typename Reader>
+bool readArray(Builder& builder, typename Builder::Handle node, uint32_t count, Reader read)
+{
+    // Flat samples are read straight into their packed elements
+    T* packed = builder.template packedElements<T>(node);
+    if (packed)
+    {
+        return read(packed, static_cast<ACE_CDR::ULong>(count));
+    }
+
+    std::vector<T> values(count);
+    if (!read(values.data(), static_cast<ACE_CDR::ULong>(count)))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        builder.setValue(builder.child(node, i), values[i]);
+    }
+    return true;
+}
+
+} // End namespace
+
+
+/// Builds OpenDynamicData trees, the same as CreateOpenDynamicData does.
+class DecodePlan::TreeBuilder
+{
+public:
+
+    using Handle = OpenDynamicData*;
+
+    explicit TreeBuilder(const DecodePlan& plan) : m_plan(plan) {}
+
+    std::shared_ptr<OpenDynamicData> root()
+    {
+        return m_plan.createNode(0, std::string(), m_plan.m_extensibility,
+                                 std::weak_ptr<OpenDynamicData>());
+    }
+
+    void addMembers(Handle node, const TypeEntry& entry)
+    {
+        //RJ 2022-01-21 I think older verisons of ddsman will default to topics being appendable, but structs within them being final. I think.
+        const std::weak_ptr<OpenDynamicData> self = node->weak_from_this();
+        node->m_children.reserve(entry.memberCount);
+        for (uint32_t i = 0; i < entry.memberCount; ++i)
+        {
+            const MemberEntry& member = m_plan.m_members[entry.firstMember + i];
+            node->m_children.push_back(
+                m_plan.createNode(member.type, member.name, OpenDDS::DCPS::Extensibility::FINAL, self));
+        }
+    }
+
+    void addElements(Handle node, uint32_t elementType, uint32_t count)
+    {
+        const std::weak_ptr<OpenDynamicData> self = node->weak_from_this();
+        node->m_children.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            std::string elementName;
+            elementName += "[";
+            elementName += std::to_string(i);
+            elementName += "]";
+            node->m_children.push_back(
+                m_plan.createNode(elementType, elementName, OpenDDS::DCPS::Extensibility::FINAL, self));
+        }
+    }
+
+    Handle child(Handle node, uint32_t index)
+    {
+        return node->m_children[index].get();
+    }
+
+    std::string name(Handle node) const
+    {
+        return node->getName();
+    }
+
+    template<typename T>
+    void setValue(Handle node, T value)
+    {
+        node->setValue(value);
+    }
+
+    void setString(Handle node, const char* value)
+    {
+        node->setStringValue(value);
+    }
+
+    template<typename T>
+    T* packedElements(Handle)
+    {
+        // Trees hold every element in its own node
+        return nullptr;
+    }
+
+    void fail()
+    {
+        m_failed = true;
+    }
+
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+private:
+
+    const DecodePlan& m_plan;
+    bool m_failed = false;
+};
+
+
+/// Appends FlatSample nodes. Children of a node are allocated together, and
+/// primitive elements are packed in the value buffer instead.
+class DecodePlan::FlatBuilder
+{
+public:
+
+    using Handle = uint32_t;
+
+    FlatBuilder(const DecodePlan& plan, FlatSample& sample)
+        : m_plan(plan)
+        , m_sample(sample)
+        , m_nodes(sample.m_nodes)
+        , m_values(sample.m_values)
+        , m_strings(sample.m_strings)
+    {}
+
+    Handle root()
+    {
+        m_nodes.resize(1);
+        return 0;
+    }
+
+    void addMembers(Handle node, const TypeEntry& entry)
+    {
+        const uint32_t first = allocate(node, entry.memberCount);
+        for (uint32_t i = 0; i < entry.memberCount; ++i)
+        {
+            FlatSample::Node& child = m_nodes[first + i];
+            child.member = entry.firstMember + i;
+            child.type = m_plan.m_members[entry.firstMember + i].type;
+        }
+    }
+
+    void addElements(Handle node, uint32_t elementType, uint32_t count)
+    {
+        const uint32_t elementSize = m_plan.m_types[m_nodes[node].type].elementSize;
+        if (elementSize > 0)
+        {
+            // Aligned to the element size, so the values can be read in place.
+            // New values are zero, like the defaults of unread nodes.
+            const size_t offset = (m_values.size() + elementSize - 1) / elementSize * elementSize;
+            m_values.resize(offset + static_cast<size_t>(count) * elementSize);
+            m_nodes[node].value.uint64 = offset;
+            m_nodes[node].childCount = count;
+            return;
+        }
+
+        const uint32_t first = allocate(node, count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_nodes[first + i].type = elementType;
+        }
+    }
+
+    Handle child(Handle node, uint32_t index)
+    {
+        return m_nodes[node].firstChild + index;
+    }
+
+    std::string name(Handle node) const
+    {
+        return FlatSample::Member(&m_sample, node).getName();
+    }
+
+    template<typename T>
+    void setValue(Handle node, T value)
+    {
+        store(m_nodes[node].value, value);
+    }
+
+    void setString(Handle node, const char* value)
+    {
+        m_nodes[node].value.uint64 = m_strings.size();
+        m_strings.insert(m_strings.end(), value, value + std::strlen(value) + 1);
+    }
+
+    template<typename T>
+    T* packedElements(Handle node)
+    {
+        return reinterpret_cast<T*>(m_values.data() + m_nodes[node].value.uint64);
+    }
+
+    void fail()
+    {
+        m_failed = true;
+    }
+
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+private:
+
+    uint32_t allocate(Handle node, uint32_t count)
+    {
+        const uint32_t first = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.resize(m_nodes.size() + count);
+        m_nodes[node].firstChild = first;
+        m_nodes[node].childCount = count;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_nodes[first + i].parent = node;
+        }
+        return first;
+    }
+
+    static void store(FlatSample::Value& v, CORBA::Long value) { v.int32 = value; }
+    static void store(FlatSample::Value& v, CORBA::Short value) { v.int16 = value; }
+    static void store(FlatSample::Value& v, CORBA::UShort value) { v.uint16 = value; }
+    static void store(FlatSample::Value& v, CORBA::ULong value) { v.uint32 = value; }
+    static void store(FlatSample::Value& v, CORBA::Float value) { v.float32 = value; }
+    static void store(FlatSample::Value& v, CORBA::Double value) { v.float64 = value; }
+    static void store(FlatSample::Value& v, CORBA::Char value) { v.char8 = value; }
+    static void store(FlatSample::Value& v, CORBA::WChar value) { v.char16 = value; }
+    static void store(FlatSample::Value& v, CORBA::Octet value) { v.uint8 = value; }
+    static void store(FlatSample::Value& v, CORBA::LongLong value) { v.int64 = value; }
+    static void store(FlatSample::Value& v, CORBA::ULongLong value) { v.uint64 = value; }
+    static void store(FlatSample::Value& v, CORBA::Boolean value) { v.boolean = value; }
+
+    const DecodePlan& m_plan;
+    const FlatSample& m_sample;
+    std::vector<FlatSample::Node>& m_nodes;
+    std::vector<char>& m_values;
+    std::vector<char>& m_strings;
+    bool m_failed = false;
+};
+
+
+//------------------------------------------------------------------------------
+DecodePlan::DecodePlan(const CORBA::TypeCode_var& typeCode,
+                       OpenDDS::DCPS::Encoding::Kind encodingKind,
+                       OpenDDS::DCPS::Extensibility extensibility)
+    : m_typeCode(typeCode)
+    , m_encodingKind(encodingKind)
+    , m_extensibility(extensibility)
+{
+    std::map<CORBA::TypeCode_ptr, uint32_t> visited;
+    addType(m_typeCode.in(), visited);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> DecodePlan::decode(OpenDDS::DCPS::Serializer& stream) const
+{
+    TreeBuilder builder(*this);
+    std::shared_ptr<OpenDynamicData> sample = builder.root();
+    decodeChildren(builder, sample.get(), 0, 0, stream);
+    return builder.failed() ? std::shared_ptr<OpenDynamicData>() : sample;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<FlatSample> DecodePlan::decodeFlat(OpenDDS::DCPS::Serializer& stream,
+                                                   const std::shared_ptr<FlatSamplePool>& pool) const
+{
+    std::shared_ptr<FlatSample> sample = std::make_shared<FlatSample>(shared_from_this(), pool);
+
+    FlatBuilder builder(*this, *sample);
+    decodeChildren(builder, builder.root(), 0, 0, stream);
+    return builder.failed() ? std::shared_ptr<FlatSample>() : sample;
+}
+
+
+//------------------------------------------------------------------------------
+CORBA::TCKind DecodePlan::typeKind(uint32_t type) const
+{
+    return m_types[type].kind;
+}
+
+
+//------------------------------------------------------------------------------
+uint32_t DecodePlan::elementType(uint32_t type) const
+{
+    return m_types[type].element;
+}
+
+
+//------------------------------------------------------------------------------
+size_t DecodePlan::elementSize(uint32_t type) const
+{
+    return m_types[type].elementSize;
+}
+
+
+//------------------------------------------------------------------------------
+const std::string& DecodePlan::memberName(uint32_t member) const
+{
+    return m_members[member].name;
+}
+
+
+//------------------------------------------------------------------------------
+OpenDDS::DCPS::Encoding::Kind DecodePlan::encodingKind() const
+{
+    return m_encodingKind;
+}
+
+
+//------------------------------------------------------------------------------
+CORBA::TypeCode_var DecodePlan::typeCode() const
+{
+    return m_typeCode;
+}
+
+
+//------------------------------------------------------------------------------
+CORBA::TypeCode_var DecodePlan::typeCode(uint32_t type) const
+{
+    return CORBA::TypeCode::_duplicate(m_types[type].typeCode.in());
+}
+
+
+//------------------------------------------------------------------------------
+uint32_t DecodePlan::addType(CORBA::TypeCode_ptr declaredType,
+                             std::map<CORBA::TypeCode_ptr, uint32_t>& visited)
+{
+    CORBA::TypeCode_var resolvedType = unalias(declaredType);
+    CORBA::TypeCode_ptr typeCode = resolvedType.in();
+
+    const auto found = visited.find(typeCode);
+    if (found != visited.end())
+    {
+        return found->second;
+    }
+
+    // Reserve the entry before visiting the contents, so recursive types
+    // refer back to it instead of expanding forever.
+    const uint32_t index = static_cast<uint32_t>(m_types.size());
+    visited[typeCode] = index;
+    m_types.emplace_back();
+
+    TypeEntry entry;
+    entry.typeCode = resolvedType;
+    entry.kind = typeCode ? typeCode->kind() : CORBA::tk_null;
+
+    const bool xcdr2 = (m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1);
+
+    if (entry.kind == CORBA::tk_array || entry.kind == CORBA::tk_sequence)
+    {
+        entry.contentType = typeCode->content_type();
+        const CORBA::TypeCode_var elementType = unalias(entry.contentType.in());
+        const CORBA::TCKind elementKind = elementType->kind();
+
+        entry.containsComplexTypes = !isPrimitiveKind(elementKind);
+        entry.elementSize = primitiveSize(elementKind);
+        entry.delimited = xcdr2 && entry.containsComplexTypes;
+        entry.length = (entry.kind == CORBA::tk_array) ? typeCode->length() : 0;
+        entry.bound = (entry.kind == CORBA::tk_sequence) ? typeCode->length() : 0;
+        entry.element = addType(elementType.in(), visited);
+
+        // Only the length of a sequence is sure to be on the wire
+        const uint64_t header = entry.delimited ? 4 : 0;
+        const uint64_t elements = (entry.kind == CORBA::tk_array) ?
+            static_cast<uint64_t>(entry.length) * m_types[entry.element].minSize : 4;
+        entry.minSize = static_cast<uint32_t>(std::min<uint64_t>(header + elements, UINT32_MAX));
+    }
+    else if (entry.kind == CORBA::tk_struct)
+    {
+        // Structs always have a delimiter if XCDR2
+        entry.containsComplexTypes = true;
+        entry.delimited = xcdr2;
+
+        std::vector<MemberEntry> members;
+        const CORBA::ULong memberCount = typeCode->member_count();
+        for (CORBA::ULong i = 0; i < memberCount; i++)
+        {
+            CORBA::TypeCode_var memberType = typeCode->member_type(i);
+            if (CORBA::is_nil(memberType.in()))
+            {
+                std::cerr << "Invalid member type on ["
+                          << i
+                          << "] within "
+                          << typeCode->name()
+                          << std::endl;
+
+                continue;
+            }
+
+            MemberEntry member;
+            member.name = typeCode->member_name(i);
+            member.typeCode = memberType;
+            member.type = addType(memberType.in(), visited);
+            members.push_back(member);
+        }
+
+        // Appended after the member types, so each struct's members are
+        // contiguous even when a member type adds structs of its own.
+        entry.firstMember = static_cast<uint32_t>(m_members.size());
+        entry.memberCount = static_cast<uint32_t>(members.size());
+        m_members.insert(m_members.end(), members.begin(), members.end());
+
+        // A recursive member is still empty here and counts as 0
+        uint64_t minSize = entry.delimited ? 4 : 0;
+        for (const MemberEntry& member : members)
+        {
+            minSize += m_types[member.type].minSize;
+        }
+        entry.minSize = static_cast<uint32_t>(std::min<uint64_t>(minSize, UINT32_MAX));
+    }
+    else
+    {
+        entry.containsComplexTypes = !isPrimitiveKind(entry.kind);
+
+        // A string is at least its length, and a wchar may be a single octet
+        if (entry.kind == CORBA::tk_string || entry.kind == CORBA::tk_wstring)
+        {
+            entry.minSize = 4;
+        }
+        else
+        {
+            entry.minSize = (entry.kind == CORBA::tk_wchar) ? 1 : primitiveSize(entry.kind);
+        }
+    }
+
+    m_types[index] = entry;
+    return index;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> DecodePlan::createNode(uint32_t type,
+                                                        const std::string& name,
+                                                        OpenDDS::DCPS::Extensibility extensibility,
+                                                        const std::weak_ptr<OpenDynamicData>& parent) const
+{
+    const TypeEntry& entry = m_types[type];
+
+    std::shared_ptr<OpenDynamicData> node =
+        std::make_shared<OpenDynamicData>(CORBA::TypeCode::_duplicate(entry.typeCode.in()),
+                                          m_encodingKind, extensibility, parent);
+    node->m_containsComplexTypes = entry.containsComplexTypes;
+    if (!name.empty())
+    {
+        node->setName(name);
+    }
+    return node;
+}
+
+
+//------------------------------------------------------------------------------
+template<typename Builder>
+void DecodePlan::decodeChildren(Builder& builder,
+                                typename Builder::Handle node,
+                                uint32_t type,
+                                uint32_t length,
+                                OpenDDS::DCPS::Serializer& stream) const
+{
+    const TypeEntry& entry = m_types[type];
+
+    if (entry.kind == CORBA::tk_struct)
+    {
+        builder.addMembers(node, entry);
+        for (uint32_t i = 0; i < entry.memberCount; ++i)
+        {
+            const MemberEntry& member = m_members[entry.firstMember + i];
+
+            // Protection for inconsistent topics or junk data
+            const bool wasGood = stream.good_bit();
+            if (!decodeNode(builder, builder.child(node, i), member.type, stream) && wasGood)
+            {
+                std::cerr << "Failed to deserialize '" << member.name << "'" << std::endl;
+            }
+        }
+        return;
+    }
+
+    if (entry.kind != CORBA::tk_array && entry.kind != CORBA::tk_sequence)
+    {
+        return;
+    }
+
+    const uint32_t count = (entry.kind == CORBA::tk_array) ? entry.length : length;
+    builder.addElements(node, entry.element, count);
+
+    if (entry.elementSize > 0)
+    {
+        if (count > 0 && stream.good_bit() &&
+            !readPrimitives(builder, node, m_types[entry.element].kind, count, stream))
+        {
+            std::cerr << "Failed to deserialize '" << builder.name(node) << "'" << std::endl;
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        decodeNode(builder, builder.child(node, i), entry.element, stream);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+template<typename Builder>
+bool DecodePlan::decodeNode(Builder& builder,
+                            typename Builder::Handle node,
+                            uint32_t type,
+                            OpenDDS::DCPS::Serializer& stream) const
+{
+    const TypeEntry& entry = m_types[type];
+
+    // Once the stream or the sample fails, only build the remaining structure
+    if (!stream.good_bit() || builder.failed())
+    {
+        decodeChildren(builder, node, type, 0, stream);
+        return false;
+    }
+
+    //XCDR2 adds a delimiter header before every struct, and every sequence, and array of complex types and/or appendable extensibility
+    if (entry.delimited)
+    {
+        uint32_t delim_header = 0;
+        if (!(stream >> delim_header))
+        {
+            std::cerr << "DecodePlan::decodeNode: "
+                      << "Could not read stream delimiter"
+                      << std::endl;
+            decodeChildren(builder, node, type, 0, stream);
+            return false;
+        }
+    }
+
+    bool pass = true;
+    switch (entry.kind)
+    {
+    case CORBA::tk_long:
+    {
+        CORBA::Long value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_short:
+    {
+        CORBA::Short value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_ushort:
+    {
+        CORBA::UShort value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong:
+    {
+        CORBA::ULong value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_float:
+    {
+        CORBA::Float value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_double:
+    {
+        CORBA::Double value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_char:
+    {
+        CORBA::Char value = 0;
+        pass = (stream >> ACE_InputCDR::to_char(value));
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_wchar:
+    {
+        CORBA::WChar value = 0;
+        pass = (stream >> ACE_InputCDR::to_wchar(value));
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_octet:
+    {
+        CORBA::Octet value = 0;
+        pass = (stream >> ACE_InputCDR::to_octet(value));
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_longlong:
+    {
+        CORBA::LongLong value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_ulonglong:
+    {
+        CORBA::ULongLong value = 0;
+        pass = (stream >> value);
+        builder.setValue(node, value);
+        break;
+    }
+    case CORBA::tk_boolean:
+    {
+        CORBA::Boolean value = 0;
+        pass = (stream >> ACE_InputCDR::to_boolean(value));
+        // Boolean values are often int on the wire (Example: true == 42)
+        // Force them to [0|1]
+        builder.setValue(node, static_cast<CORBA::Boolean>(value != 0));
+        break;
+    }
+    case CORBA::tk_string:
+    {
+        TAO::String_Manager stringMan;
+        pass = (stream >> stringMan.out());
+        const char* value = stringMan;
+        builder.setString(node, value);
+        break;
+    }
+    case CORBA::tk_sequence:
+    {
+        CORBA::ULong length = 0;
+        pass = (stream >> length);
+        if (pass && !validLength(entry, length, stream))
+        {
+            std::cerr << "DecodePlan::decodeNode: "
+                      << "Invalid sequence length (" << length << ") for '"
+                      << builder.name(node) << "'"
+                      << std::endl;
+            builder.fail();
+            pass = false;
+        }
+        decodeChildren(builder, node, type, pass ? length : 0, stream);
+        break;
+    }
+    case CORBA::tk_array:
+    case CORBA::tk_struct:
+        decodeChildren(builder, node, type, 0, stream);
+        break;
+    case CORBA::tk_wstring: // TODO?
+    case CORBA::tk_union: // TODO?
+    default:
+        std::cerr << "DecodePlan::decodeNode: "
+                  << "Unsupported type (" << entry.kind << ")"
+                  << std::endl;
+        pass = false;
+        break;
+    }
+
+    return pass;
+}
+
+
+//------------------------------------------------------------------------------
+bool DecodePlan::validLength(const TypeEntry& entry,
+                             uint32_t length,
+                             OpenDDS::DCPS::Serializer& stream) const
+{
+    if (entry.bound > 0 && length > entry.bound)
+    {
+        return false;
+    }
+
+    // Elements that may take no bytes still count as one, so a junk length
+    // can never allocate more elements than there are bytes left
+    const uint32_t elementSize = std::max<uint32_t>(m_types[entry.element].minSize, 1);
+    return length <= stream.length() / elementSize;
+}
+
+
+//------------------------------------------------------------------------------
+template<typename Builder>
+bool DecodePlan::readPrimitives(Builder& builder,
+                                typename Builder::Handle node,
+                                CORBA::TCKind elementKind,
+                                uint32_t count,
+                                OpenDDS::DCPS::Serializer& stream)
+{
+    switch (elementKind)
+    {
+    case CORBA::tk_long:
+        return readArray<CORBA::Long>(builder, node, count, [&stream](CORBA::Long* v, ACE_CDR::ULong n) {
+            return stream.read_long_array(v, n);
+        });
+    case CORBA::tk_short:
+        return readArray<CORBA::Short>(builder, node, count, [&stream](CORBA::Short* v, ACE_CDR::ULong n) {
+            return stream.read_short_array(v, n);
+        });
+    case CORBA::tk_ushort:
+        return readArray<CORBA::UShort>(builder, node, count, [&stream](CORBA::UShort* v, ACE_CDR::ULong n) {
+            return stream.read_ushort_array(v, n);
+        });
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong:
+        return readArray<CORBA::ULong>(builder, node, count, [&stream](CORBA::ULong* v, ACE_CDR::ULong n) {
+            return stream.read_ulong_array(v, n);
+        });
+    case CORBA::tk_float:
+        return readArray<CORBA::Float>(builder, node, count, [&stream](CORBA::Float* v, ACE_CDR::ULong n) {
+            return stream.read_float_array(v, n);
+        });
+    case CORBA::tk_double:
+        return readArray<CORBA::Double>(builder, node, count, [&stream](CORBA::Double* v, ACE_CDR::ULong n) {
+            return stream.read_double_array(v, n);
+        });
+    case CORBA::tk_char:
+        return readArray<CORBA::Char>(builder, node, count, [&stream](CORBA::Char* v, ACE_CDR::ULong n) {
+            return stream.read_char_array(v, n);
+        });
+    case CORBA::tk_wchar:
+        // Wide characters are encoded differently depending on the CDR
+        // version, so they are read one at a time like operator<< does
+        return readArray<CORBA::WChar>(builder, node, count, [&stream](CORBA::WChar* v, ACE_CDR::ULong n) {
+            for (ACE_CDR::ULong i = 0; i < n; ++i)
+            {
+                if (!(stream >> ACE_InputCDR::to_wchar(v[i])))
+                {
+                    return false;
+                }
+            }
+            return true;
+        });
+    case CORBA::tk_octet:
+        return readArray<CORBA::Octet>(builder, node, count, [&stream](CORBA::Octet* v, ACE_CDR::ULong n) {
+            return stream.read_octet_array(v, n);
+        });
+    case CORBA::tk_longlong:
+        return readArray<CORBA::LongLong>(builder, node, count, [&stream](CORBA::LongLong* v, ACE_CDR::ULong n) {
+            return stream.read_longlong_array(v, n);
+        });
+    case CORBA::tk_ulonglong:
+        return readArray<CORBA::ULongLong>(builder, node, count, [&stream](CORBA::ULongLong* v, ACE_CDR::ULong n) {
+            return stream.read_ulonglong_array(v, n);
+        });
+    case CORBA::tk_boolean:
+    {
+        // Not a std::vector, since std::vector<bool> has no contiguous storage
+        std::unique_ptr<CORBA::Boolean[]> values;
+        CORBA::Boolean* read = builder.template packedElements<CORBA::Boolean>(node);
+        if (!read)
+        {
+            values.reset(new CORBA::Boolean[count]);
+            read = values.get();
+        }
+
+        if (!stream.read_boolean_array(read, count))
+        {
+            return false;
+        }
+
+        // Boolean values are often int on the wire. Force them to [0|1]
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(read);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const CORBA::Boolean value = (bytes[i] != 0);
+            if (values)
+            {
+                builder.setValue(builder.child(node, i), value);
+            }
+            else
+            {
+                read[i] = value;
+            }
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> DecodePlan::materialize(const FlatSample& sample) const
+{
+    TreeBuilder builder(*this);
+    std::shared_ptr<OpenDynamicData> root = builder.root();
+    materializeChildren(sample, 0, builder, root.get());
+    return root;
+}
+
+
+//------------------------------------------------------------------------------
+void DecodePlan::materializeChildren(const FlatSample& sample,
+                                     uint32_t index,
+                                     TreeBuilder& builder,
+                                     OpenDynamicData* node) const
+{
+    static_assert(sizeof(FlatSample::Value) == sizeof(OpenDynamicData::SimpleTypeUnion),
+                  "FlatSample::Value must mirror OpenDynamicData::SimpleTypeUnion");
+
+    const std::vector<FlatSample::Node>& nodes = sample.nodes();
+    const FlatSample::Node& flatNode = nodes[index];
+    const TypeEntry& entry = m_types[flatNode.type];
+
+    if (entry.kind == CORBA::tk_struct)
+    {
+        builder.addMembers(node, entry);
+    }
+    else if (entry.kind == CORBA::tk_array || entry.kind == CORBA::tk_sequence)
+    {
+        builder.addElements(node, entry.element, flatNode.childCount);
+    }
+    else
+    {
+        return;
+    }
+
+    // Packed primitive elements are copied into the element nodes
+    if (entry.elementSize > 0)
+    {
+        const char* packed = sample.m_values.data() + flatNode.value.uint64;
+        for (uint32_t i = 0; i < flatNode.childCount; ++i)
+        {
+            std::memcpy(&builder.child(node, i)->m_value, packed + i * entry.elementSize, entry.elementSize);
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < flatNode.childCount; ++i)
+    {
+        const uint32_t childIndex = flatNode.firstChild + i;
+        const FlatSample::Node& flatChild = nodes[childIndex];
+        OpenDynamicData* child = builder.child(node, i);
+
+        const CORBA::TCKind kind = m_types[flatChild.type].kind;
+        if (kind == CORBA::tk_string)
+        {
+            child->setStringValue(FlatSample::Member(&sample, childIndex).getStringValue());
+        }
+        else if (isPrimitiveKind(kind))
+        {
+            std::memcpy(&child->m_value, &flatChild.value, sizeof(FlatSample::Value));
+        }
+        else
+        {
+            materializeChildren(sample, childIndex, builder, child);
+        }
+    }
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,315 @@
+#ifndef __DECODE_PLAN_H__
+#define __DECODE_PLAN_H__
+
+#ifdef WIN32
+#pragma warning(push, 0)  //No DDS warnings
+#endif
+
+#include <dds/DCPS/Serializer.h>
+#include <dds/DCPS/TypeSupportImpl.h>
+#include <tao/AnyTypeCode/TypeCode.h>
+
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FlatSample;
+class FlatSamplePool;
+class OpenDynamicData;
+
+
+/**
+ * @brief Precompiled instructions for decoding samples of one topic type.
+ * @details OpenDynamicData::operator<< resolves the TypeCode of every member
+ *          and rebuilds the child list of every sequence for each sample. The
+ *          plan does that work once when the topic is opened: it flattens the
+ *          TypeCode into a table of type entries with the kind, the XCDR2
+ *          delimiter rule, the fixed array length and the member names already
+ *          resolved. Decoding then only walks the table against the
+ *          Serializer. Sequences and arrays of primitives are read with a
+ *          single bulk Serializer call per member.
+ *
+ *          The same table is the schema of FlatSample: a flat sample stores
+ *          only values and refers to the plan for member names and types.
+ * @remarks The resulting tree is identical to CreateOpenDynamicData followed
+ *          by operator<<. A plan is immutable once built, so any number of
+ *          threads may decode with it concurrently. Plans must be owned by a
+ *          std::shared_ptr, since flat samples keep their schema alive.
+ */
+class DecodePlan : public std::enable_shared_from_this<DecodePlan>
+{
+public:
+
+    /**
+     * @brief Build the plan for a topic type.
+     * @param[in] typeCode The type of the topic.
+     * @param[in] encodingKind The CDR encoding of the samples.
+     * @param[in] extensibility The extensibility of the topic type.
+     */
+    DecodePlan(const CORBA::TypeCode_var& typeCode,
+               OpenDDS::DCPS::Encoding::Kind encodingKind,
+               OpenDDS::DCPS::Extensibility extensibility);
+
+    /**
+     * @brief Decode a sample.
+     * @param[in] stream The serialized sample, positioned after the delimiter
+     *            header of the topic type, if any.
+     * @return The decoded sample. Members after a decoding error keep their
+     *         default values, the same as with operator<<. Null if a
+     *         sequence length is impossible.
+     */
+    std::shared_ptr<OpenDynamicData> decode(OpenDDS::DCPS::Serializer& stream) const;
+
+    /**
+     * @brief Decode a sample into the compact flat representation.
+     * @param[in] stream The serialized sample, positioned after the delimiter
+     *            header of the topic type, if any.
+     * @param[in] pool Provides the sample buffers. May be nullptr.
+     * @return The decoded sample. Equivalent to the tree from decode(), and
+     *         null in the same cases.
+     */
+    std::shared_ptr<FlatSample> decodeFlat(OpenDDS::DCPS::Serializer& stream,
+                                           const std::shared_ptr<FlatSamplePool>& pool) const;
+
+    /**
+     * @brief Build the OpenDynamicData tree of a flat sample.
+     * @param[in] sample A sample decoded with this plan.
+     * @return The tree, identical to what decode() returns for the same data.
+     */
+    std::shared_ptr<OpenDynamicData> materialize(const FlatSample& sample) const;
+
+    /**
+     * @brief Get the kind of a type in the schema.
+     * @param[in] type The type index.
+     * @return The type kind.
+     */
+    CORBA::TCKind typeKind(uint32_t type) const;
+
+    /**
+     * @brief Get the element type of an array or sequence type in the schema.
+     * @param[in] type The type index.
+     * @return The element type index.
+     */
+    uint32_t elementType(uint32_t type) const;
+
+    /**
+     * @brief Get the size of the packed elements of a type in the schema.
+     * @details Flat samples store the elements of arrays and sequences of
+     *          primitives packed in a value buffer instead of as nodes.
+     * @param[in] type The type index.
+     * @return The size of one element in bytes, or 0 if the elements of the
+     *         type are not packed.
+     */
+    size_t elementSize(uint32_t type) const;
+
+    /**
+     * @brief Get the name of a struct member in the schema.
+     * @param[in] member The member index.
+     * @return The member name.
+     */
+    const std::string& memberName(uint32_t member) const;
+
+    /**
+     * @brief Get the CDR encoding this plan was built for.
+     * @return The encoding kind.
+     */
+    OpenDDS::DCPS::Encoding::Kind encodingKind() const;
+
+    /**
+     * @brief Get the type this plan was built for.
+     * @return The topic type.
+     */
+    CORBA::TypeCode_var typeCode() const;
+
+    /**
+     * @brief Get a type in the schema.
+     * @param[in] type The type index.
+     * @return The resolved (unaliased) type.
+     */
+    CORBA::TypeCode_var typeCode(uint32_t type) const;
+
+private:
+
+    /// One resolved type in the plan.
+    struct TypeEntry
+    {
+        /// The resolved (unaliased) type.
+        CORBA::TypeCode_var typeCode;
+
+        /// The declared element type of array and sequence types.
+        CORBA::TypeCode_var contentType;
+
+        /// The kind of the type.
+        CORBA::TCKind kind = CORBA::tk_null;
+
+        /// True if the type is preceded by an XCDR2 delimiter header.
+        bool delimited = false;
+
+        /// Mirrors OpenDynamicData::containsComplexTypes().
+        bool containsComplexTypes = false;
+
+        /// The element size of an array or sequence of primitives, which is
+        /// read in one pass and packed in flat samples. 0 for other types.
+        uint32_t elementSize = 0;
+
+        /// The element count of array types.
+        uint32_t length = 0;
+
+        /// The maximum element count of bounded sequence types. 0 if unbounded.
+        uint32_t bound = 0;
+
+        /// The fewest bytes one value of the type takes on the wire.
+        uint32_t minSize = 0;
+
+        /// The element type of array and sequence types.
+        uint32_t element = 0;
+
+        /// The first member in m_members of struct types.
+        uint32_t firstMember = 0;
+
+        /// The number of members of struct types.
+        uint32_t memberCount = 0;
+    };
+
+    /// One struct member in the plan.
+    struct MemberEntry
+    {
+        /// The member name.
+        std::string name;
+
+        /// The declared member type.
+        CORBA::TypeCode_var typeCode;
+
+        /// The member type in m_types.
+        uint32_t type = 0;
+    };
+
+    /**
+     * @brief Add a type and everything it contains to the plan.
+     * @param[in] declaredType The type to add. Not adopted.
+     * @param[in,out] visited Types already in the plan. Breaks recursive types.
+     * @return The index of the type in m_types.
+     */
+    uint32_t addType(CORBA::TypeCode_ptr declaredType,
+                     std::map<CORBA::TypeCode_ptr, uint32_t>& visited);
+
+    /// Builds OpenDynamicData trees. Defined in the source file.
+    class TreeBuilder;
+
+    /// Builds FlatSample nodes. Defined in the source file.
+    class FlatBuilder;
+
+    /**
+     * @brief Create an empty node for a type.
+     * @param[in] type The type of the node in m_types.
+     * @param[in] name The member name of the node.
+     * @param[in] extensibility The extensibility of the node.
+     * @param[in] parent The parent node.
+     * @return The new node.
+     */
+    std::shared_ptr<OpenDynamicData> createNode(uint32_t type,
+                                                const std::string& name,
+                                                OpenDDS::DCPS::Extensibility extensibility,
+                                                const std::weak_ptr<OpenDynamicData>& parent) const;
+
+    /**
+     * @brief Create the children of a node and read their values.
+     * @param[in,out] builder Creates the nodes of the output representation.
+     * @param[in] node The node to fill.
+     * @param[in] type The type of the node in m_types.
+     * @param[in] length The element count if the node is a sequence.
+     * @param[in] stream The serialized sample. Once the stream has failed the
+     *            children are still created, but nothing more is read.
+     */
+    template<typename Builder>
+    void decodeChildren(Builder& builder,
+                        typename Builder::Handle node,
+                        uint32_t type,
+                        uint32_t length,
+                        OpenDDS::DCPS::Serializer& stream) const;
+
+    /**
+     * @brief Read the value of one node.
+     * @param[in,out] builder Creates the nodes of the output representation.
+     * @param[in] node The node to fill.
+     * @param[in] type The type of the node in m_types.
+     * @param[in] stream The serialized sample.
+     * @return True on success; false otherwise.
+     */
+    template<typename Builder>
+    bool decodeNode(Builder& builder,
+                    typename Builder::Handle node,
+                    uint32_t type,
+                    OpenDDS::DCPS::Serializer& stream) const;
+
+    /**
+     * @brief Check a sequence length read from the wire.
+     * @details A length beyond the bound of the sequence, or with more
+     *          elements than the rest of the stream can hold, comes from a
+     *          corrupt or inconsistent sample. It is rejected before anything
+     *          is allocated for the elements.
+     * @param[in] entry The sequence type.
+     * @param[in] length The element count read from the stream.
+     * @param[in] stream The serialized sample, positioned after the length.
+     * @return True if the length is possible; false otherwise.
+     */
+    bool validLength(const TypeEntry& entry,
+                     uint32_t length,
+                     OpenDDS::DCPS::Serializer& stream) const;
+
+    /**
+     * @brief Read all elements of a primitive array or sequence at once.
+     * @param[in,out] builder Creates the nodes of the output representation.
+     * @param[in] node The array or sequence node with its elements created.
+     * @param[in] elementKind The kind of the elements.
+     * @param[in] count The number of elements.
+     * @param[in] stream The serialized sample.
+     * @return True on success; false otherwise.
+     */
+    template<typename Builder>
+    static bool readPrimitives(Builder& builder,
+                               typename Builder::Handle node,
+                               CORBA::TCKind elementKind,
+                               uint32_t count,
+                               OpenDDS::DCPS::Serializer& stream);
+
+    /**
+     * @brief Copy the children of a flat node into a tree node.
+     * @param[in] sample The flat sample.
+     * @param[in] index The flat node.
+     * @param[in,out] builder Creates the tree nodes.
+     * @param[in] node The tree node to fill.
+     */
+    void materializeChildren(const FlatSample& sample,
+                             uint32_t index,
+                             TreeBuilder& builder,
+                             OpenDynamicData* node) const;
+
+    /// The type of the topic.
+    CORBA::TypeCode_var m_typeCode;
+
+    /// The CDR encoding of the samples.
+    const OpenDDS::DCPS::Encoding::Kind m_encodingKind;
+
+    /// The extensibility of the topic type.
+    const OpenDDS::DCPS::Extensibility m_extensibility;
+
+    /// The resolved types. The topic type is at index 0.
+    std::vector<TypeEntry> m_types;
+
+    /// The members of every struct type, grouped by struct.
+    std::vector<MemberEntry> m_members;
+
+}; // End class DecodePlan
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,391 @@
+#include "decode_worker_pool.h"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+
+namespace
+{
+
+/// The weight of a new measurement in the moving averages is 1/AVERAGE_WEIGHT.
+const int64_t AVERAGE_WEIGHT = 16;
+
+/**
+ * @brief Add a measurement to a moving average.
+ * @remarks Only one thread may update an average at a time.
+ * @param[in,out] average The moving average.
+ * @param[in] value The new measurement.
+ */
+void updateAverage(std::atomic<int64_t>& average, int64_t value)
+{
+    const int64_t previous = average.load(std::memory_order_relaxed);
+    average.store(previous + (value - previous) / AVERAGE_WEIGHT, std::memory_order_relaxed);
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+bool IngestPolicy::fromString(const QString& text, IngestPolicy& policy)
+{
+    if (text == "newest")
+    {
+        policy = IngestPolicy();
+        return true;
+    }
+
+    if (text == "oldest")
+    {
+        policy = IngestPolicy();
+        policy.mode = IngestMode::DropOldest;
+        return true;
+    }
+
+    if (text.startsWith("decimate:"))
+    {
+        bool ok = false;
+        const double rate = text.mid(9).toDouble(&ok);
+        if (!ok || rate <= 0.0)
+        {
+            return false;
+        }
+        policy.mode = IngestMode::Decimate;
+        policy.rate = rate;
+        return true;
+    }
+
+    return false;
+}
+
+
+//------------------------------------------------------------------------------
+QString IngestPolicy::toString() const
+{
+    switch (mode)
+    {
+    case IngestMode::DropOldest:
+        return "oldest";
+    case IngestMode::Decimate:
+        return "decimate:" + QString::number(rate);
+    default:
+        return "newest";
+    }
+}
+
+
+//------------------------------------------------------------------------------
+QString IngestPolicy::description() const
+{
+    switch (mode)
+    {
+    case IngestMode::DropOldest:
+        return "Drop oldest";
+    case IngestMode::Decimate:
+        return "Decimate to " + QString::number(rate) + " Hz";
+    default:
+        return "Drop newest";
+    }
+}
+
+
+//------------------------------------------------------------------------------
+DecodeQueue::DecodeQueue(const std::shared_ptr<DecodeWorkerPool>& pool,
+                         size_t capacity,
+                         Handler handler)
+    : m_pool(pool)
+    , m_queue(capacity)
+    , m_handler(std::move(handler))
+    , m_mode(IngestMode::DropNewest)
+    , m_decimationPeriod(0)
+    , m_nextAcceptTime(0)
+    , m_scheduled(false)
+    , m_closed(false)
+    , m_processed(0)
+    , m_dropped(0)
+    , m_decimated(0)
+    , m_failed(0)
+    , m_queueLatency(0)
+    , m_processLatency(0)
+{}
+
+
+//------------------------------------------------------------------------------
+bool DecodeQueue::push(PendingSample&& sample)
+{
+    const IngestMode mode = m_mode;
+    sample.queuedTime = steadyTimeNanoseconds();
+
+    if (mode == IngestMode::Decimate)
+    {
+        // Accepted samples claim the next slot of the rate grid. A sample
+        // after a gap starts a new grid, so the rate never exceeds the limit.
+        const int64_t period = m_decimationPeriod;
+        int64_t next = m_nextAcceptTime;
+        int64_t following = 0;
+        do
+        {
+            if (sample.queuedTime < next)
+            {
+                ++m_decimated;
+                return false;
+            }
+            following = (sample.queuedTime - next < period) ?
+                next + period : sample.queuedTime + period;
+        }
+        while (!m_nextAcceptTime.compare_exchange_weak(next, following));
+    }
+
+    bool queued = m_queue.push(std::move(sample));
+    if (mode == IngestMode::DropOldest)
+    {
+        // Make room by discarding the oldest waiting sample. A worker may
+        // free a slot meanwhile, so only retry a few times.
+        PendingSample oldest;
+        for (int attempt = 0; !queued && attempt < 4; ++attempt)
+        {
+            if (m_queue.pop(oldest))
+            {
+                ++m_dropped;
+            }
+            queued = m_queue.push(std::move(sample));
+        }
+    }
+
+    if (!queued)
+    {
+        ++m_dropped;
+        return false;
+    }
+
+    // Only the push that finds the queue idle hands it to the workers
+    if (!m_scheduled.exchange(true))
+    {
+        const std::shared_ptr<DecodeWorkerPool> pool = m_pool.lock();
+        if (pool)
+        {
+            pool->schedule(shared_from_this());
+        }
+    }
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeQueue::setPolicy(const IngestPolicy& policy)
+{
+    m_decimationPeriod = (policy.rate > 0.0) ? static_cast<int64_t>(1.0e9 / policy.rate) : 0;
+    m_nextAcceptTime = 0;
+    m_mode = policy.mode;
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeQueue::close()
+{
+    QMutexLocker locker(&m_drainMutex);
+    m_closed = true;
+    m_handler = Handler();
+}
+
+
+//------------------------------------------------------------------------------
+DecodeQueueStats DecodeQueue::stats() const
+{
+    DecodeQueueStats stats;
+    stats.depth = m_queue.size();
+    stats.capacity = m_queue.capacity();
+    stats.processed = m_processed;
+    stats.dropped = m_dropped;
+    stats.decimated = m_decimated;
+    stats.failed = m_failed;
+    stats.queueLatency = m_queueLatency;
+    stats.processLatency = m_processLatency;
+    return stats;
+}
+
+
+//------------------------------------------------------------------------------
+int64_t DecodeQueue::steadyTimeNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeQueue::drain(size_t maxCount)
+{
+    QMutexLocker locker(&m_drainMutex);
+
+    PendingSample sample;
+    while (m_batch.size() < maxCount && m_queue.pop(sample))
+    {
+        m_batch.push_back(std::move(sample));
+    }
+
+    // A closed queue only releases what is left
+    if (!m_closed && !m_batch.empty())
+    {
+        const int64_t startTime = steadyTimeNanoseconds();
+        for (const PendingSample& queued : m_batch)
+        {
+            updateAverage(m_queueLatency, startTime - queued.queuedTime);
+        }
+
+        // A worker thread must never let an exception escape, so a corrupt
+        // sample costs its batch rather than the whole application
+        bool handled = false;
+        try
+        {
+            m_handler(m_batch);
+            handled = true;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "DecodeQueue::drain: " << e.what() << std::endl;
+        }
+        catch (...)
+        {
+            std::cerr << "DecodeQueue::drain: Unknown exception" << std::endl;
+        }
+
+        const int64_t count = static_cast<int64_t>(m_batch.size());
+        updateAverage(m_processLatency, (steadyTimeNanoseconds() - startTime) / count);
+        if (handled)
+        {
+            m_processed += m_batch.size();
+        }
+        else
+        {
+            m_failed += m_batch.size();
+        }
+    }
+
+    // Keeps the capacity for the next batch
+    m_batch.clear();
+}
+
+
+//------------------------------------------------------------------------------
+DecodeWorkerPool::DecodeWorkerPool(int threadCount)
+    : m_stopping(false)
+{
+    start(threadCount);
+}
+
+
+//------------------------------------------------------------------------------
+DecodeWorkerPool::~DecodeWorkerPool()
+{
+    stop();
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeWorkerPool::setThreadCount(int threadCount)
+{
+    threadCount = std::max(threadCount, 1);
+    if (threadCount == static_cast<int>(m_threads.size()))
+    {
+        return;
+    }
+
+    stop();
+    start(threadCount);
+}
+
+
+//------------------------------------------------------------------------------
+int DecodeWorkerPool::threadCount() const
+{
+    return static_cast<int>(m_threads.size());
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeWorkerPool::schedule(const std::shared_ptr<DecodeQueue>& queue)
+{
+    QMutexLocker locker(&m_mutex);
+    m_ready.push_back(queue);
+    m_wakeup.wakeOne();
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeWorkerPool::start(int threadCount)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = false;
+    }
+
+    for (int i = 0; i < std::max(threadCount, 1); ++i)
+    {
+        m_threads.emplace_back(&DecodeWorkerPool::run, this);
+    }
+
+    // Queues that became ready while no worker ran
+    QMutexLocker locker(&m_mutex);
+    m_wakeup.wakeAll();
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeWorkerPool::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wakeup.wakeAll();
+    }
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+
+//------------------------------------------------------------------------------
+void DecodeWorkerPool::run()
+{
+    for (;;)
+    {
+        std::shared_ptr<DecodeQueue> queue;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stopping && m_ready.empty())
+            {
+                m_wakeup.wait(&m_mutex);
+            }
+
+            if (m_stopping)
+            {
+                return;
+            }
+
+            queue = std::move(m_ready.front());
+            m_ready.pop_front();
+        }
+
+        queue->drain(BATCH_SIZE);
+
+        // Release the queue, then take it back if samples arrived meanwhile.
+        // A listener that pushed after the release schedules it itself.
+        queue->m_scheduled = false;
+        if (queue->m_queue.size() > 0 && !queue->m_scheduled.exchange(true))
+        {
+            schedule(queue);
+        }
+    }
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,357 @@
+#ifndef __DECODE_WORKER_POOL_H__
+#define __DECODE_WORKER_POOL_H__
+
+#include "bounded_queue.h"
+
+#ifdef WIN32
+#pragma warning(push, 0)  //No DDS warnings
+#endif
+
+#include <dds/DdsDynamicDataC.h>
+#include <dds/DCPS/GuidUtils.h>
+#include <dds/DCPS/Message_Block_Ptr.h>
+#include <dds/DCPS/Serializer.h>
+
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class DecodeWorkerPool;
+
+
+/// What a topic does with received samples while it can't keep up.
+enum class IngestMode
+{
+    /// Discard the arriving sample when the decode queue is full.
+    DropNewest,
+    /// Discard the oldest queued sample to make room for the arriving one.
+    DropOldest,
+    /// Accept at most IngestPolicy::rate samples per second and discard the
+    /// rest, then discard the arriving sample when the queue is still full.
+    Decimate
+};
+
+
+/**
+ * @brief How a topic limits the samples it takes in.
+ */
+struct IngestPolicy
+{
+    /// The overload behavior.
+    IngestMode mode = IngestMode::DropNewest;
+
+    /// The maximum samples per second in IngestMode::Decimate.
+    double rate = 0.0;
+
+    /**
+     * @brief Parse a policy from its text form.
+     * @param[in] text "newest", "oldest" or "decimate:<hz>".
+     * @param[out] policy The parsed policy, unchanged on failure.
+     * @return True if the text was a valid policy.
+     */
+    static bool fromString(const QString& text, IngestPolicy& policy);
+
+    /**
+     * @brief Get the text form accepted by fromString.
+     * @return The policy as text.
+     */
+    QString toString() const;
+
+    /**
+     * @brief Get a description for the user interface.
+     * @return The policy as readable text.
+     */
+    QString description() const;
+};
+
+
+/**
+ * @brief A received sample waiting to be decoded and stored.
+ * @details The listener fills this with a duplicate of the raw sample and
+ *          returns right away. Only one of the sample members is set.
+ */
+struct PendingSample
+{
+    /// The serialized sample from a recorder.
+    OpenDDS::DCPS::Message_Block_Ptr block;
+
+    /// The sample from a DynamicDataReader.
+    DDS::DynamicData_var dynamicSample;
+
+    /// The source timestamp in nanoseconds since the Unix epoch.
+    int64_t sourceTime = 0;
+
+    /// The local reception time in nanoseconds since the Unix epoch.
+    int64_t receptionTime = 0;
+
+    /// The GUID of the data writer.
+    OpenDDS::DCPS::GUID_t writer = OpenDDS::DCPS::GUID_UNKNOWN;
+
+    /// The encoding of block.
+    OpenDDS::DCPS::Encoding::Kind encodingKind = OpenDDS::DCPS::Encoding::KIND_XCDR1;
+
+    /// The byte order of block.
+    OpenDDS::DCPS::Endianness endianness = OpenDDS::DCPS::ENDIAN_NATIVE;
+
+    /// True if block was preceded by an encapsulation header.
+    bool cdrEncapsulation = false;
+
+    /// When the sample was queued, in steady clock nanoseconds.
+    int64_t queuedTime = 0;
+};
+
+
+/**
+ * @brief A snapshot of the decode pipeline of one topic.
+ */
+struct DecodeQueueStats
+{
+    /// The number of samples waiting.
+    size_t depth = 0;
+
+    /// The maximum number of samples waiting.
+    size_t capacity = 0;
+
+    /// The number of samples decoded and stored.
+    uint64_t processed = 0;
+
+    /// The number of samples dropped because the queue was full.
+    uint64_t dropped = 0;
+
+    /// The number of samples discarded to keep to the decimation rate.
+    uint64_t decimated = 0;
+
+    /// The number of samples lost because processing them threw.
+    uint64_t failed = 0;
+
+    /// The average time a sample waited in the queue, in nanoseconds.
+    int64_t queueLatency = 0;
+
+    /// The average time to decode, filter and store a sample, in nanoseconds.
+    /// Measured per batch and divided among its samples.
+    int64_t processLatency = 0;
+};
+
+
+/**
+ * @brief The bounded queue of received samples of one topic.
+ * @details The DDS listener pushes without blocking and a worker of the pool
+ *          drains the queue. At most one worker drains a queue at a time, so
+ *          the samples of a topic are stored in the order they arrived, while
+ *          different topics are decoded in parallel.
+ */
+class DecodeQueue : public std::enable_shared_from_this<DecodeQueue>
+{
+public:
+
+    /// Decodes, filters and stores a batch of samples, oldest first. Called on
+    /// a worker thread. The handler may move from the samples. An exception
+    /// loses the rest of the batch but never the worker.
+    using Handler = std::function<void(std::vector<PendingSample>&)>;
+
+    /**
+     * @brief Constructor for the decode queue.
+     * @param[in] pool The workers that drain the queue.
+     * @param[in] capacity The maximum number of samples waiting.
+     * @param[in] handler Processes the samples a batch at a time.
+     */
+    DecodeQueue(const std::shared_ptr<DecodeWorkerPool>& pool,
+                size_t capacity,
+                Handler handler);
+
+    /**
+     * @brief Queue a received sample and wake a worker if needed.
+     * @details Never blocks. The ingest policy decides which sample is
+     *          discarded when the queue is full.
+     * @param[in] sample The sample. Moved from only if it was queued.
+     * @return True if the sample was queued; false if it was discarded.
+     */
+    bool push(PendingSample&& sample);
+
+    /**
+     * @brief Change how the queue handles overload.
+     * @details Applies from the next received sample.
+     * @param[in] policy The ingest policy.
+     */
+    void setPolicy(const IngestPolicy& policy);
+
+    /**
+     * @brief Stop processing samples.
+     * @details Waits for a worker that is processing a sample of this queue.
+     *          The handler is never called once this returns.
+     */
+    void close();
+
+    /**
+     * @brief Get the state of the queue.
+     * @return The queue depth, counters and average latencies.
+     */
+    DecodeQueueStats stats() const;
+
+    /**
+     * @brief Get the current steady clock time.
+     * @return The time in nanoseconds.
+     */
+    static int64_t steadyTimeNanoseconds();
+
+private:
+
+    friend class DecodeWorkerPool;
+
+    /**
+     * @brief Process queued samples. Called by one worker at a time.
+     * @param[in] maxCount The maximum number of samples to process.
+     */
+    void drain(size_t maxCount);
+
+    /// The workers that drain the queue.
+    std::weak_ptr<DecodeWorkerPool> m_pool;
+
+    /// The samples waiting.
+    BoundedQueue<PendingSample> m_queue;
+
+    /// Processes the samples a batch at a time.
+    Handler m_handler;
+
+    /// The batch being processed. Reused by every drain.
+    std::vector<PendingSample> m_batch;
+
+    /// The overload behavior.
+    std::atomic<IngestMode> m_mode;
+
+    /// The minimum steady clock nanoseconds between accepted samples when
+    /// decimating.
+    std::atomic<int64_t> m_decimationPeriod;
+
+    /// The steady clock time from which the next sample is accepted when
+    /// decimating.
+    std::atomic<int64_t> m_nextAcceptTime;
+
+    /// True while the queue is waiting for or owned by a worker.
+    std::atomic<bool> m_scheduled;
+
+    /// Held while a worker drains, so close() can wait for it. Also protects m_batch.
+    QMutex m_drainMutex;
+
+    /// True once close() was called. Protected by m_drainMutex.
+    bool m_closed;
+
+    /// The number of samples processed.
+    std::atomic<uint64_t> m_processed;
+
+    /// The number of samples dropped because the queue was full.
+    std::atomic<uint64_t> m_dropped;
+
+    /// The number of samples discarded by decimation.
+    std::atomic<uint64_t> m_decimated;
+
+    /// The number of samples lost because the handler threw.
+    std::atomic<uint64_t> m_failed;
+
+    /// Moving average of the queue latency in nanoseconds.
+    std::atomic<int64_t> m_queueLatency;
+
+    /// Moving average of the processing latency in nanoseconds.
+    std::atomic<int64_t> m_processLatency;
+
+}; // End class DecodeQueue
+
+
+/**
+ * @brief Worker threads that decode the samples received by all topics.
+ * @details Queues with waiting samples are handed to the workers in the
+ *          order they became ready. A worker processes a batch of one queue
+ *          before moving on, so a busy topic can't starve the others.
+ */
+class DecodeWorkerPool
+{
+public:
+
+    /**
+     * @brief Constructor for the worker pool.
+     * @param[in] threadCount The number of worker threads.
+     */
+    explicit DecodeWorkerPool(int threadCount);
+
+    /**
+     * @brief Destructor for the worker pool. Joins the workers.
+     */
+    ~DecodeWorkerPool();
+
+    /**
+     * @brief Change the number of worker threads.
+     * @details The current workers finish their batch and are replaced.
+     *          Waiting queues are kept.
+     * @param[in] threadCount The number of worker threads.
+     */
+    void setThreadCount(int threadCount);
+
+    /**
+     * @brief Get the number of worker threads.
+     * @return The number of worker threads.
+     */
+    int threadCount() const;
+
+    /// The number of samples a worker processes from one queue at a time.
+    static const size_t BATCH_SIZE = 64;
+
+private:
+
+    friend class DecodeQueue;
+
+    /**
+     * @brief Hand a queue with waiting samples to the workers.
+     * @param[in] queue The queue. Its m_scheduled flag is already set.
+     */
+    void schedule(const std::shared_ptr<DecodeQueue>& queue);
+
+    /**
+     * @brief Start the worker threads.
+     * @param[in] threadCount The number of worker threads.
+     */
+    void start(int threadCount);
+
+    /**
+     * @brief Stop and join the worker threads.
+     */
+    void stop();
+
+    /**
+     * @brief The worker thread loop.
+     */
+    void run();
+
+    /// Protects m_ready and m_stopping.
+    mutable QMutex m_mutex;
+
+    /// Wakes a worker when a queue is ready or the workers stop.
+    QWaitCondition m_wakeup;
+
+    /// The queues with waiting samples, in the order they became ready.
+    std::deque<std::shared_ptr<DecodeQueue>> m_ready;
+
+    /// True while the workers are asked to exit.
+    bool m_stopping;
+
+    /// The worker threads.
+    std::vector<std::thread> m_threads;
+
+}; // End class DecodeWorkerPool
+
+#endif
+
+/**
+ * @}
+ */
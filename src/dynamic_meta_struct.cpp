@@ -15,6 +15,13 @@ DynamicMetaStruct::~DynamicMetaStruct()
 }
 
 
+//------------------------------------------------------------------------------
+void DynamicMetaStruct::setSample(const std::shared_ptr<OpenDynamicData>& sample)
+{
+    m_sample = sample;
+}
+
+
 //------------------------------------------------------------------------------
 OpenDDS::DCPS::Value DynamicMetaStruct::getValue(const void*, DDS::MemberId) const
 {
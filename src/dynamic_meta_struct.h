@@ -32,6 +32,13 @@ public:
      */
     ~DynamicMetaStruct();
 
+    /**
+     * @brief Point the MetaStruct at another sample of the same type.
+     * @details Lets a compiled filter reuse one MetaStruct for every sample.
+     * @param[in] sample The sample to read values from.
+     */
+    void setSample(const std::shared_ptr<OpenDynamicData>& sample);
+
     /**
      * @brief This function does nothing, but is required by MetaStruct.
      */
@@ -121,7 +128,7 @@ public:
 private:
 
     /// Stores the sample type information and values.
-    const std::shared_ptr<OpenDynamicData> m_sample;
+    std::shared_ptr<OpenDynamicData> m_sample;
 
 };
 
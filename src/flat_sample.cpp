@@ -0,0 +1,329 @@
+#include "flat_sample.h"
+#include "decode_plan.h"
+#include "open_dynamic_data.h"
+
+#include <cstdlib>
+#include <cstring>
+
+
+//------------------------------------------------------------------------------
+FlatSample::Member::Member(const FlatSample* sample, uint32_t node, uint32_t element)
+    : m_sample(sample)
+    , m_node(node)
+    , m_element(element)
+{}
+
+
+//------------------------------------------------------------------------------
+FlatSample::Member::operator bool() const
+{
+    return m_sample && m_node < m_sample->m_nodes.size();
+}
+
+
+//------------------------------------------------------------------------------
+uint32_t FlatSample::Member::index() const
+{
+    return m_node;
+}
+
+
+//------------------------------------------------------------------------------
+std::string FlatSample::Member::getName() const
+{
+    if (m_element != NO_NODE)
+    {
+        return "[" + std::to_string(m_element) + "]";
+    }
+
+    const Node& node = m_sample->m_nodes[m_node];
+    if (node.member != NO_NODE)
+    {
+        return m_sample->m_schema->memberName(node.member);
+    }
+
+    if (node.parent == NO_NODE)
+    {
+        return std::string();
+    }
+
+    const uint32_t position = m_node - m_sample->m_nodes[node.parent].firstChild;
+    return "[" + std::to_string(position) + "]";
+}
+
+
+//------------------------------------------------------------------------------
+CORBA::TCKind FlatSample::Member::getKind() const
+{
+    return m_sample->m_schema->typeKind(type());
+}
+
+
+//------------------------------------------------------------------------------
+CORBA::TypeCode_var FlatSample::Member::getTypeCode() const
+{
+    return m_sample->m_schema->typeCode(type());
+}
+
+
+//------------------------------------------------------------------------------
+size_t FlatSample::Member::getLength() const
+{
+    if (m_element != NO_NODE)
+    {
+        return 0;
+    }
+    return m_sample->m_nodes[m_node].childCount;
+}
+
+
+//------------------------------------------------------------------------------
+FlatSample::Member FlatSample::Member::getMember(size_t index) const
+{
+    if (m_element != NO_NODE)
+    {
+        return Member();
+    }
+
+    const Node& node = m_sample->m_nodes[m_node];
+    if (index >= node.childCount)
+    {
+        return Member();
+    }
+
+    if (m_sample->m_schema->elementSize(node.type) > 0)
+    {
+        return Member(m_sample, m_node, static_cast<uint32_t>(index));
+    }
+    return Member(m_sample, node.firstChild + static_cast<uint32_t>(index));
+}
+
+
+//------------------------------------------------------------------------------
+FlatSample::Member FlatSample::Member::getMember(const std::string& fullName) const
+{
+    // Same lookup rules as OpenDynamicData::getMember
+    if (fullName.empty() || m_element != NO_NODE)
+    {
+        return Member();
+    }
+
+    const Node& node = m_sample->m_nodes[m_node];
+
+    // First, check for simple matches
+    if (fullName[0] == '[')
+    {
+        // Elements are addressed by position, so parse instead of comparing
+        char* end = nullptr;
+        const unsigned long position = std::strtoul(fullName.c_str() + 1, &end, 10);
+        if (end && end[0] == ']' && end[1] == '\0' && position < node.childCount)
+        {
+            if (m_sample->m_schema->elementSize(node.type) > 0)
+            {
+                return Member(m_sample, m_node, static_cast<uint32_t>(position));
+            }
+            if (m_sample->m_nodes[node.firstChild].member == NO_NODE)
+            {
+                return Member(m_sample, node.firstChild + static_cast<uint32_t>(position));
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < node.childCount; ++i)
+        {
+            const Node& child = m_sample->m_nodes[node.firstChild + i];
+            if (child.member != NO_NODE && m_sample->m_schema->memberName(child.member) == fullName)
+            {
+                return Member(m_sample, node.firstChild + i);
+            }
+        }
+    }
+
+    // If we got here, search the children for the array or nested struct member
+    const size_t childNameSpot = fullName.find_first_of("[.", 1);
+    if (childNameSpot == std::string::npos)
+    {
+        return Member();
+    }
+
+    std::string childName = fullName.substr(childNameSpot);
+
+    // Eat '.' from struct members
+    if (childName.size() > 1 && childName[0] == '.')
+    {
+        childName = childName.substr(1);
+    }
+
+    const Member parent = getMember(fullName.substr(0, childNameSpot));
+    if (!parent)
+    {
+        return parent;
+    }
+
+    // Search into the complex type
+    return parent.getMember(childName);
+}
+
+
+//------------------------------------------------------------------------------
+const char* FlatSample::Member::getStringValue() const
+{
+    if (getKind() != CORBA::tk_string)
+    {
+        std::cerr << "Warning: Accessed a string value to a non-string member: "
+                  << getName()
+                  << std::endl;
+        return "";
+    }
+    return m_sample->m_strings.data() + m_sample->m_nodes[m_node].value.uint64;
+}
+
+
+//------------------------------------------------------------------------------
+CORBA::TCKind FlatSample::Member::getElementKind() const
+{
+    const uint32_t nodeType = m_sample->m_nodes[m_node].type;
+    if (m_element != NO_NODE || m_sample->m_schema->elementSize(nodeType) == 0)
+    {
+        return CORBA::tk_null;
+    }
+    return m_sample->m_schema->typeKind(m_sample->m_schema->elementType(nodeType));
+}
+
+
+//------------------------------------------------------------------------------
+uint32_t FlatSample::Member::type() const
+{
+    const uint32_t nodeType = m_sample->m_nodes[m_node].type;
+    return (m_element == NO_NODE) ? nodeType : m_sample->m_schema->elementType(nodeType);
+}
+
+
+//------------------------------------------------------------------------------
+FlatSample::Value FlatSample::Member::readValue() const
+{
+    const Node& node = m_sample->m_nodes[m_node];
+    if (m_element == NO_NODE)
+    {
+        return node.value;
+    }
+
+    // Every member of the union starts at its first byte
+    Value value;
+    value.uint64 = 0;
+    const size_t size = m_sample->m_schema->elementSize(node.type);
+    std::memcpy(&value, m_sample->m_values.data() + node.value.uint64 + m_element * size, size);
+    return value;
+}
+
+
+//------------------------------------------------------------------------------
+FlatSample::FlatSample(const std::shared_ptr<const DecodePlan>& schema,
+                       const std::shared_ptr<FlatSamplePool>& pool)
+    : m_schema(schema)
+    , m_pool(pool)
+{
+    if (m_pool)
+    {
+        m_pool->acquire(m_nodes, m_values, m_strings);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+FlatSample::~FlatSample()
+{
+    if (m_pool)
+    {
+        m_pool->release(m_nodes, m_values, m_strings);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+FlatSample::Member FlatSample::root() const
+{
+    return Member(this, 0);
+}
+
+
+//------------------------------------------------------------------------------
+const std::vector<FlatSample::Node>& FlatSample::nodes() const
+{
+    return m_nodes;
+}
+
+
+//------------------------------------------------------------------------------
+const DecodePlan& FlatSample::schema() const
+{
+    return *m_schema;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> FlatSample::toOpenDynamicData() const
+{
+    return m_schema->materialize(*this);
+}
+
+
+//------------------------------------------------------------------------------
+size_t FlatSample::size() const
+{
+    return sizeof(FlatSample) +
+           m_nodes.capacity() * sizeof(Node) +
+           m_values.capacity() +
+           m_strings.capacity();
+}
+
+
+//------------------------------------------------------------------------------
+FlatSamplePool::FlatSamplePool(size_t maxSpare)
+    : m_maxSpare(maxSpare)
+{}
+
+
+//------------------------------------------------------------------------------
+void FlatSamplePool::acquire(std::vector<FlatSample::Node>& nodes,
+                             std::vector<char>& values,
+                             std::vector<char>& strings)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (m_spare.empty())
+    {
+        return;
+    }
+
+    nodes.swap(m_spare.back().nodes);
+    values.swap(m_spare.back().values);
+    strings.swap(m_spare.back().strings);
+    m_spare.pop_back();
+}
+
+
+//------------------------------------------------------------------------------
+void FlatSamplePool::release(std::vector<FlatSample::Node>& nodes,
+                             std::vector<char>& values,
+                             std::vector<char>& strings)
+{
+    nodes.clear();
+    values.clear();
+    strings.clear();
+
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (m_spare.size() < m_maxSpare)
+    {
+        Buffers buffers;
+        buffers.nodes.swap(nodes);
+        buffers.values.swap(values);
+        buffers.strings.swap(strings);
+        m_spare.push_back(std::move(buffers));
+    }
+}
+
+
+/**
+ * @}
+ */
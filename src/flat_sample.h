@@ -0,0 +1,383 @@
+#ifndef __FLAT_SAMPLE_H__
+#define __FLAT_SAMPLE_H__
+
+#ifdef WIN32
+#pragma warning(push, 0)  //No DDS warnings
+#endif
+
+#include <tao/AnyTypeCode/TypeCode.h>
+#include <ace/CDR_Base.h>
+
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class DecodePlan;
+class FlatSamplePool;
+class OpenDynamicData;
+
+
+/**
+ * @brief Compact representation of a decoded TypeCode sample.
+ * @details A sample is stored as one contiguous array of fixed-size nodes, one
+ *          buffer of packed primitive elements and one buffer holding every
+ *          string value. Member names and types are not stored per sample;
+ *          they come from the DecodePlan of the topic, which acts as the
+ *          shared per-type schema. The children of a node are contiguous and
+ *          addressed by index. An array or sequence of primitives is a single
+ *          node referring to its elements in the value buffer, where they take
+ *          only their own size. A sample costs three allocations no matter how
+ *          many members it has, and those buffers are recycled through a
+ *          per-topic FlatSamplePool.
+ * @remarks A sample is immutable once decoded. Code written against the
+ *          OpenDynamicData tree can read it through Member, which has the same
+ *          read API, or convert it with toOpenDynamicData().
+ */
+class FlatSample
+{
+public:
+
+    /// Marks a missing node, parent or member.
+    static const uint32_t NO_NODE = 0xFFFFFFFF;
+
+    /// Holds the value of a primitive node. Mirrors OpenDynamicData's storage.
+    union Value
+    {
+        ACE_CDR::ULongLong uint64;
+        ACE_CDR::LongLong int64;
+        ACE_CDR::ULong uint32;
+        ACE_CDR::Long int32;
+        ACE_CDR::UShort uint16;
+        ACE_CDR::Short int16;
+        ACE_CDR::Octet uint8;
+        ACE_CDR::Char char8;
+        ACE_CDR::WChar char16;
+        ACE_CDR::Double float64;
+        ACE_CDR::Float float32;
+        ACE_CDR::Boolean boolean;
+    };
+
+    /// One member, element or primitive value of the sample.
+    struct Node
+    {
+        /// The type of the node in the schema.
+        uint32_t type = 0;
+
+        /// The struct member in the schema, or NO_NODE for elements and the root.
+        uint32_t member = NO_NODE;
+
+        /// The parent node, or NO_NODE for the root.
+        uint32_t parent = NO_NODE;
+
+        /// The first child node. Children are contiguous.
+        uint32_t firstChild = 0;
+
+        /// The number of child nodes, or of packed elements.
+        uint32_t childCount = 0;
+
+        /// The primitive value, the offset of a string value in the string
+        /// buffer, or the offset of packed elements in the value buffer.
+        Value value;
+
+        Node() { value.uint64 = 0; }
+    };
+
+    /**
+     * @brief Read-only view of one node with the OpenDynamicData read API.
+     * @details Lets code that reads OpenDynamicData members work on a flat
+     *          sample without building the tree. A packed element is viewed
+     *          through the node of its array or sequence. The view is only
+     *          valid while the sample is alive.
+     */
+    class Member
+    {
+    public:
+
+        /**
+         * @brief Constructor for a member view.
+         * @param[in] sample The sample holding the node, or nullptr.
+         * @param[in] node The node index.
+         * @param[in] element The packed element of the node, or NO_NODE to
+         *            view the node itself.
+         */
+        Member(const FlatSample* sample = nullptr, uint32_t node = NO_NODE, uint32_t element = NO_NODE);
+
+        /**
+         * @brief Check whether this view refers to a node.
+         * @return True if the member was found; false otherwise.
+         */
+        explicit operator bool() const;
+
+        /**
+         * @brief Get the index of the node in the sample.
+         * @return The node index. For a packed element, the node of its
+         *         array or sequence.
+         */
+        uint32_t index() const;
+
+        /**
+         * @brief Get the member name, or "[i]" for an array element.
+         * @return The member name.
+         */
+        std::string getName() const;
+
+        /**
+         * @brief Get the type kind of the member.
+         * @return The type kind.
+         */
+        CORBA::TCKind getKind() const;
+
+        /**
+         * @brief Get the type of the member.
+         * @return The resolved type, such as the enumerators of an enum.
+         */
+        CORBA::TypeCode_var getTypeCode() const;
+
+        /**
+         * @brief Get the number of children.
+         * @return The number of struct members or elements.
+         */
+        size_t getLength() const;
+
+        /**
+         * @brief Get a child by position.
+         * @param[in] index The child position.
+         * @return The child, or an invalid view if the index is out of range.
+         */
+        Member getMember(size_t index) const;
+
+        /**
+         * @brief Find a nested member by its path, such as "a.b[3].c".
+         * @param[in] fullName The member path relative to this member.
+         * @return The member, or an invalid view if it wasn't found.
+         */
+        Member getMember(const std::string& fullName) const;
+
+        /**
+         * @brief Get the value of a string member.
+         * @return The string value.
+         */
+        const char* getStringValue() const;
+
+        /**
+         * @brief Get the element kind of an array or sequence of primitives.
+         * @return The element kind, or tk_null if the elements are not packed.
+         */
+        CORBA::TCKind getElementKind() const;
+
+        /**
+         * @brief Get the packed elements of an array or sequence of primitives.
+         * @details T must be the CORBA type of getElementKind(), such as
+         *          CORBA::Float for tk_float or CORBA::ULong for tk_enum.
+         * @return The getLength() elements, or nullptr if the elements are
+         *         not packed.
+         */
+        template<class T>
+        const T* getElements() const
+        {
+            if (getElementKind() == CORBA::tk_null)
+            {
+                return nullptr;
+            }
+            return reinterpret_cast<const T*>(
+                m_sample->m_values.data() + m_sample->m_nodes[m_node].value.uint64);
+        }
+
+        /**
+         * @brief Get the value of a primitive member.
+         * @return The value converted to T.
+         */
+        template<class T>
+        T getValue() const
+        {
+            const Value value = readValue();
+            switch (getKind())
+            {
+            case CORBA::tk_long: return static_cast<T>(value.int32);
+            case CORBA::tk_short: return static_cast<T>(value.int16);
+            case CORBA::tk_ushort: return static_cast<T>(value.uint16);
+            case CORBA::tk_enum:
+            case CORBA::tk_ulong: return static_cast<T>(value.uint32);
+            case CORBA::tk_float: return static_cast<T>(value.float32);
+            case CORBA::tk_double: return static_cast<T>(value.float64);
+            case CORBA::tk_boolean: return static_cast<T>(value.boolean);
+            case CORBA::tk_char: return static_cast<T>(value.char8);
+            case CORBA::tk_wchar: return static_cast<T>(value.char16);
+            case CORBA::tk_octet: return static_cast<T>(value.uint8);
+            case CORBA::tk_longlong: return static_cast<T>(value.int64);
+            case CORBA::tk_ulonglong: return static_cast<T>(value.uint64);
+            default:
+                std::cerr << "FlatSample::Member::getValue: "
+                          << "Unsupported type (" << getKind() << ")"
+                          << std::endl;
+                break;
+            }
+            return static_cast<T>(0);
+        }
+
+    private:
+
+        /**
+         * @brief Get the type of the node or packed element.
+         * @return The type index in the schema.
+         */
+        uint32_t type() const;
+
+        /**
+         * @brief Get the raw value of the node or packed element.
+         * @return The value.
+         */
+        Value readValue() const;
+
+        /// The sample holding the node.
+        const FlatSample* m_sample;
+
+        /// The node index.
+        uint32_t m_node;
+
+        /// The packed element of the node, or NO_NODE.
+        uint32_t m_element;
+    };
+
+    /**
+     * @brief Constructor for an empty flat sample.
+     * @param[in] schema The decode plan of the sample type.
+     * @param[in] pool Provides and recycles the buffers. May be nullptr.
+     */
+    FlatSample(const std::shared_ptr<const DecodePlan>& schema,
+               const std::shared_ptr<FlatSamplePool>& pool);
+
+    /**
+     * @brief Destructor for the flat sample. Returns the buffers to the pool.
+     */
+    ~FlatSample();
+
+    FlatSample(const FlatSample&) = delete;
+    FlatSample& operator=(const FlatSample&) = delete;
+
+    /**
+     * @brief Get a view of the root struct.
+     * @return The root member.
+     */
+    Member root() const;
+
+    /**
+     * @brief Get the node array.
+     * @return The nodes. The root is at index 0.
+     */
+    const std::vector<Node>& nodes() const;
+
+    /**
+     * @brief Get the decode plan describing the sample type.
+     * @return The schema.
+     */
+    const DecodePlan& schema() const;
+
+    /**
+     * @brief Build the equivalent OpenDynamicData tree.
+     * @details Adapter for code that needs a tree, such as the table model
+     *          and the content filter.
+     * @return The tree.
+     */
+    std::shared_ptr<OpenDynamicData> toOpenDynamicData() const;
+
+    /**
+     * @brief Get the memory held by this sample.
+     * @return The size in bytes.
+     */
+    size_t size() const;
+
+private:
+
+    friend class DecodePlan;
+
+    /// The decode plan of the sample type.
+    std::shared_ptr<const DecodePlan> m_schema;
+
+    /// Recycles m_nodes and m_strings when the sample is deleted.
+    std::shared_ptr<FlatSamplePool> m_pool;
+
+    /// The nodes in decode order. Index 0 is the root struct.
+    std::vector<Node> m_nodes;
+
+    /// The packed elements of every array and sequence of primitives, each
+    /// run aligned to its element size.
+    std::vector<char> m_values;
+
+    /// Every string value, each terminated by a NUL.
+    std::vector<char> m_strings;
+
+}; // End class FlatSample
+
+
+/**
+ * @brief Per-topic pool of FlatSample buffers.
+ * @details Samples are created by the listener thread and deleted by whoever
+ *          drops the last reference, usually on eviction, so the pool is
+ *          thread safe. Recycled buffers keep their capacity, so a topic in
+ *          steady state decodes without allocating.
+ */
+class FlatSamplePool
+{
+public:
+
+    /**
+     * @brief Constructor for the sample pool.
+     * @param[in] maxSpare The maximum number of buffer sets kept for reuse.
+     */
+    explicit FlatSamplePool(size_t maxSpare = 64);
+
+    /**
+     * @brief Take a set of empty buffers.
+     * @param[out] nodes The node buffer.
+     * @param[out] values The packed element buffer.
+     * @param[out] strings The string buffer.
+     */
+    void acquire(std::vector<FlatSample::Node>& nodes,
+                 std::vector<char>& values,
+                 std::vector<char>& strings);
+
+    /**
+     * @brief Return a set of buffers for reuse.
+     * @param[in,out] nodes The node buffer. Left empty.
+     * @param[in,out] values The packed element buffer. Left empty.
+     * @param[in,out] strings The string buffer. Left empty.
+     */
+    void release(std::vector<FlatSample::Node>& nodes,
+                 std::vector<char>& values,
+                 std::vector<char>& strings);
+
+private:
+
+    /// The buffers of one sample.
+    struct Buffers
+    {
+        std::vector<FlatSample::Node> nodes;
+        std::vector<char> values;
+        std::vector<char> strings;
+    };
+
+    /// Protects m_spare.
+    std::mutex m_mutex;
+
+    /// The maximum number of buffer sets kept for reuse.
+    const size_t m_maxSpare;
+
+    /// Buffer sets ready for reuse.
+    std::vector<Buffers> m_spare;
+
+}; // End class FlatSamplePool
+
+#endif
+
+/**
+ * @}
+ */
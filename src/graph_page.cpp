@@ -1,6 +1,40 @@
 #include "graph_page.h"
 #include "dds_data.h"
 
+#include <algorithm>
+
+
+namespace
+{
+
+/**
+ * @brief Get the color of the curve at a plot index.
+ * @details The first colors are fixed. Later curves step around the hue
+ *          circle by the golden angle, so any number of neighboring curves
+ *          stay distinguishable.
+ * @param[in] index The plot index.
+ * @return The curve color.
+ */
+QColor plotColor(int index)
+{
+    switch (index)
+    {
+        case 0: return QColor(0, 0, 255, 255); // Blue
+        case 1: return QColor(255, 0, 0, 255); // Red
+        case 2: return QColor(0, 200, 0, 255); // Green
+        case 3: return QColor(0, 0, 0, 255); // Black
+        case 4: return QColor(255, 155, 0, 255); // Orange
+        case 5: return QColor(255, 0, 255, 255); // Purple
+        default: break;
+    }
+
+    const int hue = static_cast<int>(index * 137.508) % 360;
+    const int value = (index % 2 == 0) ? 200 : 150;
+    return QColor::fromHsv(hue, 255, value);
+}
+
+} // End namespace
+
 
 //------------------------------------------------------------------------------
 GraphPage::GraphPage(QWidget* parent) :
@@ -11,7 +45,10 @@ GraphPage::GraphPage(QWidget* parent) :
     m_picker(NULL),
     m_marker(NULL),
     m_refreshTimer(this),
-    m_xCounter(0.0),
+    m_followLatest(true),
+    m_replotPending(true),
+    m_openGL(false),
+    m_frameTime(0.0),
     m_xMin(0.0),
     m_xMax(0.0)
 {
@@ -24,14 +61,6 @@ GraphPage::GraphPage(QWidget* parent) :
     attachButton->hide();
     ejectButton->hide(); // Remove this line after attach/detach is ready
 
-    // Setup the initial x-axis data values;
-    for (int i = 0; i < MAX_HISTORY; i++)
-    {
-        m_xData[i] = MAX_HISTORY - i - 1;
-    }
-    m_xMin = m_xData[MAX_HISTORY - 1];
-    m_xMax = m_xData[MAX_HISTORY - m_propertiesUI->viewSpinBox->value()];
-
 
     //--------------------------------------------------------------------------
     // Set the permanent attributes of the qwt plot
@@ -41,16 +70,11 @@ GraphPage::GraphPage(QWidget* parent) :
     grid->setPen(QColor(0, 0, 0, 50));
     grid->attach(qwtPlot);
 
-    // Qt::WA_PaintOnScreen is only supported for X11, but leads
-    // to substantial bugs with Qt 4.2.x/Windows
-    #if QT_VERSION >= 0x040000
-    #ifdef Q_WS_X11
-    qwtPlot->canvas()->setAttribute(Qt::WA_PaintOnScreen, true);
-    #endif
-    #endif
-
-    // Insert the variable legend at the bottom of the screen
-    qwtPlot->insertLegend(new QwtLegend(), QwtPlot::BottomLegend);
+    // Insert the variable legend at the bottom of the screen. Clicking an
+    // entry hides or shows its curve.
+    QwtLegend* legend = new QwtLegend();
+    legend->setDefaultItemMode(QwtLegendData::Checkable);
+    qwtPlot->insertLegend(legend, QwtPlot::BottomLegend);
 
     // Create and set the custom label x-axis object
     m_xAxis = new TimeScaleDraw;
@@ -61,14 +85,14 @@ GraphPage::GraphPage(QWidget* parent) :
     QwtScaleWidget* xScale = qwtPlot->axisWidget(QwtPlot::xBottom);
     xScale->setMinBorderDist(0, 35);
 
-    qwtPlot->setCanvasBackground(QColor(255, 255, 255, 255));
     qwtPlot->plotLayout()->setAlignCanvasToScales(true);
 
-    // Configure the picker
-    m_picker = new QwtPicker(qwtPlot->canvas());
-    m_picker->setTrackerMode(QwtPicker::AlwaysOff);
-    m_picker->setStateMachine(new QwtPickerClickPointMachine);
-    m_picker->setRubberBand(QwtPicker::CrossRubberBand);
+    // Start with the raster canvas and its picker
+    setCanvas(false);
+
+#if QWT_VERSION < 0x060200
+    m_propertiesUI->openGLCheckBox->setEnabled(false);
+#endif
 
     // Configure the clicked point
     QwtSymbol* markerSymbol = new QwtSymbol;
@@ -93,6 +117,8 @@ GraphPage::GraphPage(QWidget* parent) :
         this, SLOT(graphAttributesChanged()));
     connect(m_propertiesUI->viewSpinBox, SIGNAL(valueChanged(int)),
         this, SLOT(graphAttributesChanged()));
+    connect(m_propertiesUI->historySpinBox, SIGNAL(valueChanged(int)),
+        this, SLOT(graphAttributesChanged()));
     connect(m_propertiesUI->minYSpinBox, SIGNAL(valueChanged(double)),
         this, SLOT(graphAttributesChanged()));
     connect(m_propertiesUI->maxYSpinBox, SIGNAL(valueChanged(double)),
@@ -105,8 +131,10 @@ GraphPage::GraphPage(QWidget* parent) :
         this, SLOT(graphAttributesChanged()));
     connect(m_propertiesUI->customXValueCombo, SIGNAL(currentIndexChanged(int)),
         this, SLOT(graphAttributesChanged()));
-    connect(m_picker, SIGNAL(appended(const QPoint&)),
-        this, SLOT(pointClicked(const QPoint&)));
+    connect(m_propertiesUI->openGLCheckBox, SIGNAL(clicked()),
+        this, SLOT(graphAttributesChanged()));
+    connect(legend, SIGNAL(checked(const QVariant&, bool, int)),
+        this, SLOT(legendChecked(const QVariant&, bool)));
 
 } // End GraphPage::GraphPage
 
@@ -131,6 +159,12 @@ GraphPage::~GraphPage()
         delete plot;
     }
 
+    while (!m_plotGroups.isEmpty())
+    {
+        delete m_plotGroups.back();
+        m_plotGroups.pop_back();
+    }
+
     // Deleting the qwtPlot object causes a crash in Windows. Don't delete it
     // and live with a small nonrecurring memory leak.
     qwtPlot->detachItems(0, false);
@@ -156,7 +190,6 @@ void GraphPage::addVariable(const QString& topicName,
     }
 
     PlotData* newCurve = new PlotData;
-    double currentValue;
 
     variableCombo->addItem(variableName);
     m_propertiesUI->customXValueCombo->addItem(variableName);
@@ -177,18 +210,33 @@ void GraphPage::addVariable(const QString& topicName,
     newCurve->curve = new QwtPlotCurve(topicName + "." + variableName);
     newCurve->curve->attach(qwtPlot);
     newCurve->curve->setRenderHint(QwtPlotItem::RenderAntialiased);
+    PlotGroup* group = getGroup(topicName);
+    if (!group)
+    {
+        group = new PlotGroup(topicName, m_propertiesUI->historySpinBox->value());
+        m_plotGroups.append(group);
+    }
 
-    // Fill the data array with the initial value
-    currentValue = CommonData::readValue(
-        newCurve->topicName, newCurve->variableName).toDouble();
+    newCurve->series = new PlotSeries(group->timeline);
+    newCurve->curve->setData(newCurve->series);
 
-    for (int i = 0; i < MAX_HISTORY; i++)
+    // The new series must line up with the shared timeline, so the whole
+    // group is refilled from the newest stored samples on the next refresh
+    group->plots.append(newCurve);
+    group->accessors.append(nullptr);
+    group->clear();
+    group->cursor = 0;
+
+    for (int i = 0; i < group->plots.count(); i++)
     {
-        newCurve->xData[i] = m_xCounter;
-        newCurve->yData[i] = currentValue;
+        if (group->plots.at(i)->isAxisData == true)
+        {
+            m_xAxis->clearLabels();
+        }
     }
 
     m_plotData.append(newCurve);
+    m_replotPending = true;
 
 } // End GraphPage::addVariable
 
@@ -201,9 +249,17 @@ void GraphPage::graphAttributesChanged()
     const QString customAxis = m_propertiesUI->customXValueCombo->currentText();
     const PlotData* const axisPlot = getPlot(customAxis);
     const bool customXEnabled = m_propertiesUI->customXCheckBox->isChecked();
+    const int history = m_propertiesUI->historySpinBox->value();
     PlotData* plot = NULL;
 
 
+    // Switch the canvas if the drawing mode changed
+    if (m_propertiesUI->openGLCheckBox->isChecked() != m_openGL)
+    {
+        setCanvas(m_propertiesUI->openGLCheckBox->isChecked());
+    }
+
+
     //--------------------------------------------------------------------------
     // Enable a custom y scale if it was selected
     if (m_propertiesUI->customYCheckBox->isChecked())
@@ -237,6 +293,7 @@ void GraphPage::graphAttributesChanged()
             (plot->isAxisData == true && customXEnabled == false))
         {
             plot->isAxisData = false;
+            plot->curve->setVisible(true);
             plot->curve->attach(qwtPlot);
         }
 
@@ -248,7 +305,27 @@ void GraphPage::graphAttributesChanged()
         }
     }
 
+    // Resize the shared timelines first, then their series
+    for (int i = 0; i < m_plotGroups.count(); i++)
+    {
+        PlotGroup* group = m_plotGroups.at(i);
+        group->timeline->setCapacity(history);
+        for (int j = 0; j < group->plots.count(); j++)
+        {
+            group->plots.at(j)->series->updateCapacity();
+        }
+    }
+
+
+    // Rebuild the x-axis labels from the history of the axis plot
+    m_xAxis->m_maxLabels = history;
+    m_xAxis->clearLabels();
+    if (customXEnabled == true && axisPlot != NULL)
+    {
+        addAxisLabels(axisPlot, (int)axisPlot->series->count());
+    }
 
+    m_replotPending = true;
     updateGraph();
     m_refreshTimer.setInterval(refreshRate);
 
@@ -278,171 +355,118 @@ void GraphPage::updateGraph()
         return;
     }
 
-    const int viewSize = m_propertiesUI->viewSpinBox->value();
     PlotData* plot = NULL;
-    m_xCounter += 1.0;
+    bool redraw = m_replotPending;
+    m_replotPending = false;
 
 
-    // Shift the x data back one array position
-    if (m_xData[0] < m_xCounter)
+    //--------------------------------------------------------------------------
+    // Pull in every sample since the last frame, one pass per topic
+    for (int i = 0; i < m_plotGroups.count(); i++)
     {
-        for (int c = MAX_HISTORY - 1; c > 0; c--)
+        PlotGroup* group = m_plotGroups.at(i);
+        const int added = group->pullSamples();
+        if (added <= 0)
         {
-            m_xData[c] = m_xData[c - 1];
+            continue;
         }
-        m_xData[0] = m_xCounter;
-    }
 
+        // If this data has been marked as a custom x-axis, label the x-axis
+        // with its values
+        for (int j = 0; j < group->plots.count(); j++)
+        {
+            if (group->plots.at(j)->isAxisData == true)
+            {
+                addAxisLabels(group->plots.at(j), added);
+            }
+        }
 
-    //--------------------------------------------------------------------------
-    // Setup the plot xaxis view
-    // Stretch the data to fit the view if the number of ticks is less than
-    // the view.
-    if (m_xCounter < viewSize)
-    {
-        m_xMin = m_xData[MAX_HISTORY - 1];
-        m_xMax = m_xData[MAX_HISTORY - (int)m_xCounter - 1];
+        redraw = true;
     }
 
-    // If we're at the far right of the plot, show the latest data
-    else if (m_xMax + 1.0 == m_xCounter)
+    // Nothing changed since the last frame, so skip the redraw
+    if (!redraw)
     {
-        m_xMin = m_xCounter - viewSize + 1.0;
-        m_xMax = m_xCounter;
+        return;
     }
 
-    // If we're at the end of the history and are scrolled to the far right,
-    // shift the min/max up
-    else if (m_xMin <= m_xData[MAX_HISTORY - 1] &&
-        m_xData[MAX_HISTORY - 1] != 0.0)
-    {
-        m_xMin = m_xData[MAX_HISTORY - 1];
-        m_xMax = m_xData[MAX_HISTORY - viewSize];
-    }
 
-    // If we are panned left or right, hold the position
-    else if (m_xMax + 1.5 < m_xCounter)
+    //--------------------------------------------------------------------------
+    // Setup the plot xaxis view
+    double oldest = 0.0;
+    double newest = 0.0;
+    if (dataRange(oldest, newest))
     {
-        m_xMin = m_xMax - viewSize + 1.0;
-    }
+        const double span = viewSpan();
 
-    // It should never get here, but if it does, just show the latest data.
-    else
-    {
-        m_xMin = m_xCounter - viewSize + 1.0;
-        m_xMax = m_xCounter;
-    }
+        // Show the latest data unless we are panned left
+        if (m_followLatest)
+        {
+            m_xMax = newest;
+            m_xMin = newest - span;
+        }
 
+        // Hold the panned position until it falls out of the history
+        else if (m_xMin < oldest)
+        {
+            m_xMin = oldest;
+            m_xMax = oldest + span;
+        }
 
-    // Update the x-axis label. If a custom x axis is enabled, the label will
-    // be set in the variable loop below.
-    if (m_propertiesUI->customXCheckBox->isChecked() == false)
-    {
-        m_xAxis->addLabel(m_xCounter, QTime::currentTime().toString());
+        qwtPlot->setAxisScale(QwtPlot::xBottom, m_xMin, m_xMax);
     }
 
 
     //--------------------------------------------------------------------------
-    // Loop through each variable and attach the latest data
+    // Loop through each variable and point its curve at the view
     for (int i = 0; i < m_plotData.count(); i++)
     {
-        int arrayStart = 0;
         plot = m_plotData.at(i);
-        if (!plot)
-        {
-            continue;
-        }
-
-        // If the latest data isn't valid, skip it
-        QVariant latestValue = CommonData::readValue(
-            plot->topicName, plot->variableName);
-        if (!latestValue.isValid())
+        if (!plot || plot->isAxisData == true)
         {
             continue;
         }
 
-        // Shift the data back one position
-        for (int c = MAX_HISTORY - 1; c > 0; c--)
-        {
-            plot->xData[c] = plot->xData[c - 1];
-            plot->yData[c] = plot->yData[c - 1];
-        }
-
-
-        // Get the starting axis array element
-        for (int c = 0; c < MAX_HISTORY; c++)
-        {
-            if (plot->xData[c] == m_xMax)
-            {
-                arrayStart = c;
-                break;
-            }
-        }
-
-        // Store the latest value
-        plot->xData[0] = m_xCounter;
-        plot->yData[0] = latestValue.toDouble();
-
-
-        // Apply the bias and populate the view arrays
-        for (int c = 0; c < viewSize; c++)
-        {
-            plot->xViewData[c] = plot->xData[c + arrayStart];
-            plot->yViewData[c] = plot->yData[c + arrayStart] *
-                plot->biasScale +
-                plot->biasShift;
-        }
-
-
-        // If this data has been marked as a custom x-axis, set the x-axis
-        // label to the value
-        if (plot->isAxisData == true)
-        {
-            const double axisValue = plot->yData[0];
-
-            // If the value is a normalized time, show it as a time
-            if (m_propertiesUI->customXTimeCheckBox->isChecked() == true)
-            {
-                QTime timeValue(0, 0, 0, 0);
-                timeValue = timeValue.addSecs((int)axisValue);
-                m_xAxis->addLabel(m_xCounter, timeValue.toString());
-            }
-            else
-            {
-                m_xAxis->addLabel(m_xCounter, QString::number(axisValue));
-            }
-
-            continue;
-        }
+        // The curve reads the view straight from the history, at a level
+        // of detail matching the canvas width. This is the one view update
+        // per frame, after every sample of the frame was appended.
+        plot->series->setBias(plot->biasScale, plot->biasShift);
+        plot->series->setResolution(qwtPlot->canvas()->width());
+        plot->series->setView(m_xMin, m_xMax);
 
 
         // Set the color of the line based on the plot index
-        switch (i)
+        plot->color = plotColor(i);
+
+        QString newTitle = plot->topicName + "." + plot->variableName;
+        if (plot->series->count() > 0)
         {
-            case 0: plot->color.setRgb(0, 0, 255, 255); break; // Blue
-            case 1: plot->color.setRgb(255, 0, 0, 255); break; // Red
-            case 2: plot->color.setRgb(0, 200, 0, 255); break; // Green
-            case 3: plot->color.setRgb(0, 0, 0, 255); break; // Black
-            case 4: plot->color.setRgb(255, 155, 0, 255); break; // Orange
-            case 5: plot->color.setRgb(255, 0, 255, 255); break; // Purple
-            default: plot->color.setRgb(0, 0, 0, 255); break; // Black
+            newTitle += " [" + QString::number(plot->series->y(0)) + "]";
         }
 
-        const QString newTitle =
-            plot->topicName + "." + plot->variableName +
-            " [" + latestValue.toString() + "]";
-
         plot->curve->setTitle(newTitle);
         plot->curve->setPen(plot->color);
-        plot->curve->setSamples(plot->xViewData,
-            plot->yViewData,
-            viewSize);
 
     } // End plot line loop
 
-    qwtPlot->setAxisScale(QwtPlot::xBottom, m_xMin, m_xMax);
+
+    // Measure the redraw. The canvas paints immediately on replot.
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+
     qwtPlot->replot();
 
+    const double frameTime = frameTimer.nsecsElapsed() / 1.0e6;
+    m_frameTime = (m_frameTime > 0.0) ?
+        0.9 * m_frameTime + 0.1 * frameTime :
+        frameTime;
+
+    if (m_propertiesDialog->isVisible())
+    {
+        m_propertiesUI->frameTimeValueLabel->setText(
+            QString::number(m_frameTime, 'f', 2) + " ms");
+    }
+
 } // End GraphPage::updateGraph
 
 
@@ -493,107 +517,78 @@ void GraphPage::on_playPauseButton_clicked()
 //------------------------------------------------------------------------------
 void GraphPage::on_rewindButton_clicked()
 {
-    const int viewSize = m_propertiesUI->viewSpinBox->value();
-
-    // Make sure we can pan to the left without going past 0
-    if (m_xMin - viewSize / 3 > m_xData[MAX_HISTORY - 1])
+    double oldest = 0.0;
+    double newest = 0.0;
+    if (!dataRange(oldest, newest))
     {
-        m_xMin -= viewSize / 3;
-        m_xMax -= viewSize / 3;
-    }
-    else
-    {
-        m_xMin = m_xData[MAX_HISTORY - 1];
-        m_xMax = m_xData[MAX_HISTORY - viewSize];
+        return;
     }
 
-    qwtPlot->replot();
+    const double span = viewSpan();
+
+    // Make sure we can pan to the left without going past the oldest data
+    m_followLatest = false;
+    m_xMin = std::max(m_xMin - span / 3, oldest);
+    m_xMax = m_xMin + span;
+
+    m_replotPending = true;
+    updateGraph();
 }
 
 
 //------------------------------------------------------------------------------
 void GraphPage::on_forwardButton_clicked()
 {
-    const int viewSize = m_propertiesUI->viewSpinBox->value();
-
-    // Make sure we can pan to the right without going past the max
-    if (m_xMax + viewSize / 3 < m_xData[0])
+    double oldest = 0.0;
+    double newest = 0.0;
+    if (!dataRange(oldest, newest))
     {
-        m_xMin += viewSize / 3;
-        m_xMax += viewSize / 3;
-    }
-    else
-    {
-        m_xMin = m_xData[viewSize];
-        m_xMax = m_xData[0];
+        return;
     }
 
-    qwtPlot->replot();
+    const double span = viewSpan();
+
+    // Follow the latest data again once we pan past it
+    m_xMax += span / 3;
+    m_xMin = m_xMax - span;
+    m_followLatest = m_xMax >= newest;
+
+    m_replotPending = true;
+    updateGraph();
 }
 
 
 //------------------------------------------------------------------------------
 void GraphPage::on_frontButton_clicked()
 {
-    m_xMin = m_xData[m_propertiesUI->viewSpinBox->value()];
-    m_xMax = m_xData[0];
+    m_followLatest = true;
 
-    qwtPlot->replot();
+    m_replotPending = true;
+    updateGraph();
 }
 
 
 //------------------------------------------------------------------------------
 void GraphPage::on_refreshButton_clicked()
 {
-    PlotData* plot = NULL;
-    double currentValue;
-
-    // Setup the initial x-axis data values;
-    for (int i = 0; i < MAX_HISTORY; i++)
-    {
-        m_xData[i] = MAX_HISTORY - i - 1;
-    }
-
-    m_xCounter = 0.0;
-    m_xMin = m_xData[MAX_HISTORY - 1];
-    m_xMax = m_xData[MAX_HISTORY - m_propertiesUI->viewSpinBox->value()];
+    m_followLatest = true;
     m_marker->detach();
 
     // Clear out the label history
-    while (m_xAxis != NULL && !m_xAxis->m_xLabels.isEmpty())
+    if (m_xAxis != NULL)
     {
-        delete m_xAxis->m_xLabels.back();
-        m_xAxis->m_xLabels.pop_back();
+        m_xAxis->clearLabels();
     }
 
 
-    // Reset the data for each of the plots
-    for (int i = 0; i < m_plotData.count(); i++)
+    // Reset the data for each of the plots. The cursors are kept, so only
+    // samples arriving from now on are plotted.
+    for (int i = 0; i < m_plotGroups.count(); i++)
     {
-        plot = m_plotData.at(i);
-        if (plot == NULL)
-        {
-            continue;
-        }
-
-        // Flush all the data back to 0
-        memset(plot->xData, 0, sizeof(plot->xData));
-        memset(plot->yData, 0, sizeof(plot->yData));
-        memset(plot->xViewData, 0, sizeof(plot->xViewData));
-        memset(plot->yViewData, 0, sizeof(plot->yViewData));
-
-        // Fill the data array with the current value
-        currentValue = CommonData::readValue(
-            plot->topicName, plot->variableName).toDouble();
-
-        for (int j = 0; j < MAX_HISTORY; j++)
-        {
-            plot->xData[j] = m_xCounter;
-            plot->yData[j] = currentValue;
-        }
-
-    } // End plot loop
+        m_plotGroups.at(i)->clear();
+    }
 
+    m_replotPending = true;
     updateGraph();
 
 } // End GraphPage::on_refreshButton_clicked
@@ -621,6 +616,7 @@ void GraphPage::on_scaleButton_clicked()
     if (ok)
     {
         plotData->biasScale = value;
+        m_replotPending = true;
         updateGraph();
     }
 
@@ -649,6 +645,7 @@ void GraphPage::on_shiftButton_clicked()
     if (ok)
     {
         plotData->biasShift = value;
+        m_replotPending = true;
         updateGraph();
     }
 
@@ -720,9 +717,25 @@ void GraphPage::on_trashButton_clicked()
             continue;
         }
 
+        // Pull the plot out of its topic group, and drop the group once empty
+        PlotGroup* group = getGroup(plot->topicName);
+        if (group)
+        {
+            const int groupIndex = group->plots.indexOf(plot);
+            group->plots.removeAt(groupIndex);
+            group->accessors.remove(groupIndex);
+
+            if (group->plots.isEmpty())
+            {
+                m_plotGroups.removeOne(group);
+                delete group;
+            }
+        }
+
         m_plotData.removeAt(i);
         plot->curve->detach();
         delete plot;
+        m_replotPending = true;
 
         plot = NULL;
         break;
@@ -806,9 +819,156 @@ GraphPage::PlotData* GraphPage::getPlot(const QString& variableName)
 }
 
 
+//------------------------------------------------------------------------------
+GraphPage::PlotGroup* GraphPage::getGroup(const QString& topicName)
+{
+    for (int i = 0; i < m_plotGroups.count(); i++)
+    {
+        if (m_plotGroups.at(i)->topicName == topicName)
+        {
+            return m_plotGroups.at(i);
+        }
+    }
+
+    return NULL;
+}
+
+
+//------------------------------------------------------------------------------
+void GraphPage::legendChecked(const QVariant& itemInfo, bool on)
+{
+    QwtPlotItem* item = qwtPlot->infoToItem(itemInfo);
+    if (item == NULL)
+    {
+        return;
+    }
+
+    item->setVisible(!on);
+
+    m_replotPending = true;
+    updateGraph();
+}
+
+
+//------------------------------------------------------------------------------
+void GraphPage::setCanvas(bool openGL)
+{
+    QWidget* canvas = NULL;
+
+#if QWT_VERSION >= 0x060200
+    if (openGL)
+    {
+        QwtPlotOpenGLCanvas* glCanvas = new QwtPlotOpenGLCanvas();
+        glCanvas->setPaintAttribute(QwtPlotAbstractGLCanvas::ImmediatePaint, true);
+        canvas = glCanvas;
+    }
+#endif
+
+    if (canvas == NULL)
+    {
+        QwtPlotCanvas* rasterCanvas = new QwtPlotCanvas();
+        rasterCanvas->setPaintAttribute(QwtPlotCanvas::ImmediatePaint, true);
+        canvas = rasterCanvas;
+        openGL = false;
+    }
+
+    // The plot deletes the old canvas along with the picker on it
+    qwtPlot->setCanvas(canvas);
+    qwtPlot->setCanvasBackground(QColor(255, 255, 255, 255));
+    m_openGL = openGL;
+    m_frameTime = 0.0;
+
+    // Configure the picker
+    m_picker = new QwtPicker(qwtPlot->canvas());
+    m_picker->setTrackerMode(QwtPicker::AlwaysOff);
+    m_picker->setStateMachine(new QwtPickerClickPointMachine);
+    m_picker->setRubberBand(QwtPicker::CrossRubberBand);
+
+    connect(m_picker, SIGNAL(appended(const QPoint&)),
+        this, SLOT(pointClicked(const QPoint&)));
+
+    m_replotPending = true;
+}
+
+
+//------------------------------------------------------------------------------
+void GraphPage::addAxisLabels(const PlotData* plot, int count)
+{
+    // Oldest first, so the label history stays in time order
+    const int available = (int)plot->series->count();
+    for (int c = std::min(count, available) - 1; c >= 0; c--)
+    {
+        const double axisValue = plot->series->y(c);
+
+        // If the value is a normalized time, show it as a time
+        if (m_propertiesUI->customXTimeCheckBox->isChecked() == true)
+        {
+            QTime timeValue(0, 0, 0, 0);
+            timeValue = timeValue.addSecs((int)axisValue);
+            m_xAxis->addLabel(plot->series->x(c), timeValue.toString());
+        }
+        else
+        {
+            m_xAxis->addLabel(plot->series->x(c), QString::number(axisValue));
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool GraphPage::dataRange(double& oldest, double& newest) const
+{
+    bool found = false;
+
+    for (int i = 0; i < m_plotData.count(); i++)
+    {
+        const PlotData* plot = m_plotData.at(i);
+        if (!plot || plot->series->count() == 0)
+        {
+            continue;
+        }
+
+        const double plotNewest = plot->series->x(0);
+        const double plotOldest = plot->series->x(plot->series->count() - 1);
+        oldest = found ? std::min(oldest, plotOldest) : plotOldest;
+        newest = found ? std::max(newest, plotNewest) : plotNewest;
+        found = true;
+    }
+
+    return found;
+}
+
+
+//------------------------------------------------------------------------------
+double GraphPage::viewSpan() const
+{
+    const int viewSize = m_propertiesUI->viewSpinBox->value();
+    double span = 0.0;
+
+    // Use the widest plot, so the view holds viewSize points of every plot.
+    // The data is stretched to fit the view while fewer points are available.
+    for (int i = 0; i < m_plotData.count(); i++)
+    {
+        const PlotData* plot = m_plotData.at(i);
+        if (!plot || plot->isAxisData == true || plot->series->count() < 2)
+        {
+            continue;
+        }
+
+        const size_t last = std::min((size_t)viewSize, plot->series->count()) - 1;
+        span = std::max(span, plot->series->x(0) - plot->series->x(last));
+    }
+
+    // A single point or identical timestamps still need a visible axis
+    return span > 0.0 ? span : 1.0;
+}
+
+
 //------------------------------------------------------------------------------
 GraphPage::TimeScaleDraw::~TimeScaleDraw()
-{}
+{
+    clearLabels();
+}
 
 
 //------------------------------------------------------------------------------
@@ -816,7 +976,7 @@ void GraphPage::TimeScaleDraw::addLabel(const double& value,
                                         const QString& label)
 {
     // Make sure we don't have too many x-labels
-    while (m_xLabels.count() > MAX_HISTORY)
+    while (m_xLabels.count() > m_maxLabels)
     {
         delete m_xLabels.front();
         m_xLabels.pop_front();
@@ -831,17 +991,37 @@ void GraphPage::TimeScaleDraw::addLabel(const double& value,
 }
 
 
+//------------------------------------------------------------------------------
+void GraphPage::TimeScaleDraw::clearLabels()
+{
+    while (!m_xLabels.isEmpty())
+    {
+        delete m_xLabels.back();
+        m_xLabels.pop_back();
+    }
+}
+
+
 //------------------------------------------------------------------------------
 QwtText GraphPage::TimeScaleDraw::label(double value) const
 {
-    for (int i = 0; i < m_xLabels.count(); i++)
+    // Without a custom x-axis, the value is a source timestamp in seconds
+    if (m_xLabels.isEmpty())
+    {
+        const QDateTime time =
+            QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(value * 1000.0));
+        return QwtText(time.toString("hh:mm:ss.zzz"));
+    }
+
+    // Show the custom label that was current at this time
+    for (int i = m_xLabels.count() - 1; i >= 0; i--)
     {
         if (!m_xLabels.at(i))
         {
             continue;
         }
 
-        if (m_xLabels.at(i)->first == value)
+        if (m_xLabels.at(i)->first <= value)
         {
             return m_xLabels.at(i)->second;
         }
@@ -859,11 +1039,7 @@ GraphPage::PlotData::PlotData()
     biasScale = 1.0;
     biasShift = 0.0;
     curve = NULL;
-
-    memset(xData, 0, sizeof(xData));
-    memset(yData, 0, sizeof(yData));
-    memset(xViewData, 0, sizeof(xViewData));
-    memset(yViewData, 0, sizeof(yViewData));
+    series = NULL;
 
     isAxisData = false;
 }
@@ -872,7 +1048,78 @@ GraphPage::PlotData::PlotData()
 //------------------------------------------------------------------------------
 GraphPage::PlotData::~PlotData()
 {
+    // The curve owns the series
+    delete curve;
     curve = NULL;
+    series = NULL;
+}
+
+
+//------------------------------------------------------------------------------
+GraphPage::PlotGroup::PlotGroup(const QString& topic, size_t capacity) :
+    topicName(topic),
+    timeline(std::make_shared<PlotTimeline>(capacity)),
+    cursor(0),
+    columns(new SampleColumns)
+{}
+
+
+//------------------------------------------------------------------------------
+GraphPage::PlotGroup::~PlotGroup()
+{}
+
+
+//------------------------------------------------------------------------------
+int GraphPage::PlotGroup::pullSamples()
+{
+    // The topic may not be known yet when the variables are added
+    for (int i = 0; i < accessors.count(); i++)
+    {
+        if (!accessors.at(i))
+        {
+            accessors[i] = CommonData::compileMember(topicName, plots.at(i)->variableName);
+            if (!accessors.at(i))
+            {
+                return 0;
+            }
+        }
+    }
+
+    // Decode each new sample once for all plots. Only the newest ones fit,
+    // so a reset cursor reads the tail of the history, not all of it.
+    const int added = CommonData::readColumnsSince(topicName,
+                                                   accessors,
+                                                   cursor,
+                                                   *columns,
+                                                   ColumnFormat::Double,
+                                                   timeline->capacity());
+    if (added <= 0)
+    {
+        return 0;
+    }
+
+    // The new samples arrive oldest first
+    for (int row = 0; row < added; row++)
+    {
+        timeline->append(columns->sourceTimes[row] / 1.0e9);
+        for (int i = 0; i < plots.count(); i++)
+        {
+            plots.at(i)->series->append(columns->values[i][row]);
+        }
+    }
+
+    return added;
+}
+
+
+//------------------------------------------------------------------------------
+void GraphPage::PlotGroup::clear()
+{
+    timeline->clear();
+    for (int i = 0; i < plots.count(); i++)
+    {
+        plots.at(i)->series->clear();
+    }
 }
 
 
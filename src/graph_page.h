@@ -12,16 +12,20 @@
 #include <QInputDialog>
 #include <QFileDialog>
 #include <QDataStream>
+#include <QDateTime>
 #include <QDropEvent>
+#include <QElapsedTimer>
 #include <QByteArray>
 #include <QPrinter>
 #include <QString>
 #include <QPixmap>
 #include <QWidget>
 #include <QColor>
+#include <QVariant>
 #include <QTimer>
 #include <QPoint>
 #include <QTime>
+#include <QVector>
 #include <QList>
 #include <QIcon>
 #include <QPair>
@@ -45,12 +49,22 @@
 #include <qwt_symbol.h>
 #include <qwt_picker.h>
 #include <qwt_plot.h>
+#if QWT_VERSION >= 0x060200
+#include <qwt_plot_opengl_canvas.h>
+#endif
 #ifdef __GNUG__
 #pragma GCC diagnostic pop
 #endif
 
 #include "ui_graph_page.h"
 #include "ui_graph_properties.h"
+#include "plot_series.h"
+
+#include <cstdint>
+#include <memory>
+
+class MemberAccessor;
+struct SampleColumns;
 
 
 //------------------------------------------------------------------------------
@@ -96,10 +110,19 @@ private slots:
     void graphAttributesChanged();
 
     /**
-     * @brief Plot in the latest value for each variable.
+     * @brief Plot every sample that arrived since the last refresh.
+     * @details Runs once per frame on m_refreshTimer. The plot is only redrawn
+     *          when new samples arrived or a redraw was requested.
      */
     void updateGraph();
 
+    /**
+     * @brief Hide or show the curve of a clicked legend entry.
+     * @param[in] itemInfo Identifies the plot item of the legend entry.
+     * @param[in] on True if the entry is checked, which hides the curve.
+     */
+    void legendChecked(const QVariant& itemInfo, bool on);
+
     /**
      * @brief Display the marker on the clicked point for the selected variable.
      * @param[in] point Display the marker at this clicked point.
@@ -185,12 +208,6 @@ signals:
 
 private:
 
-    /// The maximum number of data points for a variable.
-    static const int MAX_HISTORY = 4096;
-
-    /// The maximum number of variable lines to plot.
-    static const int MAX_LINES = 6;
-
     /**
      * @brief Axis class that GraphPage uses to display the custom labels
      *        along the xaxis.
@@ -200,7 +217,7 @@ private:
     public:
 
         ///  Contructor for the custom x-axis object.
-        TimeScaleDraw() {}
+        TimeScaleDraw() : m_maxLabels(0) {}
 
         ///  Destructor for the custom x-axis object.
         ~TimeScaleDraw();
@@ -212,8 +229,16 @@ private:
          */
         void addLabel(const double& value, const QString& label);
 
+        /**
+         * @brief Delete all custom labels.
+         */
+        void clearLabels();
+
         /**
          * @brief Return the label string for the passed in value.
+         * @details Without custom labels, the value is shown as the time of
+         *          day. Otherwise the latest label at or before the value is
+         *          shown.
          * @remarks Reimplemented from QwtAbstractScaleDraw.
          * @param[in] value Return the label for with this value.
          * @return The label string for the passed in value.
@@ -221,11 +246,14 @@ private:
         QwtText label(double value) const;
 
         /**
-         * @brief Stores the xaxis label history.
-         * @remarks The array size has a limit of GraphPage::MAX_HISTORY
+         * @brief Stores the custom xaxis label history, oldest first.
+         * @remarks The array size has a limit of m_maxLabels
          */
         QList<QPair<double, QString> *> m_xLabels;
 
+        /// The maximum number of labels kept. Matches the plot history.
+        int m_maxLabels;
+
     }; // End TimeScaleDraw
 
 
@@ -258,20 +286,63 @@ private:
         /// The y-axis shift value.
         double biasShift;
 
-        /// The x-axis history.
-        double xData[MAX_HISTORY];
+        /// The point history. Owned by curve.
+        PlotSeries* series;
 
-        /// The y-axis history.
-        double yData[MAX_HISTORY];
+        /// Flag set to true when this data is used as the x-axis.
+        bool isAxisData;
+    };
 
-        /// The x-axis data array that's displayed on the plot.
-        double xViewData[MAX_HISTORY];
 
-        /// The y-axis data array with the bias applied.
-        double yViewData[MAX_HISTORY];
+    /**
+     * @brief The plots of one topic.
+     * @details The plots share one timeline and are filled together, from a
+     *          single pass over the new samples of the topic per refresh.
+     */
+    class PlotGroup
+    {
+    public:
 
-        /// Flag set to true when this data is used as the x-axis.
-        bool isAxisData;
+        /**
+         * @brief Constructor for the plot group.
+         * @param[in] topic The DDS topic name.
+         * @param[in] capacity The maximum number of points to keep.
+         */
+        PlotGroup(const QString& topic, size_t capacity);
+
+        ///  Destructor for the plot group.
+        ~PlotGroup();
+
+        /**
+         * @brief Append every sample stored since the last call to all plots.
+         * @details The member paths are resolved here when the topic wasn't
+         *          known yet at the time the variables were added.
+         * @return The number of points added to each plot.
+         */
+        int pullSamples();
+
+        /**
+         * @brief Delete the points of every plot.
+         */
+        void clear();
+
+        /// The DDS topic name.
+        QString topicName;
+
+        /// The x values of the plots, in seconds since the Unix epoch.
+        std::shared_ptr<PlotTimeline> timeline;
+
+        /// The plots of this topic.
+        QList<PlotData*> plots;
+
+        /// The resolved member path of each plot, in the order of plots.
+        QVector<std::shared_ptr<const MemberAccessor>> accessors;
+
+        /// The sequence of the newest sample already plotted.
+        uint64_t cursor;
+
+        /// Receives the new samples. Reused between reads.
+        std::unique_ptr<SampleColumns> columns;
     };
 
 
@@ -282,6 +353,43 @@ private:
      */
     PlotData* getPlot(const QString& variableName);
 
+    /**
+     * @brief Return the plot group of a topic.
+     * @param[in] topicName The DDS topic name.
+     * @return A pointer to the group or NULL if not found.
+     */
+    PlotGroup* getGroup(const QString& topicName);
+
+    /**
+     * @brief Replace the plot canvas and attach a new picker to it.
+     * @details The OpenGL canvas requires Qwt 6.2 or later. Both canvases
+     *          paint immediately on replot, so the frame time covers the
+     *          whole redraw.
+     * @param[in] openGL True for an OpenGL canvas; false for a raster canvas.
+     */
+    void setCanvas(bool openGL);
+
+    /**
+     * @brief Add the x-axis labels for the newest points of the axis plot.
+     * @param[in] plot The plot used as the x-axis.
+     * @param[in] count The number of newest points to label.
+     */
+    void addAxisLabels(const PlotData* plot, int count);
+
+    /**
+     * @brief Get the oldest and newest x values of all plots.
+     * @param[out] oldest The oldest x value.
+     * @param[out] newest The newest x value.
+     * @return True if any plot holds data; false otherwise.
+     */
+    bool dataRange(double& oldest, double& newest) const;
+
+    /**
+     * @brief Get the x-axis width that shows the configured number of points.
+     * @return The width in seconds.
+     */
+    double viewSpan() const;
+
     /// The graph properties dialog that controls the refresh rate and axis.
     QDialog* m_propertiesDialog;
 
@@ -300,14 +408,23 @@ private:
     /// Stores the data for the plots.
     QList<PlotData*> m_plotData;
 
+    /// The plots grouped by topic.
+    QList<PlotGroup*> m_plotGroups;
+
     /// Redraw the graph when this timer expires.
     QTimer m_refreshTimer;
 
-    /// Stores the x-axis data.
-    double m_xData[MAX_HISTORY];
+    /// True while the view follows the newest data; false while panned.
+    bool m_followLatest;
+
+    /// True if the next refresh must redraw even without new samples.
+    bool m_replotPending;
+
+    /// True while the plot draws on an OpenGL canvas.
+    bool m_openGL;
 
-    /// Counts the number of times the plot has been drawn. Used for x-axis.
-    double m_xCounter;
+    /// The smoothed time spent redrawing the plot, in milliseconds.
+    double m_frameTime;
 
     /// Stores the lowest x value to display on the x-axis.
     double m_xMin;
@@ -0,0 +1,202 @@
+#include "history_table_model.h"
+#include "dds_data.h"
+
+#include <dds/DCPS/GuidConverter.h>
+
+#include <vector>
+
+
+//------------------------------------------------------------------------------
+HistoryTableModel::HistoryTableModel(const QString& topicName, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_store(CommonData::getSampleStore(topicName))
+{
+    m_columnHeaders
+        << "Source Time"
+        << "Reception Time"
+        << "Writer"
+        << "Size";
+}
+
+
+//------------------------------------------------------------------------------
+HistoryTableModel::~HistoryTableModel()
+{}
+
+
+//------------------------------------------------------------------------------
+bool HistoryTableModel::refresh()
+{
+    // Evicted samples are the oldest, so their rows are at the bottom. A
+    // flushed store only holds samples newer than every row.
+    uint64_t oldest = 0;
+    const bool hasSamples = m_store->oldestSequence(oldest);
+    size_t keep = m_rows.size();
+    while (keep > 0 && (!hasSamples || m_rows[keep - 1].sequence < oldest))
+    {
+        --keep;
+    }
+
+    if (keep < m_rows.size())
+    {
+        beginRemoveRows(QModelIndex(), static_cast<int>(keep), static_cast<int>(m_rows.size()) - 1);
+        m_rows.erase(m_rows.begin() + keep, m_rows.end());
+        endRemoveRows();
+    }
+
+    // Only the new slots are copied
+    const uint64_t newest = m_rows.empty() ? 0 : m_rows.front().sequence;
+    const std::vector<TopicSample> added = m_store->copySlotsSince(newest);
+    if (added.empty())
+    {
+        return false;
+    }
+
+    beginInsertRows(QModelIndex(), 0, static_cast<int>(added.size()) - 1);
+    for (const TopicSample& slot : added)
+    {
+        m_rows.push_front(HistoryRow{slot.sourceTime,
+                                     slot.receptionTime,
+                                     slot.writer,
+                                     slot.bytes,
+                                     slot.sequence});
+    }
+    endInsertRows();
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t HistoryTableModel::sequence(int row) const
+{
+    if (row < 0 || row >= static_cast<int>(m_rows.size()))
+    {
+        return 0;
+    }
+    return m_rows[row].sequence;
+}
+
+
+//------------------------------------------------------------------------------
+int HistoryTableModel::rowOf(uint64_t sequence) const
+{
+    // Sequences decrease with the row
+    size_t low = 0;
+    size_t high = m_rows.size();
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (m_rows[middle].sequence > sequence)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == m_rows.size() || m_rows[low].sequence != sequence)
+    {
+        return -1;
+    }
+    return static_cast<int>(low);
+}
+
+
+//------------------------------------------------------------------------------
+int HistoryTableModel::sampleIndex(int row) const
+{
+    size_t index = 0;
+    if (row < 0 ||
+        row >= static_cast<int>(m_rows.size()) ||
+        !m_store->indexOf(m_rows[row].sequence, index))
+    {
+        return -1;
+    }
+    return static_cast<int>(index);
+}
+
+
+//------------------------------------------------------------------------------
+int HistoryTableModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+    return static_cast<int>(m_rows.size());
+}
+
+
+//------------------------------------------------------------------------------
+int HistoryTableModel::columnCount(const QModelIndex&) const
+{
+    return MAX_eColumnIds_VALUE;
+}
+
+
+//------------------------------------------------------------------------------
+QVariant HistoryTableModel::data(const QModelIndex& index, int role) const
+{
+    const int row = index.row();
+    if (row < 0 || row >= static_cast<int>(m_rows.size()))
+    {
+        return QVariant();
+    }
+
+    if (role == Qt::TextAlignmentRole && index.column() == SIZE_COLUMN)
+    {
+        return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    if (role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+
+    // Only the visible cells are formatted
+    const HistoryRow& historyRow = m_rows[row];
+    switch (index.column())
+    {
+    case SOURCE_TIME_COLUMN:
+        return CommonData::formatSampleTime(historyRow.sourceTime);
+    case RECEPTION_TIME_COLUMN:
+        return CommonData::formatSampleTime(historyRow.receptionTime);
+    case WRITER_COLUMN:
+        if (historyRow.writer == OpenDDS::DCPS::GUID_UNKNOWN)
+        {
+            return QString();
+        }
+        return QString(OpenDDS::DCPS::LogGuid(historyRow.writer).c_str());
+    case SIZE_COLUMN:
+        // A size of 0 means the sample couldn't be measured
+        if (historyRow.bytes == 0)
+        {
+            return QString();
+        }
+        return static_cast<qulonglong>(historyRow.bytes);
+    default:
+        return QVariant();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+QVariant HistoryTableModel::headerData(int section,
+                                       Qt::Orientation orientation,
+                                       int role) const
+{
+    if (role == Qt::DisplayRole &&
+        orientation == Qt::Horizontal &&
+        section < m_columnHeaders.count())
+    {
+        return m_columnHeaders.at(section);
+    }
+    return QVariant();
+}
+
+
+/**
+ * @}
+ */
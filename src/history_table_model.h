@@ -0,0 +1,150 @@
+#ifndef DDS_HISTORY_TABLE_MODEL_H
+#define DDS_HISTORY_TABLE_MODEL_H
+
+#include "first_define.h"
+#include "topic_sample_store.h"
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QString>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+
+/**
+ * @brief Table model for the sample history of one topic.
+ * @details The model keeps only the metadata of each history slot and
+ *          follows the sample store incrementally: new samples are inserted
+ *          at the top and evicted samples removed at the bottom, so a refresh
+ *          costs nothing while the history doesn't change and never rebuilds
+ *          the rows that stayed. The view keeps its selection across updates.
+ */
+class HistoryTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+
+    /// Table column IDs for this data model
+    enum eColumnIds
+    {
+        SOURCE_TIME_COLUMN,
+        RECEPTION_TIME_COLUMN,
+        WRITER_COLUMN,
+        SIZE_COLUMN,
+        MAX_eColumnIds_VALUE
+    };
+
+    /**
+     * @brief Constructor for the sample history model.
+     * @param[in] topicName The name of the topic.
+     * @param[in] parent The parent for this data model.
+     */
+    HistoryTableModel(const QString& topicName, QObject* parent = 0);
+
+    /**
+     * @brief Destructor for the sample history model.
+     */
+    ~HistoryTableModel();
+
+    /**
+     * @brief Catch up with the samples stored and evicted since the last call.
+     * @return True if rows were inserted at the top; false otherwise.
+     */
+    bool refresh();
+
+    /**
+     * @brief Get the insertion order of the sample on a row.
+     * @param[in] row The table row. 0 is the newest.
+     * @return The sample sequence, or 0 if the row doesn't exist.
+     */
+    uint64_t sequence(int row) const;
+
+    /**
+     * @brief Find the row of a sample.
+     * @param[in] sequence The sample sequence.
+     * @return The table row, or -1 if the sample isn't shown.
+     */
+    int rowOf(uint64_t sequence) const;
+
+    /**
+     * @brief Get the current index of the sample on a row in the sample store.
+     * @details New samples may have arrived since the last refresh, so the
+     *          row and the store index differ.
+     * @param[in] row The table row.
+     * @return The store index, or -1 if the sample was evicted.
+     */
+    int sampleIndex(int row) const;
+
+    /**
+     * @brief Standard row count for table.
+     * @param[in] parent The parent model index.
+     * @return Total rows in the table.
+     */
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    /**
+     * @brief Standard column count for table.
+     * @param[in] parent The parent model index.
+     * @return The total number of columns.
+     */
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    /**
+     * @brief Return the textual data for a specific table cell.
+     * @param[in] index Obtain data for this table index.
+     * @param[in] role The item data role.
+     * @return The cell data.
+     */
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Method to obtain the column headers.
+     * @param[in] section The column number to return the header for.
+     * @param[in] orientation Only Qt::Horizontal has headers.
+     * @param[in] role The item data role.
+     * @return Returns the string for the column header.
+     */
+    QVariant headerData(int section,
+                        Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+private:
+
+    /// The shown metadata of one history slot.
+    struct HistoryRow
+    {
+        /// The source timestamp in nanoseconds since the Unix epoch.
+        int64_t sourceTime;
+
+        /// The local reception time in nanoseconds since the Unix epoch.
+        int64_t receptionTime;
+
+        /// The GUID of the data writer.
+        OpenDDS::DCPS::GUID_t writer;
+
+        /// The decoded size of the sample in bytes. 0 if unknown.
+        size_t bytes;
+
+        /// The insertion order of the sample.
+        uint64_t sequence;
+    };
+
+    /// Stores the names of all column titles
+    QStringList m_columnHeaders;
+
+    /// The sample store of the topic. Flushing clears it in place.
+    std::shared_ptr<TopicSampleStore> m_store;
+
+    /// The shown rows. The front is the newest sample.
+    std::deque<HistoryRow> m_rows;
+
+}; // End class HistoryTableModel
+
+#endif
+
+/**
+ * @}
+ */
@@ -25,6 +25,7 @@ DDSMonitorMainWindow::DDSMonitorMainWindow() :
     m_participantPage(nullptr)
 {
     setupUi(this);
+    CommonData::loadHistorySettings();
     parseCmd();
 
     // Remove the blank tab page
@@ -303,6 +304,14 @@ void DDSMonitorMainWindow::parseCmd()
                 << "\nUsage: "
                 << argList.at(0).toStdString()
                 << " --domain=[-1-232]"
+                << " --history=<samples>"
+                << " --topic-history=<topic>:<samples>"
+                << " --memory-budget=<bytes>"
+                << " --eviction=[oldest|fair]"
+                << " --lazy-decode=[on|off]"
+                << " --decode-threads=<threads>"
+                << " --decode-queue=<samples>"
+                << " --topic-ingest=<topic>:[newest|oldest|decimate:<hz>]"
                 << std::endl;
 
             exit(0);
@@ -334,6 +343,147 @@ void DDSMonitorMainWindow::parseCmd()
             thisApp->setProperty("domain", domainID);
         }
 
+        // Did the user specify the default history depth?
+        else if (argString == "history")
+        {
+            const int depth = argList.at(i + 1).toInt();
+            if (depth < 1 || depth > CommonData::MAX_HISTORY_DEPTH)
+            {
+                std::cerr << "Invalid history command line argument. "
+                          << "The depth must be 1 to "
+                          << CommonData::MAX_HISTORY_DEPTH << "."
+                          << std::endl;
+                exit(1);
+            }
+            CommonData::setDefaultHistoryDepth(depth);
+        }
+
+        // Did the user specify the history depth of a topic?
+        else if (argString == "topic-history")
+        {
+            const QString topicArg = argList.at(i + 1);
+            const int split = topicArg.lastIndexOf(':');
+            const int depth = split > 0 ? topicArg.mid(split + 1).toInt() : 0;
+            if (depth < 1 || depth > CommonData::MAX_HISTORY_DEPTH)
+            {
+                std::cerr << "Invalid topic-history command line argument. "
+                          << "Expected <topic>:<samples> with 1 to "
+                          << CommonData::MAX_HISTORY_DEPTH << " samples."
+                          << std::endl;
+                exit(1);
+            }
+            CommonData::setHistoryDepth(topicArg.left(split), depth);
+        }
+
+        // Did the user specify a memory budget for the sample history?
+        else if (argString == "memory-budget")
+        {
+            bool ok = false;
+            const qulonglong budget = argList.at(i + 1).toULongLong(&ok);
+            if (!ok)
+            {
+                std::cerr << "Invalid memory-budget command line argument. "
+                          << "The budget must be a number of bytes."
+                          << std::endl;
+                exit(1);
+            }
+            CommonData::setMemoryBudget(budget);
+        }
+
+        // Did the user specify how to evict samples over the memory budget?
+        else if (argString == "eviction")
+        {
+            const QString policy = argList.at(i + 1);
+            if (policy == "oldest")
+            {
+                CommonData::setEvictionPolicy(EvictionPolicy::OldestFirst);
+            }
+            else if (policy == "fair")
+            {
+                CommonData::setEvictionPolicy(EvictionPolicy::FairShare);
+            }
+            else
+            {
+                std::cerr << "Invalid eviction command line argument. "
+                          << "The policy must be oldest or fair."
+                          << std::endl;
+                exit(1);
+            }
+        }
+
+        // Did the user ask to keep samples serialized until they are read?
+        else if (argString == "lazy-decode")
+        {
+            const QString mode = argList.at(i + 1);
+            if (mode == "on")
+            {
+                CommonData::setLazyDecoding(true);
+            }
+            else if (mode == "off")
+            {
+                CommonData::setLazyDecoding(false);
+            }
+            else
+            {
+                std::cerr << "Invalid lazy-decode command line argument. "
+                          << "The mode must be on or off."
+                          << std::endl;
+                exit(1);
+            }
+        }
+
+        // Did the user specify the number of decode threads?
+        else if (argString == "decode-threads")
+        {
+            const int count = argList.at(i + 1).toInt();
+            if (count < 1 || count > CommonData::MAX_DECODE_THREADS)
+            {
+                std::cerr << "Invalid decode-threads command line argument. "
+                          << "The count must be 1 to "
+                          << CommonData::MAX_DECODE_THREADS << "."
+                          << std::endl;
+                exit(1);
+            }
+            CommonData::setDecodeThreadCount(count);
+        }
+
+        // Did the user specify how many samples a topic may queue for decoding?
+        else if (argString == "decode-queue")
+        {
+            const int depth = argList.at(i + 1).toInt();
+            if (depth < 1 || depth > CommonData::MAX_DECODE_QUEUE_DEPTH)
+            {
+                std::cerr << "Invalid decode-queue command line argument. "
+                          << "The depth must be 1 to "
+                          << CommonData::MAX_DECODE_QUEUE_DEPTH << "."
+                          << std::endl;
+                exit(1);
+            }
+            CommonData::setDecodeQueueDepth(depth);
+        }
+
+        // Did the user specify how a topic handles overload?
+        else if (argString == "topic-ingest")
+        {
+            const QString topicArg = argList.at(i + 1);
+            int split = topicArg.lastIndexOf(":decimate:");
+            if (split < 0)
+            {
+                split = topicArg.lastIndexOf(':');
+            }
+
+            IngestPolicy policy;
+            if (split <= 0 || !IngestPolicy::fromString(topicArg.mid(split + 1), policy))
+            {
+                std::cerr << "Invalid topic-ingest command line argument. "
+                          << "Expected <topic>:newest, <topic>:oldest or "
+                          << "<topic>:decimate:<hz>."
+                          << std::endl;
+                exit(1);
+            }
+            CommonData::setIngestPolicy(topicArg.left(split), policy);
+        }
+
     }
 
 }
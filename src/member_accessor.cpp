@@ -0,0 +1,783 @@
+#include "member_accessor.h"
+#include "open_dynamic_data.h"
+#include "dds_data.h"
+#include "topic_sample_store.h"
+
+#include <cstdlib>
+
+
+namespace
+{
+
+/// Follow the alias trail until we have the true type.
+CORBA::TypeCode_ptr unalias(CORBA::TypeCode_ptr typeCode)
+{
+    while (typeCode && typeCode->kind() == CORBA::tk_alias)
+    {
+        typeCode = TAO::unaliased_typecode(typeCode);
+    }
+    return typeCode;
+}
+
+/// True if the member kind can be read as a number.
+bool isNumericKind(CORBA::TCKind kind)
+{
+    switch (kind)
+    {
+    case CORBA::tk_long:
+    case CORBA::tk_short:
+    case CORBA::tk_ushort:
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong:
+    case CORBA::tk_float:
+    case CORBA::tk_double:
+    case CORBA::tk_char:
+    case CORBA::tk_wchar:
+    case CORBA::tk_octet:
+    case CORBA::tk_longlong:
+    case CORBA::tk_ulonglong:
+    case CORBA::tk_boolean:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Read a primitive member as a number.
+ * @param[in] member The target member. Either OpenDynamicData or FlatSample::Member.
+ * @param[out] value The value converted to T.
+ * @return True if the member is numeric; false otherwise.
+ */
+template<typename T, typename Member>
+bool numericValue(const Member& member, T& value)
+{
+    if (!isNumericKind(member.getKind()))
+    {
+        return false;
+    }
+    value = member.template getValue<T>();
+    return true;
+}
+
+/**
+ * @brief Read a primitive DynamicData member as a number.
+ * @param[in] parent The DynamicData directly holding the member.
+ * @param[in] id The id of the member within the parent.
+ * @param[in] kind The type kind of the member.
+ * @param[out] value The value converted to T.
+ * @return True if the member is numeric and was read; false otherwise.
+ */
+template<typename T>
+bool dynamicNumericValue(DDS::DynamicData_ptr parent,
+                         DDS::MemberId id,
+                         DDS::TypeKind kind,
+                         T& value)
+{
+    DDS::ReturnCode_t rc = DDS::RETCODE_ERROR;
+    switch (kind)
+    {
+    case OpenDDS::XTypes::TK_BOOLEAN:
+    {
+        CORBA::Boolean tmp = false;
+        rc = parent->get_boolean_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_BYTE:
+    {
+        CORBA::Octet tmp = 0;
+        rc = parent->get_byte_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_INT16:
+    {
+        CORBA::Short tmp = 0;
+        rc = parent->get_int16_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_UINT16:
+    {
+        CORBA::UShort tmp = 0;
+        rc = parent->get_uint16_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_ENUM:
+    case OpenDDS::XTypes::TK_INT32:
+    {
+        CORBA::Long tmp = 0;
+        rc = parent->get_int32_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_UINT32:
+    {
+        CORBA::ULong tmp = 0;
+        rc = parent->get_uint32_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_INT64:
+    {
+        CORBA::LongLong tmp = 0;
+        rc = parent->get_int64_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_UINT64:
+    {
+        CORBA::ULongLong tmp = 0;
+        rc = parent->get_uint64_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_FLOAT32:
+    {
+        CORBA::Float tmp = 0;
+        rc = parent->get_float32_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_FLOAT64:
+    {
+        CORBA::Double tmp = 0;
+        rc = parent->get_float64_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_CHAR8:
+    {
+        CORBA::Char tmp = 0;
+        rc = parent->get_char8_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    case OpenDDS::XTypes::TK_CHAR16:
+    {
+        CORBA::WChar tmp = 0;
+        rc = parent->get_char16_value(tmp, id);
+        if (rc == DDS::RETCODE_OK)
+        {
+            value = static_cast<T>(tmp);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return rc == DDS::RETCODE_OK;
+}
+
+/**
+ * @brief Read the elements of an array or sequence tree member as numbers.
+ * @param[in] member The array or sequence member.
+ * @param[out] values The element values.
+ * @return True if every element is numeric; false otherwise.
+ */
+bool numericValues(const OpenDynamicData& member, std::vector<double>& values)
+{
+    const CORBA::TCKind kind = member.getKind();
+    if (kind != CORBA::tk_array && kind != CORBA::tk_sequence)
+    {
+        return false;
+    }
+
+    values.resize(member.getLength());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        const std::shared_ptr<OpenDynamicData> element = member.getMember(i);
+        if (!element || !numericValue(*element, values[i]))
+        {
+            values.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Convert packed flat sample elements to numbers.
+ * @param[in] elements The first element.
+ * @param[in] count The number of elements.
+ * @param[out] values The converted values.
+ */
+template<typename T>
+void copyElements(const T* elements, size_t count, double* values)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        values[i] = static_cast<double>(elements[i]);
+    }
+}
+
+/**
+ * @brief Read the elements of an array or sequence flat member as numbers.
+ * @details Primitive elements are packed by type, so the type is checked once
+ *          and the values are converted in a tight loop.
+ * @param[in] member The array or sequence member.
+ * @param[out] values The element values.
+ * @return True if the elements are numeric; false otherwise.
+ */
+bool flatNumericValues(const FlatSample::Member& member, std::vector<double>& values)
+{
+    const CORBA::TCKind kind = member.getKind();
+    if (kind != CORBA::tk_array && kind != CORBA::tk_sequence)
+    {
+        return false;
+    }
+
+    const size_t count = member.getLength();
+    values.resize(count);
+    if (count == 0)
+    {
+        return true;
+    }
+
+    double* out = values.data();
+    switch (member.getElementKind())
+    {
+    case CORBA::tk_long:
+        copyElements(member.getElements<CORBA::Long>(), count, out);
+        break;
+    case CORBA::tk_short:
+        copyElements(member.getElements<CORBA::Short>(), count, out);
+        break;
+    case CORBA::tk_ushort:
+        copyElements(member.getElements<CORBA::UShort>(), count, out);
+        break;
+    case CORBA::tk_enum:
+    case CORBA::tk_ulong:
+        copyElements(member.getElements<CORBA::ULong>(), count, out);
+        break;
+    case CORBA::tk_float:
+        copyElements(member.getElements<CORBA::Float>(), count, out);
+        break;
+    case CORBA::tk_double:
+        copyElements(member.getElements<CORBA::Double>(), count, out);
+        break;
+    case CORBA::tk_boolean:
+        copyElements(member.getElements<CORBA::Boolean>(), count, out);
+        break;
+    case CORBA::tk_char:
+        copyElements(member.getElements<CORBA::Char>(), count, out);
+        break;
+    case CORBA::tk_wchar:
+        copyElements(member.getElements<CORBA::WChar>(), count, out);
+        break;
+    case CORBA::tk_octet:
+        copyElements(member.getElements<CORBA::Octet>(), count, out);
+        break;
+    case CORBA::tk_longlong:
+        copyElements(member.getElements<CORBA::LongLong>(), count, out);
+        break;
+    case CORBA::tk_ulonglong:
+        copyElements(member.getElements<CORBA::ULongLong>(), count, out);
+        break;
+    default:
+        values.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Copy a sequence read by one DynamicData bulk call.
+ * @param[out] values The element values.
+ * @param[in] get Fills a sequence of type Seq and returns the DDS return code.
+ * @return True if the sequence was read; false otherwise.
+ */
+template<typename Seq, typename Get>
+bool copyDynamicValues(std::vector<double>& values, Get get)
+{
+    Seq sequence;
+    if (get(sequence) != DDS::RETCODE_OK)
+    {
+        return false;
+    }
+
+    values.resize(sequence.length());
+    for (CORBA::ULong i = 0; i < sequence.length(); ++i)
+    {
+        values[i] = static_cast<double>(sequence[i]);
+    }
+    return true;
+}
+
+/**
+ * @brief Read the elements of an array or sequence DynamicData member.
+ * @param[in] parent The DynamicData directly holding the member.
+ * @param[in] id The id of the member within the parent.
+ * @param[in] elementKind The type kind of the elements.
+ * @param[out] values The element values.
+ * @return True if the elements are numeric and were read; false otherwise.
+ */
+bool dynamicNumericValues(DDS::DynamicData_ptr parent,
+                          DDS::MemberId id,
+                          DDS::TypeKind elementKind,
+                          std::vector<double>& values)
+{
+    switch (elementKind)
+    {
+    case OpenDDS::XTypes::TK_BOOLEAN:
+        return copyDynamicValues<DDS::BooleanSeq>(values,
+            [&](DDS::BooleanSeq& seq) { return parent->get_boolean_values(seq, id); });
+    case OpenDDS::XTypes::TK_BYTE:
+        return copyDynamicValues<DDS::ByteSeq>(values,
+            [&](DDS::ByteSeq& seq) { return parent->get_byte_values(seq, id); });
+    case OpenDDS::XTypes::TK_INT16:
+        return copyDynamicValues<DDS::Int16Seq>(values,
+            [&](DDS::Int16Seq& seq) { return parent->get_int16_values(seq, id); });
+    case OpenDDS::XTypes::TK_UINT16:
+        return copyDynamicValues<DDS::UInt16Seq>(values,
+            [&](DDS::UInt16Seq& seq) { return parent->get_uint16_values(seq, id); });
+    case OpenDDS::XTypes::TK_INT32:
+        return copyDynamicValues<DDS::Int32Seq>(values,
+            [&](DDS::Int32Seq& seq) { return parent->get_int32_values(seq, id); });
+    case OpenDDS::XTypes::TK_UINT32:
+        return copyDynamicValues<DDS::UInt32Seq>(values,
+            [&](DDS::UInt32Seq& seq) { return parent->get_uint32_values(seq, id); });
+    case OpenDDS::XTypes::TK_INT64:
+        return copyDynamicValues<DDS::Int64Seq>(values,
+            [&](DDS::Int64Seq& seq) { return parent->get_int64_values(seq, id); });
+    case OpenDDS::XTypes::TK_UINT64:
+        return copyDynamicValues<DDS::UInt64Seq>(values,
+            [&](DDS::UInt64Seq& seq) { return parent->get_uint64_values(seq, id); });
+    case OpenDDS::XTypes::TK_FLOAT32:
+        return copyDynamicValues<DDS::Float32Seq>(values,
+            [&](DDS::Float32Seq& seq) { return parent->get_float32_values(seq, id); });
+    case OpenDDS::XTypes::TK_FLOAT64:
+        return copyDynamicValues<DDS::Float64Seq>(values,
+            [&](DDS::Float64Seq& seq) { return parent->get_float64_values(seq, id); });
+    default:
+        return false;
+    }
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+MemberAccessor::MemberAccessor(const TopicInfo& topicInfo, const std::string& memberName)
+    : m_memberName(memberName)
+    , m_dynamic(topicInfo.typeMode() == TypeDiscoveryMode::DynamicType)
+    , m_valid(false)
+    , m_kind(CORBA::tk_null)
+    , m_elementKind(OpenDDS::XTypes::TK_NONE)
+{
+    if (m_dynamic)
+    {
+        DDS::DynamicType_var type = topicInfo.dynamicType();
+        m_valid = type && compile(type.in());
+    }
+    else
+    {
+        CORBA::TypeCode_var typeCode = topicInfo.typeCode();
+        m_valid = typeCode && compile(typeCode.in());
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::isValid() const
+{
+    return m_valid;
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::isDynamic() const
+{
+    return m_dynamic;
+}
+
+
+//------------------------------------------------------------------------------
+const std::string& MemberAccessor::memberName() const
+{
+    return m_memberName;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> MemberAccessor::find(const std::shared_ptr<OpenDynamicData>& sample) const
+{
+    if (!m_valid || m_dynamic)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<OpenDynamicData> member = sample;
+    for (const uint32_t position : m_positions)
+    {
+        // Sequences may be shorter in this sample than the path requires
+        if (!member || position >= member->getLength())
+        {
+            return nullptr;
+        }
+        member = member->getMember(static_cast<size_t>(position));
+    }
+    return member;
+}
+
+
+//------------------------------------------------------------------------------
+FlatSample::Member MemberAccessor::find(const FlatSample& sample) const
+{
+    if (!m_valid || m_dynamic)
+    {
+        return FlatSample::Member();
+    }
+
+    FlatSample::Member member = sample.root();
+    for (const uint32_t position : m_positions)
+    {
+        member = member.getMember(static_cast<size_t>(position));
+        if (!member)
+        {
+            break;
+        }
+    }
+    return member;
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::find(DDS::DynamicData_ptr sample,
+                          DDS::DynamicData_var& parent,
+                          DDS::MemberId& id) const
+{
+    if (!m_valid || !m_dynamic || !sample)
+    {
+        return false;
+    }
+
+    // MemberPath is not modified by the lookup, but its API is not const
+    OpenDDS::XTypes::MemberPath memberPath = m_memberPath;
+    return memberPath.get_member_from_data(sample, parent, id) == DDS::RETCODE_OK;
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::readNumber(const TopicSample& slot,
+                                const std::shared_ptr<OpenDynamicData>& tree,
+                                double& value) const
+{
+    return readSlot(slot, tree, value);
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::readNumber(const TopicSample& slot,
+                                const std::shared_ptr<OpenDynamicData>& tree,
+                                int64_t& value) const
+{
+    return readSlot(slot, tree, value);
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::readNumber(const TopicSample& slot,
+                                const std::shared_ptr<OpenDynamicData>& tree,
+                                uint64_t& value) const
+{
+    return readSlot(slot, tree, value);
+}
+
+
+//------------------------------------------------------------------------------
+template<typename T>
+bool MemberAccessor::readSlot(const TopicSample& slot,
+                              const std::shared_ptr<OpenDynamicData>& tree,
+                              T& value) const
+{
+    if (!m_valid)
+    {
+        return false;
+    }
+
+    if (m_dynamic)
+    {
+        DDS::DynamicData_var parent;
+        DDS::MemberId id = 0;
+        return m_memberType &&
+               find(slot.dynamicSample.in(), parent, id) &&
+               dynamicNumericValue(parent.in(), id, m_memberType->get_kind(), value);
+    }
+
+    if (slot.flat)
+    {
+        const FlatSample::Member member = find(*slot.flat);
+        return member && numericValue(member, value);
+    }
+
+    const std::shared_ptr<OpenDynamicData> member = tree ? find(tree) : nullptr;
+    return member && numericValue(*member, value);
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::readNumbers(const TopicSample& slot,
+                                 const std::shared_ptr<OpenDynamicData>& tree,
+                                 std::vector<double>& values) const
+{
+    values.clear();
+    if (!m_valid)
+    {
+        return false;
+    }
+
+    if (m_dynamic)
+    {
+        DDS::DynamicData_var parent;
+        DDS::MemberId id = 0;
+        return find(slot.dynamicSample.in(), parent, id) &&
+               dynamicNumericValues(parent.in(), id, m_elementKind, values);
+    }
+
+    if (slot.flat)
+    {
+        const FlatSample::Member member = find(*slot.flat);
+        return member && flatNumericValues(member, values);
+    }
+
+    const std::shared_ptr<OpenDynamicData> member = tree ? find(tree) : nullptr;
+    return member && numericValues(*member, values);
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::columnType(ColumnType& type) const
+{
+    if (!m_valid)
+    {
+        return false;
+    }
+
+    if (m_dynamic)
+    {
+        const DDS::DynamicType_var baseType = OpenDDS::XTypes::get_base_type(m_memberType.in());
+        switch (baseType ? baseType->get_kind() : OpenDDS::XTypes::TK_NONE)
+        {
+        case OpenDDS::XTypes::TK_INT16:
+        case OpenDDS::XTypes::TK_INT32:
+        case OpenDDS::XTypes::TK_INT64:
+            type = ColumnType::Int64;
+            return true;
+        case OpenDDS::XTypes::TK_UINT16:
+        case OpenDDS::XTypes::TK_UINT32:
+        case OpenDDS::XTypes::TK_UINT64:
+            type = ColumnType::UInt64;
+            return true;
+        case OpenDDS::XTypes::TK_FLOAT32:
+            type = ColumnType::Float;
+            return true;
+        case OpenDDS::XTypes::TK_FLOAT64:
+            type = ColumnType::Double;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    switch (m_kind)
+    {
+    case CORBA::tk_short:
+    case CORBA::tk_long:
+    case CORBA::tk_longlong:
+        type = ColumnType::Int64;
+        return true;
+    case CORBA::tk_ushort:
+    case CORBA::tk_ulong:
+    case CORBA::tk_ulonglong:
+        type = ColumnType::UInt64;
+        return true;
+    case CORBA::tk_float:
+        type = ColumnType::Float;
+        return true;
+    case CORBA::tk_double:
+        type = ColumnType::Double;
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+DDS::DynamicType_ptr MemberAccessor::memberType() const
+{
+    return m_memberType.in();
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::compile(CORBA::TypeCode_ptr typeCode)
+{
+    CORBA::TypeCode_ptr type = unalias(typeCode);
+    const std::string& path = m_memberName;
+    size_t pos = 0;
+
+    while (pos < path.size())
+    {
+        if (!type)
+        {
+            return false;
+        }
+
+        const CORBA::TCKind kind = type->kind();
+
+        // Array or sequence element
+        if (path[pos] == '[')
+        {
+            if (kind != CORBA::tk_array && kind != CORBA::tk_sequence)
+            {
+                return false;
+            }
+
+            char* end = nullptr;
+            const unsigned long index = std::strtoul(path.c_str() + pos + 1, &end, 10);
+            if (!end || *end != ']' || end == path.c_str() + pos + 1)
+            {
+                return false;
+            }
+            if (kind == CORBA::tk_array && index >= type->length())
+            {
+                return false;
+            }
+
+            m_positions.push_back(static_cast<uint32_t>(index));
+            type = unalias(type->content_type());
+            pos = static_cast<size_t>(end - path.c_str()) + 1;
+            continue;
+        }
+
+        // Eat '.' from struct members
+        if (path[pos] == '.')
+        {
+            if (m_positions.empty())
+            {
+                return false;
+            }
+            ++pos;
+        }
+
+        if (kind != CORBA::tk_struct)
+        {
+            return false;
+        }
+
+        const size_t end = path.find_first_of(".[", pos);
+        const std::string name = path.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+
+        // The position among the members with a valid type, like OpenDynamicData
+        bool found = false;
+        uint32_t position = 0;
+        const CORBA::ULong memberCount = type->member_count();
+        for (CORBA::ULong i = 0; i < memberCount; ++i)
+        {
+            CORBA::TypeCode_ptr memberType = type->member_type(i);
+            if (!memberType)
+            {
+                continue;
+            }
+
+            if (name == type->member_name(i))
+            {
+                m_positions.push_back(position);
+                type = unalias(memberType);
+                found = true;
+                break;
+            }
+            ++position;
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+        pos = (end == std::string::npos) ? path.size() : end;
+    }
+
+    m_kind = type ? type->kind() : CORBA::tk_null;
+    return !m_positions.empty();
+}
+
+
+//------------------------------------------------------------------------------
+bool MemberAccessor::compile(DDS::DynamicType_ptr type)
+{
+    if (m_memberPath.resolve_string_path(type, m_memberName) != DDS::RETCODE_OK)
+    {
+        return false;
+    }
+
+    DDS::DynamicTypeMember_var dtm;
+    if (m_memberPath.get_member_from_type(type, dtm) != DDS::RETCODE_OK)
+    {
+        return false;
+    }
+
+    DDS::MemberDescriptor_var md;
+    if (dtm->get_descriptor(md) != DDS::RETCODE_OK)
+    {
+        return false;
+    }
+
+    m_memberType = md->type();
+
+    // Cache the element kind for bulk reads of arrays and sequences
+    const DDS::DynamicType_var baseType = OpenDDS::XTypes::get_base_type(m_memberType.in());
+    const DDS::TypeKind kind = baseType ? baseType->get_kind() : OpenDDS::XTypes::TK_NONE;
+    DDS::TypeDescriptor_var td;
+    if ((kind == OpenDDS::XTypes::TK_SEQUENCE || kind == OpenDDS::XTypes::TK_ARRAY) &&
+        baseType->get_descriptor(td) == DDS::RETCODE_OK)
+    {
+        const DDS::DynamicType_var elementType = OpenDDS::XTypes::get_base_type(td->element_type());
+        if (elementType)
+        {
+            m_elementKind = elementType->get_kind();
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,201 @@
+#ifndef __MEMBER_ACCESSOR_H__
+#define __MEMBER_ACCESSOR_H__
+
+#ifdef WIN32
+#pragma warning(push, 0)  //No DDS warnings
+#endif
+
+#include <dds/DdsDynamicDataC.h>
+#include <dds/DCPS/XTypes/Utils.h>
+#include <tao/AnyTypeCode/TypeCode.h>
+
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+#include "flat_sample.h"
+#include "tracked_column.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class OpenDynamicData;
+class TopicInfo;
+struct TopicSample;
+
+
+/**
+ * @brief A topic member path resolved against the topic type.
+ * @details Parsing a path such as "a.b[3].c" and looking up member names is
+ *          done once, when the accessor is built. For TypeCode topics the
+ *          path becomes the child position at each level, so a sample is
+ *          read by indexing alone. For DynamicType topics the path becomes
+ *          an XTypes member id path and the member type is cached.
+ * @remarks An accessor is immutable once built and may be shared between
+ *          threads. It stays valid for as long as the topic type is the same.
+ */
+class MemberAccessor
+{
+public:
+
+    /**
+     * @brief Constructor for the member accessor.
+     * @param[in] topicInfo The topic information holding the topic type.
+     * @param[in] memberName The member path, such as "a.b[3].c".
+     */
+    MemberAccessor(const TopicInfo& topicInfo, const std::string& memberName);
+
+    /**
+     * @brief Check whether the member path was found in the topic type.
+     * @return True if the path resolved; false otherwise.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Check whether the accessor reads DynamicData samples.
+     * @return True for DynamicType topics; false for TypeCode topics.
+     */
+    bool isDynamic() const;
+
+    /**
+     * @brief Get the member path this accessor was built from.
+     * @return The member path.
+     */
+    const std::string& memberName() const;
+
+    /**
+     * @brief Find the member in a sample tree.
+     * @param[in] sample The root of the sample.
+     * @return The member or nullptr if it isn't in this sample.
+     */
+    std::shared_ptr<OpenDynamicData> find(const std::shared_ptr<OpenDynamicData>& sample) const;
+
+    /**
+     * @brief Find the member in a flat sample.
+     * @param[in] sample The sample.
+     * @return The member or an invalid view if it isn't in this sample.
+     */
+    FlatSample::Member find(const FlatSample& sample) const;
+
+    /**
+     * @brief Find the member in a DynamicData sample.
+     * @param[in] sample The sample.
+     * @param[out] parent The DynamicData directly holding the member.
+     * @param[out] id The id of the member within the parent.
+     * @return True if the member was found; false otherwise.
+     */
+    bool find(DDS::DynamicData_ptr sample,
+              DDS::DynamicData_var& parent,
+              DDS::MemberId& id) const;
+
+    /**
+     * @brief Read the member of a history slot as a number.
+     * @param[in] slot The history slot.
+     * @param[in] tree The decoded tree of the slot. Only used for TypeCode
+     *            slots that are not stored flat.
+     * @param[out] value The value converted to the output type. Unchanged if
+     *             the member is missing or not numeric.
+     * @return True if the value was read; false otherwise.
+     */
+    bool readNumber(const TopicSample& slot,
+                    const std::shared_ptr<OpenDynamicData>& tree,
+                    double& value) const;
+
+    /// @copydoc readNumber
+    bool readNumber(const TopicSample& slot,
+                    const std::shared_ptr<OpenDynamicData>& tree,
+                    int64_t& value) const;
+
+    /// @copydoc readNumber
+    bool readNumber(const TopicSample& slot,
+                    const std::shared_ptr<OpenDynamicData>& tree,
+                    uint64_t& value) const;
+
+    /**
+     * @brief Read every element of an array or sequence member as numbers.
+     * @details The elements are copied in one pass. Flat samples are read
+     *          straight from their contiguous nodes and DynamicData samples
+     *          through one bulk get_*_values() call, so no element is looked
+     *          up by path.
+     * @param[in] slot The history slot.
+     * @param[in] tree The decoded tree of the slot. Only used for TypeCode
+     *            slots that are not stored flat.
+     * @param[out] values The element values, replacing any previous content.
+     *             The storage is reused between calls.
+     * @return True if the member is a numeric array or sequence; false otherwise.
+     */
+    bool readNumbers(const TopicSample& slot,
+                     const std::shared_ptr<OpenDynamicData>& tree,
+                     std::vector<double>& values) const;
+
+    /**
+     * @brief Get the column type that holds the member exactly.
+     * @details Only integer and floating point members qualify. Booleans,
+     *          characters, enums and strings are formatted differently and
+     *          are read from the samples instead.
+     * @param[out] type The column type. Unchanged if the member isn't numeric.
+     * @return True if the member can be tracked; false otherwise.
+     */
+    bool columnType(ColumnType& type) const;
+
+    /**
+     * @brief Get the type of the member for DynamicType topics.
+     * @return The member type or nil for TypeCode topics.
+     */
+    DDS::DynamicType_ptr memberType() const;
+
+private:
+
+    /// Implements the readNumber overloads.
+    template<typename T>
+    bool readSlot(const TopicSample& slot,
+                  const std::shared_ptr<OpenDynamicData>& tree,
+                  T& value) const;
+
+    /**
+     * @brief Resolve the member path to child positions.
+     * @param[in] typeCode The type of the topic.
+     * @return True if the path resolved; false otherwise.
+     */
+    bool compile(CORBA::TypeCode_ptr typeCode);
+
+    /**
+     * @brief Resolve the member path to an XTypes member id path.
+     * @param[in] type The type of the topic.
+     * @return True if the path resolved; false otherwise.
+     */
+    bool compile(DDS::DynamicType_ptr type);
+
+    /// The member path this accessor was built from.
+    const std::string m_memberName;
+
+    /// True for DynamicType topics.
+    bool m_dynamic;
+
+    /// True if the member path was found in the topic type.
+    bool m_valid;
+
+    /// The child position at each level, for TypeCode topics.
+    std::vector<uint32_t> m_positions;
+
+    /// The kind of the member, for TypeCode topics.
+    CORBA::TCKind m_kind;
+
+    /// The member id path, for DynamicType topics.
+    OpenDDS::XTypes::MemberPath m_memberPath;
+
+    /// The type of the member, for DynamicType topics.
+    DDS::DynamicType_var m_memberType;
+
+    /// The element type kind of an array or sequence member, for DynamicType topics.
+    DDS::TypeKind m_elementKind;
+
+}; // End class MemberAccessor
+
+#endif
+
+/**
+ * @}
+ */
@@ -1,4 +1,6 @@
 #include <tao/AnyTypeCode/Enum_TypeCode.h>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -458,7 +460,8 @@ bool OpenDynamicData::operator>>(OpenDDS::DCPS::Serializer& stream) const
             //XCDR2 adds a delimiter header before every sequence of complex types. Try reading it from the typecode.
             if((m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) && child->containsComplexTypes())
             {
-                CORBA::ULong delimiterHeader = static_cast<CORBA::ULong>(child->getEncapsulationLength());
+                // The delimited size covers the length and the elements
+                CORBA::ULong delimiterHeader = static_cast<CORBA::ULong>(child->serializedEnd(sizeof(CORBA::ULong)));
                 //std::cout << "DEBUG Creating sequence delim hdr: " << delimiterHeader << std::endl;
                 pass &= (stream << delimiterHeader);
             }
@@ -476,7 +479,7 @@ bool OpenDynamicData::operator>>(OpenDDS::DCPS::Serializer& stream) const
             //XCDR2 adds a delimiter header before every struct. Try reading it from the typecode.
             if(m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1)
             {
-                CORBA::ULong delimiterHeader = static_cast<CORBA::ULong>(child->getEncapsulationLength());
+                CORBA::ULong delimiterHeader = static_cast<CORBA::ULong>(child->getSerializedSize());
                 //std::cout << "DEBUG Creating struct delim hdr: " << delimiterHeader << std::endl;
                 pass &= (stream << delimiterHeader);
             }
@@ -487,7 +490,7 @@ bool OpenDynamicData::operator>>(OpenDDS::DCPS::Serializer& stream) const
             //XCDR2 adds a delimiter header before every array of complex types. Try reading it from the typecode.
             if((m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) && child->containsComplexTypes())
             {
-                CORBA::ULong delimiterHeader = static_cast<CORBA::ULong>(child->getEncapsulationLength());
+                CORBA::ULong delimiterHeader = static_cast<CORBA::ULong>(child->getSerializedSize());
                 //std::cout << "DEBUG Creating array delim hdr: " << delimiterHeader << std::endl;
                 pass &= (stream << delimiterHeader);
             }
@@ -721,91 +724,110 @@ bool OpenDynamicData::isContainerType() const
 }
 
 //------------------------------------------------------------------------------
-size_t OpenDynamicData::getEncapsulationLength()
+size_t OpenDynamicData::getSerializedSize() const
 {
-    switch (m_typeCode->kind())
+    return serializedEnd(0);
+}
+
+
+//------------------------------------------------------------------------------
+size_t OpenDynamicData::serializedEnd(size_t offset) const
+{
+    // Values larger than the maximum alignment align to it
+    const size_t maxAlign = (m_encodingKind == OpenDDS::DCPS::Encoding::KIND_XCDR1) ? 8 : 4;
+    const bool delimited = (m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1);
+    auto put = [&offset, maxAlign](size_t size)
     {
-        case CORBA::tk_long:
-            return sizeof(CORBA::Long);
+        const size_t align = std::min(size, maxAlign);
+        offset = (offset + align - 1) / align * align + size;
+    };
+
+    for (const std::shared_ptr<OpenDynamicData>& child : m_children)
+    {
+        switch (child->getKind())
+        {
+        case CORBA::tk_boolean:
+        case CORBA::tk_char:
+        case CORBA::tk_octet:
+            put(1);
+            break;
         case CORBA::tk_short:
-            return sizeof(CORBA::Short);
         case CORBA::tk_ushort:
-            return sizeof(CORBA::UShort);
-        case CORBA::tk_enum:
-            return sizeof(CORBA::ULong);
+        case CORBA::tk_wchar:
+            put(2);
+            break;
+        case CORBA::tk_long:
         case CORBA::tk_ulong:
-            return sizeof(CORBA::ULong);
+        case CORBA::tk_enum:
         case CORBA::tk_float:
-            return sizeof(CORBA::Float);
-        case CORBA::tk_double:
-            return sizeof(CORBA::Double);
-        case CORBA::tk_char:
-            return sizeof(CORBA::Char);
-        case CORBA::tk_wchar:
-            return sizeof(CORBA::WChar);
-        case CORBA::tk_octet:
-            return sizeof(CORBA::Octet);
+            put(4);
+            break;
         case CORBA::tk_longlong:
-            return sizeof(CORBA::LongLong);
         case CORBA::tk_ulonglong:
-            return sizeof(CORBA::ULongLong);
-        case CORBA::tk_boolean:
-            return sizeof(CORBA::Boolean);
+        case CORBA::tk_double:
+            put(8);
+            break;
         case CORBA::tk_string:
-            {
-                std::string temp(m_stringValue);
-                //Per xtypes spec, section 7.4.3.5.3 rules 3, this includes NUL, and 4 bytes for string length
-                return temp.length() + 1 + sizeof(CORBA::ULong) ;
-            }
+        {
+            // The length includes the NUL
+            const char* value = child->getStringValue();
+            put(sizeof(CORBA::ULong));
+            offset += (value ? strlen(value) : 0) + 1;
+            break;
+        }
         case CORBA::tk_sequence:
+            if (delimited && child->containsComplexTypes())
             {
-                //per xtypes spec, section 7.4.3.5.3 rule 12, delimiter header includes the length of the sequence of complex types.
-                //so if the length is 0, delim header should still be 4..
-                //all sequences first serialize the length
-                size_t ret = sizeof(CORBA::ULong);
-
-                if(getLength() > 0)
-                {
-                    ret +=  m_children[0]->getEncapsulationLength() * getLength();
-                }
-                if((m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) && containsComplexTypes())
-                {
-                    ret += sizeof(CORBA::ULong);
-                }
-                return ret;
+                put(sizeof(CORBA::ULong));
             }
+            put(sizeof(CORBA::ULong));
+            offset = child->serializedEnd(offset);
+            break;
         case CORBA::tk_struct:
+            if (delimited)
             {
-                size_t sum=0;
-                for(const auto& child : m_children)
-                {
-                    sum += child->getEncapsulationLength();
-                }
-                //if xcdr2 and appendable or mutable, add delimiter header, per rule (30)
-                if((m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) && (m_extensibility != OpenDDS::DCPS::Extensibility::FINAL))
-                {
-                    sum += sizeof(CORBA::ULong);
-                }
-                return sum;
+                put(sizeof(CORBA::ULong));
             }
+            offset = child->serializedEnd(offset);
+            break;
         case CORBA::tk_array:
+            if (delimited && child->containsComplexTypes())
             {
-                size_t sum = 0;
-                if(getLength() > 0)
-                {
-                    sum += m_children[0]->getEncapsulationLength() * getLength();
-                }
-                if((m_encodingKind != OpenDDS::DCPS::Encoding::KIND_XCDR1) && containsComplexTypes())
-                {
-                    sum += sizeof(CORBA::ULong);
-                }
-                return sum;
+                put(sizeof(CORBA::ULong));
             }
-        case CORBA::tk_union: // TODO?
-        case CORBA::tk_wstring:  // TODO?
+            offset = child->serializedEnd(offset);
+            break;
         default:
-            return 0;
+            // operator>> fails on these, so nothing is written
+            break;
+        }
+    }
+
+    return offset;
+}
+
+
+//------------------------------------------------------------------------------
+size_t OpenDynamicData::getDecodedSize() const
+{
+    // Each node is a single make_shared allocation holding the object and
+    // its reference counts.
+    size_t size = sizeof(OpenDynamicData) + 2 * sizeof(long);
+    size += m_name.capacity();
+    size += m_children.capacity() * sizeof(std::shared_ptr<OpenDynamicData>);
+
+    if (getKind() == CORBA::tk_string)
+    {
+        const char* value = m_stringValue;
+        size += value ? strlen(value) + 1 : 0;
+    }
+
+    for (const auto& child : m_children)
+    {
+        size += child->getDecodedSize();
     }
+
+    return size;
 }
 
 //------------------------------------------------------------------------------
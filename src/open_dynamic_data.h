@@ -247,10 +247,30 @@ public:
      */
     void populate();
 
-    size_t getEncapsulationLength();
+    /**
+     * @brief Get the exact number of bytes operator>> writes for the members.
+     * @details Includes the CDR alignment padding, where 8-byte values align
+     *          to 8 bytes in XCDR1 and 4 bytes in XCDR2, and the XCDR2
+     *          delimiter headers written by operator>>.
+     * @return The serialized size in bytes, starting at an aligned position.
+     */
+    size_t getSerializedSize() const;
+
+    /**
+     * @brief Get the memory used by this member and all of its children.
+     * @return The decoded size in bytes.
+     */
+    size_t getDecodedSize() const;
 
 private:
 
+    /**
+     * @brief Advance a stream position over the members written by operator>>.
+     * @param[in] offset The position relative to the last alignment reset.
+     * @return The position after the members.
+     */
+    size_t serializedEnd(size_t offset) const;
+
     /**
      * @brief Set the name of a child member.
      * @param[in] name The name of the child member.
@@ -269,6 +289,9 @@ private:
      */
     bool isContainerType(const CORBA::TCKind tck) const;
 
+    /// Builds nodes directly from its precompiled type table.
+    friend class DecodePlan;
+
 
     /// Stores all primitive data types.
     union SimpleTypeUnion
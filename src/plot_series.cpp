@@ -0,0 +1,431 @@
+#include "plot_series.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+
+/**
+ * @brief Find the entries of a newest-first history that overlap a range.
+ * @details One entry beyond each end of the range is included.
+ * @param[in] count The number of entries.
+ * @param[in] xMin The lowest x value displayed.
+ * @param[in] xMax The highest x value displayed.
+ * @param[in] firstX Returns the lowest x value of an entry by index.
+ * @param[in] lastX Returns the highest x value of an entry by index.
+ * @param[out] newest The index of the newest entry in the range.
+ * @param[out] viewCount The number of entries in the range.
+ */
+template<typename FirstX, typename LastX>
+void findWindow(size_t count,
+                double xMin,
+                double xMax,
+                FirstX firstX,
+                LastX lastX,
+                size_t& newest,
+                size_t& viewCount)
+{
+    if (count == 0)
+    {
+        newest = 0;
+        viewCount = 0;
+        return;
+    }
+
+    // The x values decrease with the index, so binary search both ends.
+    // First, the newest entry starting at or before xMax.
+    size_t low = 0;
+    size_t high = count;
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (firstX(middle) > xMax)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    newest = (low > 0) ? low - 1 : 0;
+
+    // Then the first entry ending before xMin
+    low = newest;
+    high = count;
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (lastX(middle) >= xMin)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    viewCount = std::min(low, count - 1) - newest + 1;
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+PlotTimeline::PlotTimeline(size_t capacity)
+    : m_times(capacity)
+{}
+
+
+//------------------------------------------------------------------------------
+void PlotTimeline::append(double x)
+{
+    m_times.push(x);
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotTimeline::count() const
+{
+    return m_times.size();
+}
+
+
+//------------------------------------------------------------------------------
+double PlotTimeline::x(size_t index) const
+{
+    return m_times.at(index);
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotTimeline::capacity() const
+{
+    return m_times.capacity();
+}
+
+
+//------------------------------------------------------------------------------
+void PlotTimeline::setCapacity(size_t capacity)
+{
+    if (capacity == m_times.capacity())
+    {
+        return;
+    }
+
+    // Refill a new ring with the newest values, oldest first
+    SampleRing<double> times(capacity);
+    for (size_t i = std::min(capacity, m_times.size()); i > 0; --i)
+    {
+        times.push(m_times.at(i - 1));
+    }
+
+    m_times = std::move(times);
+}
+
+
+//------------------------------------------------------------------------------
+void PlotTimeline::clear()
+{
+    m_times.clear();
+}
+
+
+//------------------------------------------------------------------------------
+PlotSeries::PlotSeries(const std::shared_ptr<const PlotTimeline>& timeline)
+    : m_timeline(timeline)
+    , m_values(timeline->capacity())
+    , m_resolution(1000)
+    , m_viewLevel(-1)
+    , m_biasScale(1.0)
+    , m_biasShift(0.0)
+    , m_xMin(0.0)
+    , m_xMax(0.0)
+    , m_viewNewest(0)
+    , m_viewCount(0)
+{
+    buildLevels();
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::append(double y)
+{
+    // Hold the previous value over missing ones
+    if (std::isnan(y))
+    {
+        y = (m_values.size() > 0) ? m_values.at(0) : 0.0;
+    }
+
+    m_values.push(y);
+
+    Point point;
+    point.x = m_timeline->x(0);
+    point.y = y;
+    addToLevels(point);
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::count() const
+{
+    return m_values.size();
+}
+
+
+//------------------------------------------------------------------------------
+double PlotSeries::x(size_t index) const
+{
+    return m_timeline->x(index);
+}
+
+
+//------------------------------------------------------------------------------
+double PlotSeries::y(size_t index) const
+{
+    return m_values.at(index);
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::updateCapacity()
+{
+    const size_t capacity = m_timeline->capacity();
+    if (capacity == m_values.capacity())
+    {
+        return;
+    }
+
+    // Refill a new ring with the newest values, oldest first
+    SampleRing<double> values(capacity);
+    for (size_t i = std::min(capacity, m_values.size()); i > 0; --i)
+    {
+        values.push(m_values.at(i - 1));
+    }
+
+    m_values = std::move(values);
+    buildLevels();
+    updateView();
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::clear()
+{
+    m_values.clear();
+    for (Level& level : m_levels)
+    {
+        level.closed.clear();
+        level.open = Bucket();
+    }
+    updateView();
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::setBias(double scale, double shift)
+{
+    m_biasScale = scale;
+    m_biasShift = shift;
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::setResolution(int pixels)
+{
+    pixels = std::max(pixels, 1);
+    if (pixels == m_resolution)
+    {
+        return;
+    }
+
+    m_resolution = pixels;
+    updateView();
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::setView(double xMin, double xMax)
+{
+    m_xMin = xMin;
+    m_xMax = xMax;
+    updateView();
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::size() const
+{
+    // Each bucket is drawn as its minimum and maximum
+    return (m_viewLevel < 0) ? m_viewCount : 2 * m_viewCount;
+}
+
+
+//------------------------------------------------------------------------------
+QPointF PlotSeries::sample(size_t i) const
+{
+    if (m_viewLevel < 0)
+    {
+        const size_t index = m_viewNewest + m_viewCount - 1 - i;
+        return QPointF(m_timeline->x(index), m_values.at(index) * m_biasScale + m_biasShift);
+    }
+
+    const Bucket& entry = bucket(m_levels[m_viewLevel],
+                                 m_viewNewest + m_viewCount - 1 - i / 2);
+
+    // Keep the order in which the extremes occurred
+    const bool minFirst = entry.min.x <= entry.max.x;
+    const Point& point = ((i % 2 == 0) == minFirst) ? entry.min : entry.max;
+    return QPointF(point.x, point.y * m_biasScale + m_biasShift);
+}
+
+
+//------------------------------------------------------------------------------
+QRectF PlotSeries::boundingRect() const
+{
+    const size_t count = size();
+    if (count == 0)
+    {
+        return QRectF(1.0, 1.0, -2.0, -2.0); // Invalid
+    }
+
+    double minY = sample(0).y();
+    double maxY = minY;
+    for (size_t i = 1; i < count; ++i)
+    {
+        const double y = sample(i).y();
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+
+    const double minX = sample(0).x();
+    const double maxX = sample(count - 1).x();
+    return QRectF(minX, minY, maxX - minX, maxY - minY);
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::updateView()
+{
+    const PlotTimeline& timeline = *m_timeline;
+    findWindow(count(), m_xMin, m_xMax,
+        [&timeline](size_t i) { return timeline.x(i); },
+        [&timeline](size_t i) { return timeline.x(i); },
+        m_viewNewest, m_viewCount);
+    m_viewLevel = -1;
+
+    if (m_viewCount <= static_cast<size_t>(m_resolution) || m_levels.empty())
+    {
+        return;
+    }
+
+    // Use the finest level with no more buckets than pixels
+    const size_t pointCount = m_viewCount;
+    size_t levelIndex = 0;
+    while (levelIndex + 1 < m_levels.size() &&
+           pointCount / m_levels[levelIndex].bucketSize > static_cast<size_t>(m_resolution))
+    {
+        ++levelIndex;
+    }
+
+    // The oldest buckets may summarize points that were already overwritten
+    const Level& level = m_levels[levelIndex];
+    const double oldestX = m_timeline->x(count() - 1);
+    size_t buckets = bucketCount(level);
+    while (buckets > 1 && bucket(level, buckets - 1).lastX < oldestX)
+    {
+        --buckets;
+    }
+
+    findWindow(buckets, m_xMin, m_xMax,
+        [&level](size_t i) { return bucket(level, i).firstX; },
+        [&level](size_t i) { return bucket(level, i).lastX; },
+        m_viewNewest, m_viewCount);
+    m_viewLevel = static_cast<int>(levelIndex);
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::buildLevels()
+{
+    m_levels.clear();
+
+    const size_t capacity = m_values.capacity();
+    for (size_t bucketSize = LEVEL_FACTOR;
+         capacity / bucketSize >= MIN_BUCKETS;
+         bucketSize *= LEVEL_FACTOR)
+    {
+        Level level;
+        level.bucketSize = bucketSize;
+        level.closed = SampleRing<Bucket>(capacity / bucketSize + 1);
+        m_levels.push_back(std::move(level));
+    }
+
+    // Summarize the stored points, oldest first
+    for (size_t i = count(); i > 0; --i)
+    {
+        Point point;
+        point.x = m_timeline->x(i - 1);
+        point.y = m_values.at(i - 1);
+        addToLevels(point);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void PlotSeries::addToLevels(const Point& point)
+{
+    for (Level& level : m_levels)
+    {
+        Bucket& open = level.open;
+        if (open.count == 0)
+        {
+            open.firstX = point.x;
+            open.min = point;
+            open.max = point;
+        }
+        else
+        {
+            if (point.y < open.min.y)
+            {
+                open.min = point;
+            }
+            if (point.y > open.max.y)
+            {
+                open.max = point;
+            }
+        }
+
+        open.lastX = point.x;
+        if (++open.count == level.bucketSize)
+        {
+            level.closed.push(open);
+            open = Bucket();
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+size_t PlotSeries::bucketCount(const Level& level)
+{
+    return level.closed.size() + (level.open.count > 0 ? 1 : 0);
+}
+
+
+//------------------------------------------------------------------------------
+const PlotSeries::Bucket& PlotSeries::bucket(const Level& level, size_t index)
+{
+    if (level.open.count > 0)
+    {
+        return (index == 0) ? level.open : level.closed.at(index - 1);
+    }
+    return level.closed.at(index);
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,307 @@
+#ifndef __PLOT_SERIES_H__
+#define __PLOT_SERIES_H__
+
+#include "sample_ring.h"
+
+#ifdef __GNUG__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+#include <qwt_series_data.h>
+#ifdef __GNUG__
+#pragma GCC diagnostic pop
+#endif
+
+#include <QPointF>
+#include <QRectF>
+
+#include <memory>
+#include <vector>
+
+
+/**
+ * @brief Circular x value history shared by the curves of one topic.
+ * @details The curves filled from the same samples share one timeline, so
+ *          each x value is stored once however many curves are plotted.
+ *          Every append here must be followed by one PlotSeries::append on
+ *          each series of the timeline.
+ */
+class PlotTimeline
+{
+public:
+
+    /**
+     * @brief Constructor for the plot timeline.
+     * @param[in] capacity The maximum number of x values to keep.
+     */
+    explicit PlotTimeline(size_t capacity);
+
+    /**
+     * @brief Add a new x value, replacing the oldest one if the history is full.
+     * @param[in] x The x value.
+     */
+    void append(double x);
+
+    /**
+     * @brief Get the number of stored x values.
+     * @return The number of x values in the history.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Get a stored x value.
+     * @param[in] index The value index. 0 is the newest.
+     * @return The x value. The index must be less than count().
+     */
+    double x(size_t index) const;
+
+    /**
+     * @brief Get the maximum number of x values kept.
+     * @return The capacity of the history.
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Change the maximum number of x values kept.
+     * @details The newest values are kept when the history shrinks. Each
+     *          series must then call updateCapacity().
+     * @param[in] capacity The new capacity.
+     */
+    void setCapacity(size_t capacity);
+
+    /**
+     * @brief Delete all x values while keeping the storage.
+     */
+    void clear();
+
+private:
+
+    /// The x values. Index 0 is the newest.
+    SampleRing<double> m_times;
+
+}; // End class PlotTimeline
+
+
+/**
+ * @brief Circular point history of one graph curve.
+ * @details The y values are kept in a ring next to a shared PlotTimeline.
+ *          New points overwrite the oldest ones once the history is full, so
+ *          adding a point is O(1). The curve reads the points of the current
+ *          x-axis view straight out of the rings, with the bias applied on
+ *          the fly, so nothing is shifted or copied per frame.
+ *
+ *          Alongside the points, a pyramid of min/max levels is kept up to
+ *          date as points arrive. Each level summarizes runs of
+ *          LEVEL_FACTOR times more points than the level below. When the
+ *          view holds more points than the canvas has pixels, the curve is
+ *          fed the minimum and maximum of each bucket of the coarsest level
+ *          that still fills the canvas, so long views stay fast to draw and
+ *          no spike is hidden.
+ * @remarks The points are expected to arrive in x order, which holds for
+ *          source timestamps of a single topic.
+ */
+class PlotSeries : public QwtSeriesData<QPointF>
+{
+public:
+
+    /**
+     * @brief Constructor for the plot series.
+     * @param[in] timeline The x values of the points. Must be empty or
+     *            cleared together with every series using it.
+     */
+    explicit PlotSeries(const std::shared_ptr<const PlotTimeline>& timeline);
+
+    /**
+     * @brief Add the y value of the newest x value of the timeline.
+     * @details A missing value (NaN) repeats the previous value, so the curve
+     *          stays continuous. The view is not updated, so call setView()
+     *          once after the last append of a frame before drawing.
+     * @param[in] y The y value without the bias.
+     */
+    void append(double y);
+
+    /**
+     * @brief Get the number of stored points.
+     * @return The number of points in the history.
+     */
+    size_t count() const;
+
+    /**
+     * @brief Get the x value of a stored point.
+     * @param[in] index The point index. 0 is the newest.
+     * @return The x value. The index must be less than count().
+     */
+    double x(size_t index) const;
+
+    /**
+     * @brief Get the y value of a stored point.
+     * @param[in] index The point index. 0 is the newest.
+     * @return The y value without the bias. The index must be less than count().
+     */
+    double y(size_t index) const;
+
+    /**
+     * @brief Follow a capacity change of the timeline.
+     * @details The newest values are kept when the history shrinks.
+     */
+    void updateCapacity();
+
+    /**
+     * @brief Delete all points while keeping the storage.
+     */
+    void clear();
+
+    /**
+     * @brief Set the bias applied to the y values handed to the curve.
+     * @param[in] scale The y-axis scaler value.
+     * @param[in] shift The y-axis shift value.
+     */
+    void setBias(double scale, double shift);
+
+    /**
+     * @brief Set the width of the canvas the curve is drawn into.
+     * @param[in] pixels The canvas width in pixels.
+     */
+    void setResolution(int pixels);
+
+    /**
+     * @brief Select the points handed to the curve.
+     * @details One point beyond each end of the range is included so the
+     *          line reaches the edges of the canvas.
+     * @param[in] xMin The lowest x value displayed.
+     * @param[in] xMax The highest x value displayed.
+     */
+    void setView(double xMin, double xMax);
+
+    /**
+     * @brief Get the number of points in the view.
+     * @remarks Reimplemented from QwtSeriesData.
+     * @return The number of points in the view.
+     */
+    size_t size() const override;
+
+    /**
+     * @brief Get a point of the view with the bias applied.
+     * @remarks Reimplemented from QwtSeriesData.
+     * @param[in] i The point index within the view. 0 is the oldest.
+     * @return The point.
+     */
+    QPointF sample(size_t i) const override;
+
+    /**
+     * @brief Get the bounding rectangle of the points in the view.
+     * @remarks Reimplemented from QwtSeriesData.
+     * @return The bounding rectangle.
+     */
+    QRectF boundingRect() const override;
+
+private:
+
+    /// One point of the history.
+    struct Point
+    {
+        double x = 0.0;
+        double y = 0.0;
+    };
+
+    /// The minimum and maximum of a run of consecutive points.
+    struct Bucket
+    {
+        double firstX = 0.0;
+        double lastX = 0.0;
+        Point min;
+        Point max;
+        size_t count = 0;
+    };
+
+    /// One level of the min/max pyramid.
+    struct Level
+    {
+        /// The number of points summarized by a full bucket.
+        size_t bucketSize = 0;
+
+        /// The full buckets. Index 0 is the newest.
+        SampleRing<Bucket> closed;
+
+        /// The bucket being filled by new points.
+        Bucket open;
+    };
+
+    /// The ratio between the bucket sizes of neighboring levels.
+    static const size_t LEVEL_FACTOR = 4;
+
+    /// No level is built with fewer buckets than this over the history.
+    static const size_t MIN_BUCKETS = 256;
+
+    /**
+     * @brief Update the view after points were added or removed.
+     */
+    void updateView();
+
+    /**
+     * @brief Allocate the levels for the capacity and fill them from the
+     *        stored points.
+     */
+    void buildLevels();
+
+    /**
+     * @brief Add a new point to every level.
+     * @param[in] point The new point.
+     */
+    void addToLevels(const Point& point);
+
+    /**
+     * @brief Get the number of buckets in a level, including the open one.
+     * @param[in] level The level.
+     * @return The number of buckets.
+     */
+    static size_t bucketCount(const Level& level);
+
+    /**
+     * @brief Get a bucket of a level.
+     * @param[in] level The level.
+     * @param[in] index The bucket index. 0 is the newest.
+     * @return The bucket. The index must be less than bucketCount().
+     */
+    static const Bucket& bucket(const Level& level, size_t index);
+
+    /// The x values of the points.
+    std::shared_ptr<const PlotTimeline> m_timeline;
+
+    /// The y values. Index 0 is the newest.
+    SampleRing<double> m_values;
+
+    /// The min/max pyramid, finest level first.
+    std::vector<Level> m_levels;
+
+    /// The canvas width in pixels.
+    int m_resolution;
+
+    /// The level in the view, or -1 if the points are shown directly.
+    int m_viewLevel;
+
+    /// The y-axis scaler value.
+    double m_biasScale;
+
+    /// The y-axis shift value.
+    double m_biasShift;
+
+    /// The lowest x value displayed.
+    double m_xMin;
+
+    /// The highest x value displayed.
+    double m_xMax;
+
+    /// The index of the newest point or bucket in the view.
+    size_t m_viewNewest;
+
+    /// The number of points or buckets in the view.
+    size_t m_viewCount;
+
+}; // End class PlotSeries
+
+#endif
+
+/**
+ * @}
+ */
@@ -1,10 +1,11 @@
 #include "recorder_dialog.h"
 #include "dds_data.h"
+#include "member_accessor.h"
+#include "serialized_sample.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QSettings>
-#include <QTime>
 
 #if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
 #include <QTextCodec>
@@ -17,7 +18,7 @@ RecorderDialog::RecorderDialog(const QString& topicName,
                                QDialog(parent),
                                m_topicMembers(members),
                                m_topicName(topicName),
-                               m_latestTimestamp("00:00:00.000"),
+                               m_sequence(0),
                                m_delimiter(","),
                                m_updateTimer(this),
                                m_rowCount(0)
@@ -50,6 +51,7 @@ RecorderDialog::~RecorderDialog()
     if (m_updateTimer.isActive())
     {
         m_updateTimer.stop();
+        untrackMembers();
     }
     if (m_outputFile.isOpen())
     {
@@ -181,8 +183,29 @@ void RecorderDialog::on_recordButton_clicked()
     closeButton->setVisible(false);
 
 
-    // Only record data with a timestamp after the current time
-    m_latestTimestamp = QTime::currentTime().toString("HH:mm:ss.zzz");
+    // Resolve the member paths once for the whole recording
+    m_memberAccessors.clear();
+    for (int i = 0; i < m_topicMembers.count(); i++)
+    {
+        m_memberAccessors.append(CommonData::compileMember(m_topicName, m_topicMembers.at(i)));
+    }
+
+    // Numeric members are read from columns filled as the samples arrive
+    m_trackedMembers.fill(false, m_topicMembers.count());
+    m_columnTypes.fill(ColumnType::Double, m_topicMembers.count());
+    for (int i = 0; i < m_topicMembers.count(); i++)
+    {
+        const std::shared_ptr<const MemberAccessor>& accessor = m_memberAccessors.at(i);
+        if (accessor && accessor->columnType(m_columnTypes[i]))
+        {
+            m_trackedMembers[i] = CommonData::trackMember(m_topicName,
+                                                          m_topicMembers.at(i),
+                                                          m_columnTypes.at(i));
+        }
+    }
+
+    // Only record the samples stored from now on
+    m_sequence = CommonData::newestSequence(m_topicName);
     m_rowCount = 0;
 
     dumpData();
@@ -195,6 +218,7 @@ void RecorderDialog::on_recordButton_clicked()
 void RecorderDialog::on_stopButton_clicked()
 {
     m_updateTimer.stop();
+    untrackMembers();
     m_outputFile.close();
 
     recordingStatusLabel->setVisible(false);
@@ -210,27 +234,61 @@ void RecorderDialog::on_stopButton_clicked()
 //------------------------------------------------------------------------------
 void RecorderDialog::dumpData()
 {
-    QStringList sampleNames = CommonData::getSampleList(m_topicName);
-
-    // Loop through all samples for this topic
-    for (int i = sampleNames.count() - 1; i >= 0; i--)
+    // Copy the new samples under one lock, so each row reads a single sample
+    // no matter how many arrive while the file is written
+    const uint64_t previous = m_sequence;
+    const std::vector<TopicSample> history = CommonData::copySlotsSince(m_topicName, m_sequence);
+
+    // The tracked members of the same samples, matched to the rows by sequence
+    const int memberCount = m_memberAccessors.count();
+    QVector<QVector<uint64_t>> trackedSequences(memberCount);
+    QVector<QStringList> trackedValues(memberCount);
+    QVector<int> trackedPositions(memberCount, 0);
+    for (int ii = 0; ii < memberCount; ii++)
     {
-        // Skip previously read samples
-        if (sampleNames.at(i) <= m_latestTimestamp)
-        {
-            continue;
-        }
+        readTrackedValues(ii, previous, trackedSequences[ii], trackedValues[ii]);
+    }
 
+    for (const TopicSample& slot : history)
+    {
         // Insert the timestamp
-        m_outputStream << sampleNames.at(i);
+        m_outputStream << CommonData::formatSampleTime(slot.sourceTime);
+
+        // Lazily stored samples are decoded once for all members, and only if
+        // a member isn't tracked
+        std::shared_ptr<OpenDynamicData> tree;
+        bool decoded = false;
 
         // Insert the values for each member variable
-        for (int ii = 0; ii < m_topicMembers.count(); ii++)
+        for (int ii = 0; ii < memberCount; ii++)
         {
-            QVariant memberValue = CommonData::readValue(
-                m_topicName,
-                m_topicMembers.at(ii),
-                i);
+            const QVector<uint64_t>& sequences = trackedSequences.at(ii);
+            int& position = trackedPositions[ii];
+            while (position < sequences.count() && sequences.at(position) < slot.sequence)
+            {
+                ++position;
+            }
+            if (position < sequences.count() && sequences.at(position) == slot.sequence)
+            {
+                m_outputStream << m_delimiter << trackedValues.at(ii).at(position);
+                continue;
+            }
+
+            // Samples stored before tracking started, or missing the member
+            QVariant memberValue;
+            if (m_memberAccessors.at(ii))
+            {
+                if (!decoded)
+                {
+                    tree = slot.sample;
+                    if (!tree && !slot.flat && slot.serialized)
+                    {
+                        tree = slot.serialized->decode();
+                    }
+                    decoded = true;
+                }
+                memberValue = CommonData::readValue(*m_memberAccessors.at(ii), slot, tree);
+            }
 
             m_outputStream << m_delimiter << memberValue.toString();
         }
@@ -242,32 +300,85 @@ void RecorderDialog::dumpData()
     // Force writing to the file
     m_outputStream.flush();
 
+    rowCountLabel->setText(QString::number(m_rowCount));
+
+} // End RecorderDialog::dumpData
+
 
-    // Update the timestamp to the latest sample
-    if (sampleNames.count() > 0)
+//------------------------------------------------------------------------------
+void RecorderDialog::untrackMembers()
+{
+    for (int i = 0; i < m_trackedMembers.count(); i++)
     {
-        m_latestTimestamp = sampleNames.at(0);
+        if (m_trackedMembers.at(i))
+        {
+            CommonData::untrackMember(m_topicName, m_topicMembers.at(i));
+        }
     }
+    m_trackedMembers.clear();
+}
 
 
-    // If midnight rolled by, reset the latest received sample time
-    QTime now = QTime::currentTime();
-    if (now.hour() == 0 &&
-        now.minute() == 0 &&
-        now.second() == 0 &&
-        m_latestTimestamp != "00:00:00.000")
+//------------------------------------------------------------------------------
+void RecorderDialog::readTrackedValues(int member,
+                                       uint64_t sequence,
+                                       QVector<uint64_t>& sequences,
+                                       QStringList& values) const
+{
+    sequences.clear();
+    values.clear();
+    if (member >= m_trackedMembers.count() || !m_trackedMembers.at(member))
     {
-        m_latestTimestamp = "00:00:00.000";
-
-        // Reset the samples, so we don't record samples from the previous day.
-        // Doing this isn't ideal, but it shouldn't happen unless someone is
-        // recording all night.
-        CommonData::flushSamples(m_topicName);
+        return;
     }
 
-    rowCountLabel->setText(QString::number(m_rowCount));
+    // Formatted like the QVariant of the sample value, so tracked and
+    // untracked rows look the same
+    const QString& memberName = m_topicMembers.at(member);
+    switch (m_columnTypes.at(member))
+    {
+    case ColumnType::Int64:
+    {
+        QVector<int64_t> numbers;
+        CommonData::readTrackedSince(m_topicName, memberName, sequence, sequences, numbers);
+        for (const int64_t number : numbers)
+        {
+            values.append(QString::number(static_cast<qlonglong>(number)));
+        }
+        break;
+    }
+    case ColumnType::UInt64:
+    {
+        QVector<uint64_t> numbers;
+        CommonData::readTrackedSince(m_topicName, memberName, sequence, sequences, numbers);
+        for (const uint64_t number : numbers)
+        {
+            values.append(QString::number(static_cast<qulonglong>(number)));
+        }
+        break;
+    }
+    case ColumnType::Float:
+    case ColumnType::Double:
+    {
+        QVector<double> numbers;
+        CommonData::readTrackedSince(m_topicName, memberName, sequence, sequences, numbers);
+        const bool single = (m_columnTypes.at(member) == ColumnType::Float);
+        for (const double number : numbers)
+        {
+            values.append(single ? QVariant(static_cast<float>(number)).toString()
+                                 : QVariant(number).toString());
+        }
+        break;
+    }
+    }
 
-} // End RecorderDialog::dumpData
+    // A failed read leaves no points to match
+    if (sequences.count() != values.count())
+    {
+        sequences.clear();
+        values.clear();
+    }
+}
 
 
 /**
@@ -3,13 +3,20 @@
 
 #include <QTextStream>
 #include <QStringList>
+#include <QVector>
 #include <QString>
 #include <QDialog>
 #include <QTimer>
 #include <QFile>
 
+#include <cstdint>
+#include <memory>
+
+#include "tracked_column.h"
 #include "ui_recorder_dialog.h"
 
+class MemberAccessor;
+
 
 /**
  * @brief The DDS data recorder dialog class.
@@ -71,6 +78,23 @@ private slots:
 
 private:
 
+    /**
+     * @brief Stop tracking the numeric members of the recording.
+     */
+    void untrackMembers();
+
+    /**
+     * @brief Format the tracked points of a member as text, keyed by sequence.
+     * @param[in] member The index of the member in m_topicMembers.
+     * @param[in] sequence The sequence of the newest sample already recorded.
+     * @param[out] sequences The sequence of the sample of each value.
+     * @param[out] values The formatted values.
+     */
+    void readTrackedValues(int member,
+                           uint64_t sequence,
+                           QVector<uint64_t>& sequences,
+                           QStringList& values) const;
+
     /// IDs for delimiter selections.
     enum eDelimiterTypeIDs
     {
@@ -82,11 +106,20 @@ private:
     /// Stores the topic member names to record.
     QStringList m_topicMembers;
 
+    /// The resolved member paths of m_topicMembers, in the same order.
+    QVector<std::shared_ptr<const MemberAccessor>> m_memberAccessors;
+
+    /// True for the members of m_topicMembers that are tracked while recording.
+    QVector<bool> m_trackedMembers;
+
+    /// The column type of each tracked member, in the order of m_topicMembers.
+    QVector<ColumnType> m_columnTypes;
+
     /// Stores the target topic member to record.
     QString m_topicName;
 
-    /// Record data after this timestamp.
-    QString m_latestTimestamp;
+    /// The sequence of the newest sample already recorded.
+    uint64_t m_sequence;
 
     /// Separate data rows with this delimiter.
     QString m_delimiter;
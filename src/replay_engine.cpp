@@ -0,0 +1,251 @@
+#include "replay_engine.h"
+#include "open_dynamic_data.h"
+#include "topic_replayer.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+
+/**
+ * @brief Get the time a stored sample is scheduled from.
+ * @param[in] slot The stored sample.
+ * @return The source time, or the reception time if the source time is unset.
+ */
+int64_t scheduleTime(const TopicSample& slot)
+{
+    return (slot.sourceTime != 0) ? slot.sourceTime : slot.receptionTime;
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+ReplayEngine::ReplayEngine(TopicReplayer& replayer)
+    : m_replayer(replayer)
+    , m_stopping(false)
+    , m_running(false)
+    , m_total(0)
+    , m_prepared(0)
+    , m_published(0)
+    , m_skipped(0)
+    , m_requestedRate(0.0)
+    , m_firstWriteTime(0)
+    , m_lastWriteTime(0)
+    , m_jitterSum(0)
+    , m_jitterMax(0)
+{}
+
+
+//------------------------------------------------------------------------------
+ReplayEngine::~ReplayEngine()
+{
+    stop();
+}
+
+
+//------------------------------------------------------------------------------
+void ReplayEngine::start(const std::shared_ptr<TopicSampleStore>& store,
+                         std::vector<TopicSample> slots,
+                         double rate)
+{
+    stop();
+
+    m_total = slots.size();
+    m_prepared = 0;
+    m_published = 0;
+    m_skipped = 0;
+    m_requestedRate = 0.0;
+    m_firstWriteTime = 0;
+    m_lastWriteTime = 0;
+    m_jitterSum = 0;
+    m_jitterMax = 0;
+    m_stopping = false;
+    m_running = true;
+
+    if (rate > 0.0)
+    {
+        rate = (rate < MIN_RATE) ? MIN_RATE : (rate > MAX_RATE) ? MAX_RATE : rate;
+    }
+
+    m_thread = std::thread(&ReplayEngine::run, this, store, std::move(slots), rate);
+}
+
+
+//------------------------------------------------------------------------------
+void ReplayEngine::stop()
+{
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_all();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+ReplayStats ReplayEngine::stats() const
+{
+    ReplayStats stats;
+    stats.total = m_total;
+    stats.prepared = m_prepared;
+    stats.published = m_published;
+    stats.skipped = m_skipped;
+    stats.running = m_running;
+    stats.requestedRate = m_requestedRate;
+
+    // The rate between the first and the latest write
+    const int64_t span = m_lastWriteTime - m_firstWriteTime;
+    if (stats.published > 1 && span > 0)
+    {
+        stats.achievedRate = (stats.published - 1) * 1.0e9 / span;
+    }
+
+    if (stats.published > 0)
+    {
+        stats.meanJitter = m_jitterSum / static_cast<int64_t>(stats.published);
+    }
+    stats.maxJitter = m_jitterMax;
+    return stats;
+}
+
+
+//------------------------------------------------------------------------------
+void ReplayEngine::run(std::shared_ptr<TopicSampleStore> store,
+                       std::vector<TopicSample> slots,
+                       double rate)
+{
+    // Serialize everything up front, so the timed loop only writes
+    std::vector<ScheduledBlock> blocks;
+    blocks.reserve(slots.size());
+    int64_t previousTime = slots.empty() ? 0 : scheduleTime(slots.front());
+    int64_t offset = 0;
+    for (const TopicSample& slot : slots)
+    {
+        if (m_stopping)
+        {
+            break;
+        }
+
+        // Out of order source times publish back to back
+        const int64_t time = scheduleTime(slot);
+        offset += std::max<int64_t>(time - previousTime, 0);
+        previousTime = std::max(previousTime, time);
+
+        const std::shared_ptr<OpenDynamicData> sample = store->sample(slot);
+        OpenDDS::DCPS::Message_Block_Ptr block;
+        if (sample)
+        {
+            block = m_replayer.serializeSample(sample);
+        }
+
+        if (!block)
+        {
+            ++m_skipped;
+            continue;
+        }
+
+        const int64_t scaled = (rate > 0.0) ? static_cast<int64_t>(offset / rate) : 0;
+        blocks.push_back(ScheduledBlock{scaled, std::move(block)});
+        ++m_prepared;
+    }
+
+    // The slots may reference samples that are no longer needed
+    slots.clear();
+    slots.shrink_to_fit();
+
+    if (rate > 0.0 && blocks.size() > 1 && blocks.back().offset > 0)
+    {
+        m_requestedRate = (blocks.size() - 1) * 1.0e9 / blocks.back().offset;
+    }
+
+    const int64_t startTime = steadyTimeNanoseconds();
+    for (ScheduledBlock& scheduled : blocks)
+    {
+        if (m_stopping)
+        {
+            break;
+        }
+
+        int64_t writeTime = 0;
+        if (rate > 0.0)
+        {
+            const int64_t target = startTime + scheduled.offset;
+            writeTime = waitUntil(target);
+            if (m_stopping)
+            {
+                break;
+            }
+
+            const int64_t lateness = std::max<int64_t>(writeTime - target, 0);
+            m_jitterSum += lateness;
+            if (lateness > m_jitterMax)
+            {
+                m_jitterMax = lateness;
+            }
+        }
+        else
+        {
+            writeTime = steadyTimeNanoseconds();
+        }
+
+        m_replayer.publishSerialized(scheduled.block.get());
+
+        // Released right away, so the block pool can reuse it
+        scheduled.block.reset();
+
+        if (m_published == 0)
+        {
+            m_firstWriteTime = writeTime;
+        }
+        m_lastWriteTime = writeTime;
+        ++m_published;
+    }
+
+    m_running = false;
+}
+
+
+//------------------------------------------------------------------------------
+int64_t ReplayEngine::waitUntil(int64_t target)
+{
+    int64_t now = steadyTimeNanoseconds();
+
+    // Sleep through most of the wait; stop() cuts it short
+    if (target - now > SPIN_NANOSECONDS)
+    {
+        const std::chrono::steady_clock::time_point wakeTime(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::nanoseconds(target - SPIN_NANOSECONDS)));
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_wakeup.wait_until(locker, wakeTime, [this] { return m_stopping.load(); });
+    }
+
+    // Spin for the rest, since a sleep can't wake up that precisely
+    now = steadyTimeNanoseconds();
+    while (now < target && !m_stopping)
+    {
+        std::this_thread::yield();
+        now = steadyTimeNanoseconds();
+    }
+    return now;
+}
+
+
+//------------------------------------------------------------------------------
+int64_t ReplayEngine::steadyTimeNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+ * @}
+ */
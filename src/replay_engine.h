@@ -0,0 +1,205 @@
+#ifndef __REPLAY_ENGINE_H__
+#define __REPLAY_ENGINE_H__
+
+#include "topic_sample_store.h"
+
+#ifdef WIN32
+#pragma warning(push, 0)  //No DDS warnings
+#endif
+
+#include <dds/DCPS/Message_Block_Ptr.h>
+
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TopicReplayer;
+
+
+/**
+ * @brief A snapshot of a running or finished replay.
+ */
+struct ReplayStats
+{
+    /// The number of samples to publish.
+    size_t total = 0;
+
+    /// The number of samples serialized so far.
+    size_t prepared = 0;
+
+    /// The number of samples published so far.
+    size_t published = 0;
+
+    /// The number of samples that could not be serialized.
+    size_t skipped = 0;
+
+    /// True while samples are serialized or published.
+    bool running = false;
+
+    /// The rate the schedule asks for in samples per second, or 0 when
+    /// publishing as fast as possible.
+    double requestedRate = 0.0;
+
+    /// The rate achieved so far in samples per second.
+    double achievedRate = 0.0;
+
+    /// The average time a write started after its scheduled time, in nanoseconds.
+    int64_t meanJitter = 0;
+
+    /// The largest time a write started after its scheduled time, in nanoseconds.
+    int64_t maxJitter = 0;
+};
+
+
+/**
+ * @brief Republishes a sequence of stored samples of one topic.
+ * @details All samples are serialized before the first write, so the timed
+ *          part only publishes ready blocks. A dedicated thread sleeps until
+ *          shortly before each write and spins for the rest, which keeps the
+ *          writes close to the recorded inter-sample timing even at high
+ *          rates. The timing follows the source times of the samples,
+ *          or the reception times where no source time was set, scaled by
+ *          a rate multiplier.
+ */
+class ReplayEngine
+{
+public:
+
+    /**
+     * @brief Constructor for the replay engine.
+     * @param[in] replayer Publishes the samples. Must outlive the engine.
+     */
+    explicit ReplayEngine(TopicReplayer& replayer);
+
+    /**
+     * @brief Destructor for the replay engine. Stops a running replay.
+     */
+    ~ReplayEngine();
+
+    /**
+     * @brief Start replaying samples, stopping any running replay first.
+     * @param[in] store The store the slots were copied from.
+     * @param[in] slots The samples to publish, oldest first.
+     * @param[in] rate The speed relative to the recorded timing, from
+     *            MIN_RATE to MAX_RATE, or 0 to publish as fast as possible.
+     */
+    void start(const std::shared_ptr<TopicSampleStore>& store,
+               std::vector<TopicSample> slots,
+               double rate);
+
+    /**
+     * @brief Stop a running replay. Samples not published yet are dropped.
+     */
+    void stop();
+
+    /**
+     * @brief Get the progress and timing of the current or last replay.
+     * @return The replay statistics.
+     */
+    ReplayStats stats() const;
+
+    /// The slowest rate multiplier.
+    static constexpr double MIN_RATE = 0.1;
+
+    /// The fastest rate multiplier.
+    static constexpr double MAX_RATE = 100.0;
+
+private:
+
+    /// A serialized sample and when to publish it.
+    struct ScheduledBlock
+    {
+        /// The offset from the first sample in nanoseconds, already scaled.
+        int64_t offset;
+
+        /// The encapsulated sample.
+        OpenDDS::DCPS::Message_Block_Ptr block;
+    };
+
+    /**
+     * @brief The replay thread. Serializes, then publishes on schedule.
+     * @param[in] store The store the slots were copied from.
+     * @param[in] slots The samples to publish, oldest first.
+     * @param[in] rate The rate multiplier, or 0 for as fast as possible.
+     */
+    void run(std::shared_ptr<TopicSampleStore> store,
+             std::vector<TopicSample> slots,
+             double rate);
+
+    /**
+     * @brief Wait until a steady clock time or until stopped.
+     * @param[in] target The steady clock time in nanoseconds.
+     * @return The steady clock time when the wait ended.
+     */
+    int64_t waitUntil(int64_t target);
+
+    /**
+     * @brief Get the current steady clock time.
+     * @return The time in nanoseconds.
+     */
+    static int64_t steadyTimeNanoseconds();
+
+    /// The remaining time of a wait that is spun instead of slept, in
+    /// nanoseconds. Covers the wakeup latency of the operating system.
+    static const int64_t SPIN_NANOSECONDS = 200000;
+
+    /// Publishes the samples.
+    TopicReplayer& m_replayer;
+
+    /// The replay thread.
+    std::thread m_thread;
+
+    /// Protects m_stopping for the wait condition.
+    std::mutex m_mutex;
+
+    /// Wakes the replay thread when it is asked to stop.
+    std::condition_variable m_wakeup;
+
+    /// True while the replay thread is asked to exit.
+    std::atomic<bool> m_stopping;
+
+    /// True while samples are serialized or published.
+    std::atomic<bool> m_running;
+
+    /// The number of samples to publish.
+    std::atomic<size_t> m_total;
+
+    /// The number of samples serialized.
+    std::atomic<size_t> m_prepared;
+
+    /// The number of samples published.
+    std::atomic<size_t> m_published;
+
+    /// The number of samples that could not be serialized.
+    std::atomic<size_t> m_skipped;
+
+    /// The rate the schedule asks for, in samples per second.
+    std::atomic<double> m_requestedRate;
+
+    /// The steady clock time of the first write in nanoseconds.
+    std::atomic<int64_t> m_firstWriteTime;
+
+    /// The steady clock time of the latest write in nanoseconds.
+    std::atomic<int64_t> m_lastWriteTime;
+
+    /// The sum of the lateness of the timed writes in nanoseconds.
+    std::atomic<int64_t> m_jitterSum;
+
+    /// The largest lateness of a timed write in nanoseconds.
+    std::atomic<int64_t> m_jitterMax;
+
+}; // End class ReplayEngine
+
+#endif
+
+/**
+ * @}
+ */
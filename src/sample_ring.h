@@ -0,0 +1,190 @@
+#ifndef __SAMPLE_RING_H__
+#define __SAMPLE_RING_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+/**
+ * @brief Fixed-capacity circular history of DDS samples for one topic.
+ * @details The storage grows geometrically as samples arrive, up to the
+ *          capacity, so a large capacity costs nothing until it is used.
+ *          Inserting a sample overwrites the oldest slot once the ring is
+ *          full, so inserts are amortized O(1) and indexed reads are O(1).
+ *          Index 0 is always the newest sample, matching the indexing used
+ *          by CommonData.
+ * @remarks This class is not thread safe. The owner must serialize access.
+ */
+template<typename T>
+class SampleRing
+{
+public:
+
+    /**
+     * @brief Constructor for the sample ring.
+     * @param[in] capacity The maximum number of samples to keep.
+     */
+    explicit SampleRing(size_t capacity = 0)
+        : m_capacity(capacity)
+        , m_head(0)
+        , m_count(0)
+    {}
+
+    /**
+     * @brief Store a new sample, replacing the oldest one if the ring is full.
+     * @param[in] sample The data sample and its metadata.
+     * @return The sample that was evicted, or a default value if none was.
+     *         Returning it lets the caller release it outside of its lock.
+     */
+    T push(const T& sample)
+    {
+        if (m_capacity == 0)
+        {
+            return T();
+        }
+
+        if (m_count == m_entries.size() && m_entries.size() < m_capacity)
+        {
+            grow();
+        }
+
+        const size_t slots = m_entries.size();
+        m_head = (m_count == 0) ? 0 : (m_head + 1) % slots;
+        T& slot = m_entries[m_head];
+
+        T evicted = std::move(slot);
+        slot = sample;
+
+        if (m_count < slots)
+        {
+            ++m_count;
+        }
+
+        return evicted;
+    }
+
+    /**
+     * @brief Remove the oldest sample.
+     * @return The sample that was removed, or a default value if empty.
+     */
+    T popOldest()
+    {
+        if (m_count == 0)
+        {
+            return T();
+        }
+
+        const size_t slots = m_entries.size();
+        T& slot = m_entries[(m_head + slots - (m_count - 1)) % slots];
+
+        T evicted = std::move(slot);
+        slot = T();
+        --m_count;
+
+        return evicted;
+    }
+
+    /**
+     * @brief Get a stored sample.
+     * @param[in] index The sample index. 0 is the newest.
+     * @return The stored sample. The index must be less than size().
+     */
+    const T& at(size_t index) const
+    {
+        const size_t slots = m_entries.size();
+        return m_entries[(m_head + slots - index) % slots];
+    }
+
+    /**
+     * @brief Get the number of stored samples.
+     * @return The number of stored samples.
+     */
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    /**
+     * @brief Get the maximum number of samples this ring can hold.
+     * @return The capacity of the ring.
+     */
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /**
+     * @brief Get the number of slots allocated so far.
+     * @return The allocated slot count. Never more than capacity().
+     */
+    size_t allocated() const
+    {
+        return m_entries.size();
+    }
+
+    /**
+     * @brief Remove all samples in place. The capacity is unchanged.
+     */
+    void clear()
+    {
+        m_entries.clear();
+        m_head = 0;
+        m_count = 0;
+    }
+
+    /**
+     * @brief Remove all samples in place and hand their storage to the caller.
+     * @details Lets the owner free the samples after leaving its lock.
+     * @param[out] released Receives the storage of the removed samples.
+     */
+    void clear(std::vector<T>& released)
+    {
+        released.clear();
+        std::swap(m_entries, released);
+        m_head = 0;
+        m_count = 0;
+    }
+
+private:
+
+    /**
+     * @brief Enlarge the full storage, moving the samples oldest first.
+     */
+    void grow()
+    {
+        // Start small and double, so the growth cost is amortized
+        const size_t minSlots = 16;
+        const size_t slots = std::min(m_capacity, std::max(minSlots, m_entries.size() * 2));
+
+        std::vector<T> entries(slots);
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            entries[i] = std::move(m_entries[(m_head + m_entries.size() - (m_count - 1 - i)) %
+                                             m_entries.size()]);
+        }
+
+        std::swap(m_entries, entries);
+        m_head = (m_count == 0) ? 0 : m_count - 1;
+    }
+
+    /// Storage for the samples. Grows up to m_capacity slots.
+    std::vector<T> m_entries;
+
+    /// The maximum number of samples to keep.
+    size_t m_capacity;
+
+    /// The slot holding the newest sample.
+    size_t m_head;
+
+    /// The number of valid samples in the ring.
+    size_t m_count;
+
+}; // End class SampleRing
+
+#endif
+
+/**
+ * @}
+ */
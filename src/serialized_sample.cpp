@@ -0,0 +1,98 @@
+#include "serialized_sample.h"
+#include "open_dynamic_data.h"
+#include "decode_plan.h"
+#include "flat_sample.h"
+
+#include <iostream>
+
+
+namespace
+{
+
+/// Remove the delimiter header of the topic type, if the encoding has one.
+bool readRootDelimiter(OpenDDS::DCPS::Serializer& serial, const DecodePlan& plan)
+{
+    if (plan.encodingKind() == OpenDDS::DCPS::Encoding::KIND_XCDR1)
+    {
+        return true;
+    }
+
+    uint32_t delim_header = 0;
+    if (!(serial >> delim_header))
+    {
+        std::cerr << "SerializedSample::decode: Could not read stream delimiter" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+SerializedSample::SerializedSample(const ACE_Message_Block& payload,
+                                   const std::shared_ptr<const DecodePlan>& plan,
+                                   OpenDDS::DCPS::Endianness endianness)
+    : m_payload(new ACE_Message_Block(payload.total_length()))
+    , m_plan(plan)
+    , m_endianness(endianness)
+{
+    // Copy only the readable bytes. Holding a duplicate instead would keep the
+    // whole transport receive buffer alive for as long as the sample is stored.
+    for (const ACE_Message_Block* block = &payload; block; block = block->cont())
+    {
+        m_payload->copy(block->rd_ptr(), block->length());
+    }
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> SerializedSample::decode() const
+{
+    // Decode from a duplicate so the stored read pointer never moves
+    OpenDDS::DCPS::Message_Block_Ptr payload(m_payload->duplicate());
+    return decode(payload.get(), *m_plan, m_endianness);
+}
+
+
+//------------------------------------------------------------------------------
+size_t SerializedSample::size() const
+{
+    return sizeof(SerializedSample) + sizeof(ACE_Message_Block) + m_payload->capacity();
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> SerializedSample::decode(ACE_Message_Block* payload,
+                                                          const DecodePlan& plan,
+                                                          OpenDDS::DCPS::Endianness endianness)
+{
+    OpenDDS::DCPS::Serializer serial(payload, plan.encodingKind(), endianness);
+    if (!readRootDelimiter(serial, plan))
+    {
+        return std::shared_ptr<OpenDynamicData>();
+    }
+
+    return plan.decode(serial);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<FlatSample> SerializedSample::decodeFlat(ACE_Message_Block* payload,
+                                                         const DecodePlan& plan,
+                                                         const std::shared_ptr<FlatSamplePool>& pool,
+                                                         OpenDDS::DCPS::Endianness endianness)
+{
+    OpenDDS::DCPS::Serializer serial(payload, plan.encodingKind(), endianness);
+    if (!readRootDelimiter(serial, plan))
+    {
+        return std::shared_ptr<FlatSample>();
+    }
+
+    return plan.decodeFlat(serial, pool);
+}
+
+
+/**
+ * @}
+ */
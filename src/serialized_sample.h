@@ -0,0 +1,100 @@
+#ifndef __SERIALIZED_SAMPLE_H__
+#define __SERIALIZED_SAMPLE_H__
+
+#ifdef WIN32
+#pragma warning(push, 0)  //No DDS warnings
+#endif
+
+#include <dds/DCPS/Message_Block_Ptr.h>
+#include <dds/DCPS/Serializer.h>
+
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+#include <memory>
+
+class OpenDynamicData;
+class DecodePlan;
+class FlatSample;
+class FlatSamplePool;
+
+
+/**
+ * @brief A received TypeCode sample kept in its serialized form.
+ * @details Holds a compact copy of the CDR payload and everything needed to
+ *          decode it later, so samples nobody looks at are never decoded.
+ *          Decoding does not modify this object, so several readers may
+ *          decode the same sample concurrently.
+ */
+class SerializedSample
+{
+public:
+
+    /**
+     * @brief Constructor for the serialized sample.
+     * @param[in] payload The CDR payload, positioned after the encapsulation
+     *            header. The readable bytes are copied.
+     * @param[in] plan The decode plan of the sample type and encoding.
+     * @param[in] endianness The byte order of the payload.
+     */
+    SerializedSample(const ACE_Message_Block& payload,
+                     const std::shared_ptr<const DecodePlan>& plan,
+                     OpenDDS::DCPS::Endianness endianness);
+
+    /**
+     * @brief Decode the payload into a new sample.
+     * @return The decoded sample or nullptr if the payload is malformed.
+     */
+    std::shared_ptr<OpenDynamicData> decode() const;
+
+    /**
+     * @brief Get the memory held by this object.
+     * @return The size in bytes.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Decode a CDR payload into a new sample.
+     * @param[in] payload The CDR payload, positioned after the encapsulation
+     *            header. The read pointer is advanced.
+     * @param[in] plan The decode plan of the sample type and encoding.
+     * @param[in] endianness The byte order of the payload.
+     * @return The decoded sample or nullptr if the payload is malformed.
+     */
+    static std::shared_ptr<OpenDynamicData> decode(ACE_Message_Block* payload,
+                                                   const DecodePlan& plan,
+                                                   OpenDDS::DCPS::Endianness endianness);
+
+    /**
+     * @brief Decode a CDR payload into a new flat sample.
+     * @param[in] payload The CDR payload, positioned after the encapsulation
+     *            header. The read pointer is advanced.
+     * @param[in] plan The decode plan of the sample type and encoding.
+     * @param[in] pool Provides the sample buffers. May be nullptr.
+     * @param[in] endianness The byte order of the payload.
+     * @return The decoded sample or nullptr if the payload is malformed.
+     */
+    static std::shared_ptr<FlatSample> decodeFlat(ACE_Message_Block* payload,
+                                                  const DecodePlan& plan,
+                                                  const std::shared_ptr<FlatSamplePool>& pool,
+                                                  OpenDDS::DCPS::Endianness endianness);
+
+private:
+
+    /// The copied CDR payload.
+    OpenDDS::DCPS::Message_Block_Ptr m_payload;
+
+    /// The decode plan of the sample type. Shared by all samples of a topic.
+    std::shared_ptr<const DecodePlan> m_plan;
+
+    /// The byte order of the payload.
+    const OpenDDS::DCPS::Endianness m_endianness;
+
+}; // End class SerializedSample
+
+#endif
+
+/**
+ * @}
+ */
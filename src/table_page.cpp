@@ -1,16 +1,22 @@
 #include "table_page.h"
+#include "history_table_model.h"
 #include "dds_manager.h"
 #include "dynamic_meta_struct.h"
 #include "open_dynamic_data.h"
 #include "topic_table_model.h"
+#include "topic_tree_model.h"
 #include "recorder_dialog.h"
+#include "replay_engine.h"
 #include "topic_replayer.h"
 #include "topic_monitor.h"
 #include "dds_data.h"
 #include "graph_page.h"
+#include "waterfall_page.h"
 #include "qos_dictionary.h"
 
 #include <QMessageBox>
+#include <QRegularExpression>
+#include <QSettings>
 
 #include <iostream>
 #include <exception>
@@ -20,6 +26,7 @@
 TablePage::TablePage(const QString& topicName, QWidget *parent) :
     QWidget(parent),
     m_topicName(topicName),
+    m_selectedSequence(0),
     m_refreshTimer(this)
 {
     setupUi(this);
@@ -32,14 +39,27 @@ TablePage::TablePage(const QString& topicName, QWidget *parent) :
     attachPlotButton->setEnabled(false);
     recordButton->setEnabled(false);
 
+    // The history follows the sample store of this topic
+    m_historyModel = std::make_unique<HistoryTableModel>(m_topicName, historyTable);
+    historyTable->setModel(m_historyModel.get());
+    connect(historyTable->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)),
+            this, SLOT(historySelectionChanged()));
+
     // Create a data model for this topic
     m_tableModel = std::make_unique<TopicTableModel>(topicTableView, m_topicName);
     topicTableView->setModel(m_tableModel.get());
     connect(m_tableModel.get(), SIGNAL(dataHasChanged()), this, SLOT(dataHasChanged()));
 
+    // The tree shows the same sample and is only filled while it is visible
+    m_treeModel = std::make_unique<TopicTreeModel>(topicTreeView);
+    topicTreeView->setModel(m_treeModel.get());
+    topicTreeView->hide();
+
     // Create a topic monitor to receive the data samples
     m_topicMonitor = std::make_unique<TopicMonitor>(topicName);
     m_topicReplayer = std::make_unique<TopicReplayer>(topicName);
+    m_replayEngine = std::make_unique<ReplayEngine>(*m_topicReplayer);
+    replayLabel->hide();
 
     connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(refreshPage()));
     m_refreshTimer.start(REFRESH_TIMEOUT);
@@ -69,6 +89,7 @@ void TablePage::on_clearSamplesButton_clicked()
           QosDictionary::getEncodingKind(), topicInfo->extensibility());
         CommonData::flushSamples(m_topicName);
         m_tableModel->setSample(blankSample);
+        m_treeModel->setSample(blankSample);
     }
     else
     {
@@ -204,21 +225,96 @@ void TablePage::on_filterButton_clicked()
 
 
 //------------------------------------------------------------------------------
-void TablePage::on_useLatestButton_clicked()
+void TablePage::on_historyButton_clicked()
 {
-    // Use the latest sample if the button is checked
-    if (useLatestButton->isChecked() && historyTable->rowCount() > 1)
+    bool ok = false;
+    const int depth = QInputDialog::getInt(
+        this,
+        "History Depth",
+        "Number of samples to keep for " + m_topicName + ":",
+        CommonData::historyDepth(m_topicName),
+        1,
+        CommonData::MAX_HISTORY_DEPTH,
+        1,
+        &ok);
+
+    if (!ok)
     {
-        QTableWidgetItem* item = historyTable->item(0, 0);
-        if (item)
+        return;
+    }
+
+    CommonData::setHistoryDepth(m_topicName, depth);
+
+    QSettings settings(SETTINGS_ORG_NAME, SETTINGS_APP_NAME);
+    settings.setValue("historyDepth/" + m_topicName, depth);
+
+    refreshPage();
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_ingestButton_clicked()
+{
+    IngestPolicy policy = CommonData::ingestPolicy(m_topicName);
+
+    QStringList modes;
+    modes << "Drop newest"
+          << "Drop oldest"
+          << "Decimate";
+
+    bool ok = false;
+    const QString mode = QInputDialog::getItem(
+        this,
+        "Overload Policy",
+        "Samples to discard when " + m_topicName + " can't keep up:",
+        modes,
+        static_cast<int>(policy.mode),
+        false,
+        &ok);
+
+    if (!ok)
+    {
+        return;
+    }
+
+    policy.mode = static_cast<IngestMode>(modes.indexOf(mode));
+    if (policy.mode == IngestMode::Decimate)
+    {
+        policy.rate = QInputDialog::getDouble(
+            this,
+            "Overload Policy",
+            "Maximum samples per second for " + m_topicName + ":",
+            policy.rate > 0.0 ? policy.rate : 10.0,
+            0.001,
+            1000000.0,
+            3,
+            &ok);
+
+        if (!ok)
         {
-            historyTable->clearSelection();
-            historyTable->setCurrentItem(item);
-            item->setSelected(true);
-            setSample(item->text());
+            return;
         }
     }
 
+    CommonData::setIngestPolicy(m_topicName, policy);
+    m_topicMonitor->setIngestPolicy(policy);
+
+    QSettings settings(SETTINGS_ORG_NAME, SETTINGS_APP_NAME);
+    settings.setValue("ingestPolicy/" + m_topicName, policy.toString());
+
+    refreshPage();
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_useLatestButton_clicked()
+{
+    // Use the latest sample if the button is checked
+    if (useLatestButton->isChecked())
+    {
+        selectLatest();
+    }
+
     refreshPage();
 }
 
@@ -326,37 +422,78 @@ void TablePage::on_publishButton_clicked()
 
 
 //------------------------------------------------------------------------------
-void TablePage::on_historyTable_itemSelectionChanged()
+void TablePage::on_replayButton_clicked()
 {
-    QList<QTableWidgetItem*> items = historyTable->selectedItems();
-    for (int i = 0; i < items.count(); ++i)
+    if (!replayButton->isChecked())
     {
-        QTableWidgetItem* selectedItem = items.at(i);
-        if (selectedItem->row() != 0)
-        {
-            useLatestButton->setChecked(false);
-        }
+        m_replayEngine->stop();
+        return;
+    }
 
-        setSample(selectedItem->text());
+    std::shared_ptr<TopicInfo> topicInfo = CommonData::getTopicInfo(m_topicName);
+    const std::shared_ptr<TopicSampleStore> store = CommonData::getSampleStore(m_topicName);
+    if (!topicInfo || !store)
+    {
+        replayButton->setChecked(false);
+        return;
     }
+
+    if (topicInfo->typeMode() != TypeDiscoveryMode::TypeCode)
+    {
+        replayButton->setChecked(false);
+
+        QMessageBox msgBox;
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setText("TablePage::on_replayButton_clicked: Not supported for dynamic type");
+        msgBox.exec();
+        return;
+    }
+
+    bool ok = false;
+    const double rate = QInputDialog::getDouble(
+        this,
+        "Replay History",
+        "Speed relative to the original publication timing, from " +
+            QString::number(ReplayEngine::MIN_RATE) + " to " +
+            QString::number(ReplayEngine::MAX_RATE) + "\n"
+            "(0 publishes as fast as possible):",
+        1.0,
+        0.0,
+        ReplayEngine::MAX_RATE,
+        1,
+        &ok);
+
+    if (!ok)
+    {
+        replayButton->setChecked(false);
+        return;
+    }
+
+    m_replayEngine->start(store, store->copySlotsSince(0), rate);
+    replayLabel->show();
 }
 
 
 //------------------------------------------------------------------------------
-void TablePage::on_newPlotButton_clicked()
+void TablePage::historySelectionChanged()
 {
-    QItemSelectionModel* selectionModel = topicTableView->selectionModel();
-    QModelIndexList indexList = selectionModel->selectedIndexes();
-    QStringList selectedVariables;
-
-    // Populate the list of variables we want to plot
-    for (int i = 0; i < indexList.size(); ++i)
+    const QModelIndexList rows = historyTable->selectionModel()->selectedRows();
+    for (int i = 0; i < rows.count(); ++i)
     {
-        if (indexList.at(i).column() == TopicTableModel::NAME_COLUMN)
+        if (rows.at(i).row() != 0)
         {
-            selectedVariables << indexList.at(i).data(Qt::DisplayRole).toString();
+            useLatestButton->setChecked(false);
         }
+
+        setSample(rows.at(i).row());
     }
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_newPlotButton_clicked()
+{
+    const QStringList selectedVariables = selectedMembers();
 
     // If nothing was selected, don't create the plot page
     if (selectedVariables.isEmpty())
@@ -409,21 +546,10 @@ void TablePage::on_newPlotButton_clicked()
 //------------------------------------------------------------------------------
 void TablePage::on_attachPlotButton_clicked()
 {
-    QItemSelectionModel* selectionModel = topicTableView->selectionModel();
-    QModelIndexList indexList = selectionModel->selectedIndexes();
+    const QStringList selectedVariables = selectedMembers();
     QMap<QString, GraphPage*> graphPages;
-    QStringList selectedVariables;
     QStringList graphNames;
 
-    // Populate the list of variables we want to plot
-    for (int i = 0; i < indexList.size(); ++i)
-    {
-        if (indexList.at(i).column() == TopicTableModel::NAME_COLUMN)
-        {
-            selectedVariables << indexList.at(i).data(Qt::DisplayRole).toString();
-        }
-    }
-
     // If nothing was selected, don't create the plot page
     if (selectedVariables.isEmpty())
     {
@@ -496,21 +622,75 @@ void TablePage::on_attachPlotButton_clicked()
 
 
 //------------------------------------------------------------------------------
-void TablePage::on_recordButton_clicked()
+void TablePage::on_waterfallButton_clicked()
 {
-    QItemSelectionModel* selectionModel = topicTableView->selectionModel();
-    QModelIndexList indexList = selectionModel->selectedIndexes();
-    QStringList selectedVariables;
+    const QStringList selectedVariables = selectedMembers();
+    const QRegularExpression elementPattern("^(.+)\\[\\d+\\]$");
+    QString arrayName;
+
+    // In the tree the array or sequence itself can be selected
+    if (treeButton->isChecked())
+    {
+        const QModelIndexList rows =
+            topicTreeView->selectionModel()->selectedRows(TopicTreeModel::TYPE_COLUMN);
+        if (rows.size() == 1 &&
+            (rows.at(0).data().toString() == "sequence" ||
+             rows.at(0).data().toString() == "array"))
+        {
+            arrayName = rows.at(0).data(TopicTreeModel::FULL_NAME_ROLE).toString();
+        }
+    }
 
-    // Populate the list of variables we want to plot
-    for (int i = 0; i < indexList.size(); ++i)
+    // Every selected row must be an element of the same array or sequence
+    for (int i = 0; i < selectedVariables.size(); ++i)
     {
-        if (indexList.at(i).column() == TopicTableModel::NAME_COLUMN)
+        const QString& name = selectedVariables.at(i);
+        const QRegularExpressionMatch match = elementPattern.match(name);
+        if (!match.hasMatch() ||
+            (!arrayName.isEmpty() && match.captured(1) != arrayName))
         {
-            selectedVariables << indexList.at(i).data(Qt::DisplayRole).toString();
+            QMessageBox msgBox;
+            msgBox.setIcon(QMessageBox::Warning);
+            msgBox.setText("Select the elements of one array or sequence member.");
+            msgBox.exec();
+            return;
         }
+        arrayName = match.captured(1);
     }
 
+    // If nothing was selected, don't create the waterfall page
+    if (arrayName.isEmpty())
+    {
+        return;
+    }
+
+    QDialog *waterfallDialog = new QDialog(this);
+    QVBoxLayout *layout = new QVBoxLayout(waterfallDialog);
+    WaterfallPage *waterfallPage = new WaterfallPage(m_topicName, arrayName, waterfallDialog);
+
+    waterfallDialog->setAttribute(Qt::WA_DeleteOnClose);
+    waterfallDialog->setObjectName("waterfallDialog");
+    waterfallDialog->setWindowFlags(
+        Qt::CustomizeWindowHint |
+        Qt::WindowTitleHint |
+        Qt::Window |
+        Qt::WindowCloseButtonHint);
+
+    layout->addWidget(waterfallPage);
+    waterfallDialog->setWindowTitle("DDS Waterfall " + arrayName + " [" + m_topicName + "]");
+    waterfallDialog->setWindowIcon(QIcon(":/images/monitor.png"));
+    waterfallDialog->setSizeGripEnabled(true);
+    waterfallDialog->setLayout(layout);
+    waterfallDialog->resize(700, 500);
+    waterfallDialog->show();
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::on_recordButton_clicked()
+{
+    const QStringList selectedVariables = selectedMembers();
+
     // If nothing was selected, don't create the plot page
     if (selectedVariables.isEmpty())
     {
@@ -542,6 +722,35 @@ void TablePage::on_asciiButton_clicked() {
     m_tableModel->updateDisplayAscii(asciiButton->isChecked());
 }
 
+//------------------------------------------------------------------------------
+void TablePage::on_treeButton_clicked()
+{
+    std::shared_ptr<TopicInfo> topicInfo = CommonData::getTopicInfo(m_topicName);
+    if (treeButton->isChecked() &&
+        (!topicInfo || topicInfo->typeMode() != TypeDiscoveryMode::TypeCode))
+    {
+        treeButton->setChecked(false);
+
+        QMessageBox msgBox;
+        msgBox.setIcon(QMessageBox::Warning);
+        msgBox.setText("TablePage::on_treeButton_clicked: Not supported for dynamic type");
+        msgBox.exec();
+        return;
+    }
+
+    // Editing and the display options only apply to the table
+    const bool showTree = treeButton->isChecked();
+    topicTableView->setVisible(!showTree);
+    topicTreeView->setVisible(showTree);
+    iniButton->setEnabled(!showTree);
+    publishButton->setEnabled(!showTree);
+    hexButton->setEnabled(!showTree);
+    asciiButton->setEnabled(!showTree);
+
+    // Only the visible model follows the samples, so catch up the new one
+    setSample(m_historyModel->rowOf(m_selectedSequence));
+}
+
 
 //------------------------------------------------------------------------------
 void TablePage::dataHasChanged()
@@ -576,9 +785,7 @@ void TablePage::refreshPage()
 
 
     // Disable the plot buttons if we don't have a valid selection
-    QItemSelectionModel* selectionModel = topicTableView->selectionModel();
-    QModelIndexList indexList = selectionModel->selectedIndexes();
-    if (indexList.isEmpty())
+    if (selectedMembers().isEmpty())
     {
         newPlotButton->setEnabled(false);
         attachPlotButton->setEnabled(false);
@@ -592,58 +799,97 @@ void TablePage::refreshPage()
     }
 
 
-    // Don't repopulate the history widget is nothing changed
-    QStringList sampleNames = CommonData::getSampleList(m_topicName);
-    if (m_historyList == sampleNames)
+    // Show how much of the topic the filter lets through
+    const QString filter = m_topicMonitor->getFilter();
+    if (filter.isEmpty())
     {
-        return;
+        filterButton->setToolTip("Set filter");
     }
-
-    m_historyList = sampleNames;
-    historyTable->clearContents();
-    historyTable->setRowCount(sampleNames.size());
-    for (int i = 0; i < sampleNames.size(); ++i)
+    else
     {
-        QTableWidgetItem* item = new QTableWidgetItem;
-        item->setText(sampleNames.at(i));
-        historyTable->setItem(i, 0, item);
-
-        if (item->text() == m_selectedSample && !useLatestButton->isChecked())
+        filterButton->setToolTip("Filter: " + filter + "\n" +
+                                 "Passed: " + QString::number(m_topicMonitor->passedCount()) + "\n" +
+                                 "Rejected: " + QString::number(m_topicMonitor->rejectedCount()));
+    }
+
+    // Show how far the decode workers are behind and what was discarded
+    const DecodeQueueStats stats = m_topicMonitor->decodeStats();
+    pipelineLabel->setText(QString("Queue: %1/%2  Discarded: %3  Wait: %4 ms  Decode: %5 ms")
+                           .arg(stats.depth)
+                           .arg(stats.capacity)
+                           .arg(stats.dropped + stats.decimated)
+                           .arg(stats.queueLatency / 1.0e6, 0, 'f', 3)
+                           .arg(stats.processLatency / 1.0e6, 0, 'f', 3));
+    ingestButton->setToolTip("Overload policy: " +
+                             CommonData::ingestPolicy(m_topicName).description() + "\n" +
+                             "Dropped when full: " + QString::number(stats.dropped) + "\n" +
+                             "Decimated: " + QString::number(stats.decimated) + "\n" +
+                             "Failed to decode: " + QString::number(stats.failed));
+
+    // Show how closely the replay keeps to its schedule
+    const ReplayStats replay = m_replayEngine->stats();
+    if (replay.total > 0)
+    {
+        QString replayText;
+        if (replay.running && replay.prepared + replay.skipped < replay.total)
+        {
+            replayText = QString("Replay: preparing %1/%2").arg(replay.prepared).arg(replay.total);
+        }
+        else if (replay.requestedRate > 0.0)
         {
-            item->setSelected(true);
+            replayText = QString("Replay: %1/%2  Rate: %3/%4 Hz  Jitter: %5/%6 ms")
+                         .arg(replay.published)
+                         .arg(replay.prepared)
+                         .arg(replay.achievedRate, 0, 'f', 1)
+                         .arg(replay.requestedRate, 0, 'f', 1)
+                         .arg(replay.meanJitter / 1.0e6, 0, 'f', 3)
+                         .arg(replay.maxJitter / 1.0e6, 0, 'f', 3);
         }
+        else
+        {
+            replayText = QString("Replay: %1/%2  Rate: %3 Hz (unthrottled)")
+                         .arg(replay.published)
+                         .arg(replay.prepared)
+                         .arg(replay.achievedRate, 0, 'f', 1);
+        }
+
+        replayLabel->setText(replayText);
+        replayLabel->setToolTip("Published of prepared samples, achieved and requested rate,\n"
+                                "mean and maximum lateness of the writes\n"
+                                "Skipped: " + QString::number(replay.skipped));
     }
 
-    // Use the latest sample if the button is checked
-    if (useLatestButton->isChecked() && historyTable->rowCount() > 0)
+    if (!replay.running && replayButton->isChecked())
     {
-        QTableWidgetItem* item = historyTable->item(0, 0);
-        if (item)
-        {
-            historyTable->clearSelection();
-            historyTable->setCurrentItem(item);
-            item->setSelected(true);
-            setSample(item->text());
-        }
+        replayButton->setChecked(false);
     }
-}
 
 
-//------------------------------------------------------------------------------
-void TablePage::setSample(const QString& sampleName)
-{
-    if (sampleName.isEmpty())
+    // Only the new and evicted samples touch the history table
+    if (!m_historyModel->refresh())
     {
         return;
     }
 
-    const int index = historyTable->currentRow();
+    // Use the latest sample if the button is checked
+    if (useLatestButton->isChecked())
+    {
+        selectLatest();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TablePage::setSample(int row)
+{
+    // New samples may have arrived since the last refresh
+    const int index = m_historyModel->sampleIndex(row);
     if (index < 0)
     {
         return;
     }
 
-    m_selectedSample = sampleName;
+    m_selectedSequence = m_historyModel->sequence(row);
 
     const auto topicInfo = CommonData::getTopicInfo(m_topicName);
     if (!topicInfo)
@@ -655,7 +901,24 @@ void TablePage::setSample(const QString& sampleName)
         return;
     }
 
-    if (topicInfo->typeMode() == TypeDiscoveryMode::TypeCode)
+    if (topicInfo->typeMode() == TypeDiscoveryMode::TypeCode && treeButton->isChecked())
+    {
+        // The tree reads flat samples in place, without building the tree
+        auto flatSample = CommonData::copyFlatSample(m_topicName, index);
+        if (flatSample != nullptr)
+        {
+            m_treeModel->setSample(flatSample);
+        }
+        else
+        {
+            auto sample = CommonData::copySample(m_topicName, index);
+            if (sample != nullptr)
+            {
+                m_treeModel->setSample(sample);
+            }
+        }
+    }
+    else if (topicInfo->typeMode() == TypeDiscoveryMode::TypeCode)
     {
         auto sample = CommonData::copySample(m_topicName, index);
         if (sample != nullptr)
@@ -676,6 +939,53 @@ void TablePage::setSample(const QString& sampleName)
 }
 
 
+//------------------------------------------------------------------------------
+void TablePage::selectLatest()
+{
+    if (m_historyModel->rowCount() == 0)
+    {
+        return;
+    }
+
+    // Changing the selection shows the sample through historySelectionChanged
+    const QModelIndex latest = m_historyModel->index(0, 0);
+    historyTable->selectionModel()->setCurrentIndex(latest,
+        QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+}
+
+
+//------------------------------------------------------------------------------
+QStringList TablePage::selectedMembers() const
+{
+    QStringList members;
+
+    if (treeButton->isChecked())
+    {
+        // Structs and collections can't be plotted, only their primitives
+        const QModelIndexList rows =
+            topicTreeView->selectionModel()->selectedRows(TopicTreeModel::NAME_COLUMN);
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            if (!m_treeModel->hasChildren(rows.at(i)))
+            {
+                members << rows.at(i).data(TopicTreeModel::FULL_NAME_ROLE).toString();
+            }
+        }
+        return members;
+    }
+
+    const QModelIndexList indexList = topicTableView->selectionModel()->selectedIndexes();
+    for (int i = 0; i < indexList.size(); ++i)
+    {
+        if (indexList.at(i).column() == TopicTableModel::NAME_COLUMN)
+        {
+            members << indexList.at(i).data(Qt::DisplayRole).toString();
+        }
+    }
+    return members;
+}
+
+
 /**
  * @}
  */
@@ -4,14 +4,18 @@
 #include "first_define.h"
 #include "ui_table_page.h"
 
-#include <QTableWidgetItem>
+#include <QItemSelection>
 #include <QStringList>
 #include <QString>
 #include <QTimer>
 
+#include <cstdint>
 #include <memory>
 
+class HistoryTableModel;
+class ReplayEngine;
 class TopicTableModel;
+class TopicTreeModel;
 class TopicReplayer;
 class TopicMonitor;
 
@@ -48,6 +52,16 @@ private slots:
      */
     void on_filterButton_clicked();
 
+    /**
+     * @brief Prompt the user for the history depth of this topic.
+     */
+    void on_historyButton_clicked();
+
+    /**
+     * @brief Prompt the user for the overload policy of this topic.
+     */
+    void on_ingestButton_clicked();
+
     /**
      * @brief Toggles the option of viewing the latest sample on the page.
      */
@@ -78,10 +92,15 @@ private slots:
      */
     void on_publishButton_clicked();
 
+    /**
+     * @brief Start or stop replaying the sample history on the bus.
+     */
+    void on_replayButton_clicked();
+
     /**
      * @brief Switch which data sample is view on this page.
      */
-    void on_historyTable_itemSelectionChanged();
+    void historySelectionChanged();
 
     /**
      * @brief Create a new plot from the selected variables.
@@ -93,6 +112,11 @@ private slots:
      */
     void on_attachPlotButton_clicked();
 
+    /**
+     * @brief Create a waterfall view of the array holding the selected elements.
+     */
+    void on_waterfallButton_clicked();
+
     /**
      * @brief Start recording the selected variables to a file.
      */
@@ -108,6 +132,11 @@ private slots:
      */
     void on_asciiButton_clicked();
 
+    /**
+     * @brief Switch between the flat table and the tree view of the sample.
+     */
+    void on_treeButton_clicked();
+
     /**
      * @brief Disable the scroll to latest option if the user started editing.
      * @param[in] index The clicked table index.
@@ -129,34 +158,51 @@ private:
 
     /**
      * @brief Set the data sample used by this page.
-     * @param[in] The name of the data sample (timestamp).
+     * @param[in] row The row of the data sample in the history table.
+     */
+    void setSample(int row);
+
+    /**
+     * @brief Select the newest sample in the history table.
+     */
+    void selectLatest();
+
+    /**
+     * @brief Get the full names of the selected primitive members.
+     * @return The member names, as used by CommonData::readValue.
      */
-    void setSample(const QString& sampleName);
+    QStringList selectedMembers() const;
 
     /// The number of MS to wait until updating the history widget.
     static const int REFRESH_TIMEOUT = 250;
 
+    /// Sample history model for the topic used on this page.
+    std::unique_ptr<HistoryTableModel> m_historyModel;
+
     /// Data model for the topic used on this page.
     std::unique_ptr<TopicTableModel> m_tableModel;
 
+    /// Tree data model for the topic used on this page, shown instead of the table.
+    std::unique_ptr<TopicTreeModel> m_treeModel;
+
     /// Topic monitor for the topic used on this page (Leak on purpose since DDS shutdown isn't quite right).
     std::unique_ptr<TopicMonitor> m_topicMonitor;
 
     /// Topic replayer for the topic used on this page (Leak on purpose since DDS shutdown isn't quite right).
     std::unique_ptr<TopicReplayer> m_topicReplayer;
 
+    /// Republishes the sample history through m_topicReplayer. Destroyed first.
+    std::unique_ptr<ReplayEngine> m_replayEngine;
+
     /// The name of the topic used on this page.
     QString m_topicName;
 
-    /// The name of the selected sample.
-    QString m_selectedSample;
+    /// The sequence of the selected sample.
+    uint64_t m_selectedSequence;
 
     /// Refresh timer for all tables.
     QTimer m_refreshTimer;
 
-    /// Stores the history sample names.
-    QStringList m_historyList;
-
 };
 
 #endif
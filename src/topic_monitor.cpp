@@ -1,28 +1,70 @@
 #include "qos_dictionary.h"
 #include "open_dynamic_data.h"
+#include "serialized_sample.h"
+#include "decode_plan.h"
+#include "flat_sample.h"
 #include "topic_monitor.h"
 #include "dynamic_meta_struct.h"
 #include "dds_manager.h"
 #include "dds_data.h"
 #include "qos_dictionary.h"
 
+#include <dds/DCPS/DomainParticipantImpl.h>
 #include <dds/DCPS/EncapsulationHeader.h>
 #include <dds/DCPS/Message_Block_Ptr.h>
+#include <dds/DCPS/GuardCondition.h>
+#include <dds/DCPS/WaitSet.h>
 #include <dds/DCPS/XTypes/DynamicTypeSupport.h>
 
-#include <QDateTime>
-
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 
 
+//------------------------------------------------------------------------------
+struct TopicMonitor::CompiledFilter
+{
+    /**
+     * @brief Parse a filter.
+     * @param[in] text The SQL filter string.
+     * @param[in] extensibility The topic extensibility.
+     */
+    CompiledFilter(const QString& text, OpenDDS::DCPS::Extensibility extensibility)
+        : meta(std::shared_ptr<OpenDynamicData>())
+        , typeSupport(meta, extensibility)
+    {
+        try
+        {
+            evaluator.reset(new OpenDDS::DCPS::FilterEvaluator(text.toUtf8().data(), false));
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        }
+    }
+
+    /// The parsed filter, or nullptr if it didn't parse. Rejects every sample then.
+    std::unique_ptr<OpenDDS::DCPS::FilterEvaluator> evaluator;
+
+    /// Reads the filtered members from the sample being evaluated.
+    DynamicMetaStruct meta;
+
+    /// Passes meta to the evaluator.
+    FilterTypeSupport typeSupport;
+};
+
+
 //------------------------------------------------------------------------------
 TopicMonitor::TopicMonitor(const QString& topicName)
     : m_topicName(topicName)
     , m_filter("")
+    , m_passedSamples(0)
+    , m_rejectedSamples(0)
+    , m_store(CommonData::getSampleStore(topicName))
+    , m_decodeQueue(CommonData::createDecodeQueue(CommonData::decodeQueueDepth(),
+                                                  [this](std::vector<PendingSample>& batch) { processSamples(batch); }))
     , m_recorder_listener(OpenDDS::DCPS::make_rch<RecorderListener>(OpenDDS::DCPS::ref(*this)))
     , m_recorder(nullptr)
-    , m_dr_listener(new DataReaderListenerImpl(*this))
     , m_topic(nullptr)
     , m_paused(false)
 {
@@ -33,6 +75,8 @@ TopicMonitor::TopicMonitor(const QString& topicName)
         throw std::runtime_error(std::string("Unable to find topic information for topic \"") + topicName.toStdString() + "\"");
     }
 
+    m_decodeQueue->setPolicy(CommonData::ingestPolicy(topicName));
+
     // Store extensibility
     m_extensibility = topicInfo->extensibility();
     OpenDDS::DCPS::Service_Participant* service = TheServiceParticipant;
@@ -53,6 +97,10 @@ TopicMonitor::TopicMonitor(const QString& topicName)
     {
         // Use the existing mechanism based on TypeCode.
         m_typeCode = topicInfo->typeCode();
+        m_decodePlan = std::make_shared<DecodePlan>(m_typeCode,
+                                                    QosDictionary::getEncodingKind(),
+                                                    m_extensibility);
+        m_samplePool = std::make_shared<FlatSamplePool>();
         m_topic = service->create_typeless_topic(participant,
                                                  topicInfo->topicName().c_str(),
                                                  topicInfo->typeName().c_str(),
@@ -100,14 +148,18 @@ TopicMonitor::TopicMonitor(const QString& topicName)
             throw std::runtime_error(std::string("Failed to create subscriber for topic \"") + topicInfo->topicName() + "\"");
         }
 
+        // Samples are taken by a thread waiting on the reader, not a listener
         m_dr = subscriber->create_datareader(m_topic,
                                              topicInfo->readerQos(),
-                                             m_dr_listener,
-                                             OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+                                             0,
+                                             OpenDDS::DCPS::NO_STATUS_MASK);
         if (!m_dr)
         {
             throw std::runtime_error(std::string("Failed to create data reader for topic \"") + topicInfo->topicName() + "\"");
         }
+
+        m_stopReading = new DDS::GuardCondition;
+        m_readerThread = std::thread(&TopicMonitor::readSamples, this);
         topicInfo->typeMode(TypeDiscoveryMode::DynamicType);
     }
 }
@@ -124,6 +176,16 @@ TopicMonitor::~TopicMonitor()
 void TopicMonitor::setFilter(const QString& filter)
 {
     m_filter = filter;
+
+    std::shared_ptr<CompiledFilter> compiled;
+    if (!filter.isEmpty())
+    {
+        compiled = std::make_shared<CompiledFilter>(filter, m_extensibility);
+    }
+
+    m_passedSamples = 0;
+    m_rejectedSamples = 0;
+    std::atomic_store(&m_compiledFilter, compiled);
 }
 
 
@@ -134,9 +196,47 @@ QString TopicMonitor::getFilter() const
 }
 
 
+//------------------------------------------------------------------------------
+uint64_t TopicMonitor::passedCount() const
+{
+    return m_passedSamples;
+}
+
+
+//------------------------------------------------------------------------------
+uint64_t TopicMonitor::rejectedCount() const
+{
+    return m_rejectedSamples;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicMonitor::setIngestPolicy(const IngestPolicy& policy)
+{
+    m_decodeQueue->setPolicy(policy);
+}
+
+
+//------------------------------------------------------------------------------
+DecodeQueueStats TopicMonitor::decodeStats() const
+{
+    return m_decodeQueue->stats();
+}
+
+
 //------------------------------------------------------------------------------
 void TopicMonitor::close()
 {
+    if (m_readerThread.joinable())
+    {
+        m_stopReading->set_trigger_value(true);
+        m_readerThread.join();
+    }
+
+    // Samples still queued are discarded and no worker touches this object
+    // once the queue is closed
+    m_decodeQueue->close();
+
     // The set_deleted method became protected in v3.12, so this object can no
     // destroy itself. We're forced to simply stop updating, and leave this
     // object as a memory leak
@@ -197,36 +297,106 @@ void TopicMonitor::on_sample_data_received(OpenDDS::DCPS::Recorder*,
         return;
     }
 
-    OpenDDS::DCPS::Message_Block_Ptr mbCopy(rawSample.sample_->duplicate());
-    OpenDDS::DCPS::Serializer serial(
-        rawSample.sample_.get(), rawSample.encoding_kind_, static_cast<OpenDDS::DCPS::Endianness>(rawSample.header_.byte_order_));
+    // Decoding, filtering and storing happen on a decode worker, so the
+    // transport thread only duplicates the message block and returns.
+    PendingSample pending;
+    pending.block.reset(rawSample.sample_->duplicate());
+    pending.sourceTime = CommonData::toNanoseconds(rawSample.source_timestamp_);
+    pending.receptionTime = CommonData::currentTimeNanoseconds();
+    pending.writer = rawSample.publication_id_;
+    pending.encodingKind = rawSample.encoding_kind_;
+    pending.endianness = static_cast<OpenDDS::DCPS::Endianness>(rawSample.header_.byte_order_);
+    pending.cdrEncapsulation = rawSample.header_.cdr_encapsulation_;
+    m_decodeQueue->push(std::move(pending));
+}
+
 
+//------------------------------------------------------------------------------
+void TopicMonitor::processSamples(std::vector<PendingSample>& batch)
+{
+    for (PendingSample& pending : batch)
+    {
+        if (!pending.dynamicSample)
+        {
+            processSample(pending);
+            continue;
+        }
+
+        // TODO: Apply content filtering when it's supported.
+        TopicSample slot;
+        slot.dynamicSample = pending.dynamicSample._retn();
+        slot.sourceTime = pending.sourceTime;
+        slot.receptionTime = pending.receptionTime;
+        slot.writer = pending.writer;
+        m_dynamicBatch.push_back(slot);
+    }
+
+    if (!m_dynamicBatch.empty())
+    {
+        m_store->storeDynamicSamples(m_dynamicBatch);
+
+        // Releases the evicted samples and keeps the capacity
+        m_dynamicBatch.clear();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TopicMonitor::processSample(PendingSample& pending)
+{
     //RJ 2022-01-20 With OpenDDS 3.19.0, the entire message header is read before the sample gets passed to this function.
     //Code that strips off the RTPS header has been removed.
     //Same with the reset_alignment call in the serializer. That has already happened before the sample is passed to this function.
 
-    std::shared_ptr<OpenDynamicData> sample = CreateOpenDynamicData(m_typeCode, globalEncoding, m_extensibility);
-    if (globalEncoding != OpenDDS::DCPS::Encoding::KIND_XCDR1)
+    // Taken once, so a filter set meanwhile applies from the next sample
+    const std::shared_ptr<CompiledFilter> filter = std::atomic_load(&m_compiledFilter);
+
+    // Without a filter nothing needs the decoded sample yet, so keep it
+    // serialized and let the store decode it when it is first read.
+    // Tracked members need the values at once, so those topics store flat.
+    if (!filter && CommonData::lazyDecoding() && !m_store->hasTracked())
+    {
+        m_store->storeSerializedSample(pending.sourceTime,
+                                       pending.receptionTime,
+                                       std::make_shared<SerializedSample>(*pending.block,
+                                                                          m_decodePlan,
+                                                                          pending.endianness),
+                                       pending.writer);
+        return;
+    }
+
+    // Unfiltered samples are stored flat, which is far cheaper than the tree
+    if (!filter)
     {
-        std::cout << "Removing delimiter header" << std::endl;
-        uint32_t delim_header = 0;
-        if (!(serial >> delim_header))
+        std::shared_ptr<FlatSample> sample =
+            SerializedSample::decodeFlat(pending.block.get(), *m_decodePlan, m_samplePool, pending.endianness);
+        if (sample)
         {
-            std::cerr << "TopicMonitor::on_sample_data_received: Could not read stream delimiter" << std::endl;
-            return;
+            m_store->storeFlatSample(pending.sourceTime,
+                                     pending.receptionTime,
+                                     sample,
+                                     pending.writer);
         }
+        return;
     }
 
-    (*(sample.get())) << serial;
+    OpenDDS::DCPS::Message_Block_Ptr mbCopy(pending.block->duplicate());
+    std::shared_ptr<OpenDynamicData> sample =
+        SerializedSample::decode(pending.block.get(), *m_decodePlan, pending.endianness);
+    if (!sample)
+    {
+        return;
+    }
     //sample->dump();
 
-    // If a filter was specified, make sure the sample passes
-    if (!m_filter.isEmpty())
+    // Make sure the sample passes the filter. Only evaluation happens here;
+    // the filter was parsed by setFilter.
+    bool pass = false;
+    if (filter->evaluator)
     {
-        bool pass = true;
         try
         {
-            if (rawSample.header_.cdr_encapsulation_ &&
+            if (pending.cdrEncapsulation &&
                 mbCopy->rd_ptr() >= mbCopy->base() + OpenDDS::DCPS::EncapsulationHeader::serialized_size)
             {
                 // Before calling this function, RecorderImpl::data_received() read the EncapsulationHeader
@@ -234,62 +404,111 @@ void TopicMonitor::on_sample_data_received(OpenDDS::DCPS::Recorder*,
                 mbCopy->rd_ptr(mbCopy->rd_ptr() - OpenDDS::DCPS::EncapsulationHeader::serialized_size);
             }
 
-            OpenDDS::DCPS::FilterEvaluator filterTest(m_filter.toUtf8().data(), false);
-            DynamicMetaStruct metaInfo(sample);
             const DDS::StringSeq noParams;
-            OpenDDS::DCPS::Encoding encoding(rawSample.encoding_kind_, static_cast<OpenDDS::DCPS::Endianness>(rawSample.header_.byte_order_));
-            FilterTypeSupport typeSupport(metaInfo, m_extensibility);
-            pass = filterTest.eval(mbCopy.get(), encoding, typeSupport, noParams);
+            OpenDDS::DCPS::Encoding encoding(pending.encodingKind, pending.endianness);
+            filter->meta.setSample(sample);
+            pass = filter->evaluator->eval(mbCopy.get(), encoding, filter->typeSupport, noParams);
         }
         catch (const std::exception& e)
         {
             std::cerr << "Exception: " << e.what() << std::endl;
             pass = false;
         }
-
-        if (!pass)
-        {
-            return;
-        }
-
+        filter->meta.setSample(std::shared_ptr<OpenDynamicData>());
     }
 
-    const QDateTime dataTime = QDateTime::fromMSecsSinceEpoch(
-        (static_cast<unsigned long long>(rawSample.source_timestamp_.sec) * 1000) +
-        (static_cast<unsigned long long>(rawSample.source_timestamp_.nanosec) * 1e-6));
+    if (!pass)
+    {
+        ++m_rejectedSamples;
+        return;
+    }
+    ++m_passedSamples;
 
-    QString sampleName = dataTime.toString("HH:mm:ss.zzz");
-    CommonData::storeSample(m_topicName, sampleName, sample);
+    m_store->storeSample(pending.sourceTime,
+                         pending.receptionTime,
+                         sample,
+                         pending.writer);
 }
 
-void TopicMonitor::on_data_available(DDS::DataReader_ptr dr)
-{
-    if (m_paused) {
-        return;
-    }
 
-    DDS::DynamicDataReader_var ddr = DDS::DynamicDataReader::_narrow(dr);
+//------------------------------------------------------------------------------
+void TopicMonitor::readSamples()
+{
+    DDS::DynamicDataReader_var ddr = DDS::DynamicDataReader::_narrow(m_dr);
+    DDS::ReadCondition_var readCondition = m_dr->create_readcondition(
+        DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    DDS::WaitSet_var waitSet = new DDS::WaitSet;
+    waitSet->attach_condition(readCondition);
+    waitSet->attach_condition(m_stopReading);
+
+    // The writer GUID is looked up from the publication handle
+    DDS::DomainParticipant_var participant = m_dr->get_subscriber()->get_participant();
+    OpenDDS::DCPS::DomainParticipantImpl* participantImpl =
+        dynamic_cast<OpenDDS::DCPS::DomainParticipantImpl*>(participant.in());
+
+    // Reused by every take. Empty sequences let the reader lend its samples.
     DDS::DynamicDataSeq messages;
     DDS::SampleInfoSeq infos;
-    const DDS::ReturnCode_t ret = ddr->take(messages, infos, DDS::LENGTH_UNLIMITED,
-      DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-    if (ret != DDS::RETCODE_OK && ret != DDS::RETCODE_NO_DATA) {
-        std::cerr << "Failed to take samples for topic "
-                  << m_topicName.toStdString() << std::endl;
-        return;
-    }
+    DDS::ConditionSeq active;
+    const DDS::Duration_t forever = { DDS::DURATION_INFINITE_SEC, DDS::DURATION_INFINITE_NSEC };
 
-    for (unsigned int i = 0; i < messages.length(); ++i) {
-        if (infos[i].valid_data) {
-            // TODO: Apply content filtering when it's supported.
-            QDateTime dataTime = QDateTime::fromMSecsSinceEpoch(
-                (static_cast<unsigned long long>(infos[i].source_timestamp.sec) * 1000) +
-                (static_cast<unsigned long long>(infos[i].source_timestamp.nanosec) * 1e-6));
-            QString sampleName = dataTime.toString("HH:mm:ss.zzz");
-            CommonData::storeDynamicSample(m_topicName, sampleName,
-                                           DDS::DynamicData::_duplicate(messages[i].in()));
+    while (!m_stopReading->get_trigger_value())
+    {
+        // The wait never times out, so an error would only repeat at once.
+        // Stop reading instead of spinning.
+        const DDS::ReturnCode_t waitResult = waitSet->wait(active, forever);
+        if (waitResult != DDS::RETCODE_OK)
+        {
+            std::cerr << "Failed to wait for samples for topic "
+                      << m_topicName.toStdString()
+                      << " (error " << waitResult << ")" << std::endl;
+            break;
+        }
+        if (m_stopReading->get_trigger_value())
+        {
+            break;
+        }
+
+        // Let a burst gather, so it is taken with a few loans
+        std::this_thread::sleep_for(std::chrono::milliseconds(READ_COALESCE_MS));
+
+        // A full take may have left samples behind
+        CORBA::ULong taken = MAX_TAKE_SAMPLES;
+        while (taken == static_cast<CORBA::ULong>(MAX_TAKE_SAMPLES))
+        {
+            const DDS::ReturnCode_t ret = ddr->take(messages, infos, MAX_TAKE_SAMPLES,
+                DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+            if (ret != DDS::RETCODE_OK) {
+                if (ret != DDS::RETCODE_NO_DATA) {
+                    std::cerr << "Failed to take samples for topic "
+                              << m_topicName.toStdString() << std::endl;
+                }
+                break;
+            }
+
+            // Paused topics still take, so the read condition clears
+            taken = messages.length();
+            const int64_t receptionTime = CommonData::currentTimeNanoseconds();
+            for (CORBA::ULong i = 0; i < taken && !m_paused; ++i) {
+                if (infos[i].valid_data) {
+                    PendingSample pending;
+                    pending.dynamicSample = DDS::DynamicData::_duplicate(messages[i].in());
+                    pending.sourceTime = CommonData::toNanoseconds(infos[i].source_timestamp);
+                    pending.receptionTime = receptionTime;
+                    pending.writer = participantImpl ?
+                        participantImpl->get_repoid(infos[i].publication_handle) : OpenDDS::DCPS::GUID_UNKNOWN;
+                    m_decodeQueue->push(std::move(pending));
+                }
+            }
+
+            // The queued samples hold their own references
+            ddr->return_loan(messages, infos);
         }
     }
+
+    waitSet->detach_condition(m_stopReading);
+    waitSet->detach_condition(readCondition);
+    m_dr->delete_readcondition(readCondition);
 }
 
 //------------------------------------------------------------------------------
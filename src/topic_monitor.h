@@ -2,19 +2,28 @@
 #define __DDS_TOPIC_MONITOR_H__
 
 #include "first_define.h"
+#include "decode_worker_pool.h"
+#include "topic_sample_store.h"
 
 #include <dds/DCPS/TopicDescriptionImpl.h>
 #include <dds/DCPS/OwnershipManager.h>
 #include <dds/DCPS/EntityImpl.h>
 #include <dds/DCPS/RecorderImpl.h>
 #include <dds/DdsDcpsCoreC.h>
+#include <dds/DdsDcpsInfrastructureC.h>
 #include <dds/DCPS/Serializer.h>
 
 #include <QString>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <thread>
+#include <vector>
 
 class DynamicMetaStruct;
+class DecodePlan;
+class FlatSamplePool;
 
 /**
  * @brief Topic monitor for receiving raw DDS data samples.
@@ -31,6 +40,9 @@ public:
 
     /**
      * @brief Apply a filter to this topic.
+     * @details The filter is parsed here once, and the compiled filter is
+     *          evaluated for every received sample. The sample counters
+     *          restart with the new filter.
      * @param[in] filter The SQL filter string for this topic.
      */
     void setFilter(const QString& filter);
@@ -41,6 +53,30 @@ public:
     */
     QString getFilter() const;
 
+    /**
+     * @brief Get the number of samples that passed the current filter.
+     * @return The number of samples stored since the filter was set.
+     */
+    uint64_t passedCount() const;
+
+    /**
+     * @brief Get the number of samples rejected by the current filter.
+     * @return The number of samples dropped since the filter was set.
+     */
+    uint64_t rejectedCount() const;
+
+    /**
+     * @brief Change how this topic handles samples it can't keep up with.
+     * @param[in] policy The ingest policy.
+     */
+    void setIngestPolicy(const IngestPolicy& policy);
+
+    /**
+     * @brief Get the state of the decode queue of this topic.
+     * @return The queue depth, discard counts and average latencies.
+     */
+    DecodeQueueStats decodeStats() const;
+
     /**
      * @brief Close the topic monitor for this topic.
      * @details This object doesn't delete properly from the
@@ -51,7 +87,7 @@ public:
     void close();
 
     /**
-     * @brief Read all the samples from the data reader.
+     * @brief Queue a sample received by the recorder for decoding.
      * @param[in] recorder The recorder object with the data.
      * @param[in] rawSample The new data sample for this topic.
      */
@@ -75,38 +111,6 @@ public:
         TopicMonitor& m_monitor;
     };
 
-    void on_data_available(DDS::DataReader_ptr);
-
-    class DataReaderListenerImpl : public virtual OpenDDS::DCPS::LocalObject<DDS::DataReaderListener>
-    {
-    public:
-      DataReaderListenerImpl(TopicMonitor& monitor) : m_monitor(monitor) {}
-      virtual void on_requested_deadline_missed(DDS::DataReader_ptr,
-                                                const DDS::RequestedDeadlineMissedStatus&) {}
-
-      virtual void on_requested_incompatible_qos(DDS::DataReader_ptr,
-                                                 const DDS::RequestedIncompatibleQosStatus&) {}
-
-      virtual void on_liveliness_changed(DDS::DataReader_ptr,
-                                         const DDS::LivelinessChangedStatus&) {}
-
-      virtual void on_subscription_matched(DDS::DataReader_ptr,
-                                           const DDS::SubscriptionMatchedStatus&) {}
-
-      virtual void on_sample_rejected(DDS::DataReader_ptr,
-                                      const DDS::SampleRejectedStatus&) {}
-
-      virtual void on_data_available(DDS::DataReader_ptr reader)
-      {
-        m_monitor.on_data_available(reader);
-      }
-
-      virtual void on_sample_lost(DDS::DataReader_ptr,
-                                  const DDS::SampleLostStatus&) {}
-    private:
-      TopicMonitor& m_monitor;
-    };
-
     /**
      * @brief Stop receiving samples.
      */
@@ -124,32 +128,91 @@ public:
 
 private:
 
+    /**
+     * @brief Take samples from the DynamicDataReader until the monitor closes.
+     * @details Runs on m_readerThread. A wakeup waits briefly so a burst of
+     *          samples is taken in a few loans instead of one callback each.
+     */
+    void readSamples();
+
+    /**
+     * @brief Store a batch of queued samples.
+     * @details Called on a decode worker, one batch of this topic at a time.
+     *          DynamicData samples are stored together with one lock.
+     * @param[in,out] batch The received samples, oldest first.
+     */
+    void processSamples(std::vector<PendingSample>& batch);
+
+    /**
+     * @brief Decode, filter and store a queued sample from the recorder.
+     * @param[in,out] pending The received sample.
+     */
+    void processSample(PendingSample& pending);
+
+    /// How long the reader thread lets samples gather after a wakeup.
+    static const int READ_COALESCE_MS = 2;
+
+    /// The maximum number of samples lent by one take.
+    static const int MAX_TAKE_SAMPLES = 256;
+
     /// Stores the name of the topic.
     QString m_topicName;
 
     /// Stores the SQL filter if specified by the user.
     QString m_filter;
 
+    /// A filter parsed once by setFilter and evaluated per sample.
+    struct CompiledFilter;
+
+    /// The current filter, or nullptr without one. Swapped atomically, since
+    /// the listener thread reads it while the GUI sets a new one.
+    std::shared_ptr<CompiledFilter> m_compiledFilter;
+
+    /// The number of samples that passed m_compiledFilter.
+    std::atomic<uint64_t> m_passedSamples;
+
+    /// The number of samples rejected by m_compiledFilter.
+    std::atomic<uint64_t> m_rejectedSamples;
+
     /// Stores the typecode for this topic.
     CORBA::TypeCode_var m_typeCode;
 
+    /// Precompiled decoder for m_typeCode, built when the topic is opened.
+    std::shared_ptr<const DecodePlan> m_decodePlan;
+
+    /// Recycles the buffers of evicted flat samples of this topic.
+    std::shared_ptr<FlatSamplePool> m_samplePool;
+
+    /// The sample history of this topic. Kept to avoid a lookup per sample.
+    std::shared_ptr<TopicSampleStore> m_store;
+
+    /// Received samples waiting for a decode worker.
+    std::shared_ptr<DecodeQueue> m_decodeQueue;
+
     /// Listener for the recorder, calls back into this object
     OpenDDS::DCPS::RcHandle<RecorderListener> m_recorder_listener;
 
     /// Stores the recorder object for this monitor.
     OpenDDS::DCPS::Recorder* m_recorder;
 
-    /// Listener for a dynamic reader
-    DDS::DataReaderListener_var m_dr_listener;
-
     /// A dynamic data reader for this topic
     DDS::DataReader_var m_dr;
 
+    /// Takes the samples of m_dr. Only runs for DynamicType topics.
+    std::thread m_readerThread;
+
+    /// Triggered by close() to stop m_readerThread.
+    DDS::GuardCondition_var m_stopReading;
+
+    /// DynamicData slots being stored. Reused by every batch.
+    std::vector<TopicSample> m_dynamicBatch;
+
     /// Stores the topic object for this monitor.
     DDS::Topic* m_topic;
 
-    /// The paused status of the data reader.
-    bool m_paused;
+    /// The paused status of the data reader. Set by the GUI thread and read
+    /// by the reader and recorder threads.
+    std::atomic<bool> m_paused;
 
     /// The topic extensibility
     OpenDDS::DCPS::Extensibility m_extensibility;
@@ -10,6 +10,57 @@
 #include <iostream>
 
 
+//------------------------------------------------------------------------------
+MessageBlockPool::MessageBlockPool(size_t maxBlocks)
+    : m_maxBlocks(maxBlocks)
+{}
+
+
+//------------------------------------------------------------------------------
+OpenDDS::DCPS::Message_Block_Ptr MessageBlockPool::acquire(size_t size)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+
+    // Use the smallest free block that fits, and remember a free block to
+    // replace if none does
+    ACE_Message_Block* best = nullptr;
+    size_t replace = m_blocks.size();
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+    {
+        ACE_Message_Block* block = m_blocks[i].get();
+        if (block->reference_count() > 1)
+        {
+            continue;
+        }
+
+        const size_t capacity = block->capacity();
+        if (capacity >= size && capacity / 2 <= size &&
+            (!best || capacity < best->capacity()))
+        {
+            best = block;
+        }
+        replace = i;
+    }
+
+    if (best)
+    {
+        best->reset();
+        return OpenDDS::DCPS::Message_Block_Ptr(best->duplicate());
+    }
+
+    OpenDDS::DCPS::Message_Block_Ptr block(new ACE_Message_Block(size));
+    if (m_blocks.size() < m_maxBlocks)
+    {
+        m_blocks.emplace_back(block->duplicate());
+    }
+    else if (replace < m_blocks.size())
+    {
+        m_blocks[replace].reset(block->duplicate());
+    }
+    return block;
+}
+
+
 //------------------------------------------------------------------------------
 TopicReplayer::TopicReplayer(const QString& topicName) :
     m_topicName(topicName),
@@ -77,46 +128,54 @@ TopicReplayer::TopicReplayer(const QString& topicName) :
 //------------------------------------------------------------------------------
 void TopicReplayer::publishSample(const std::shared_ptr<OpenDynamicData> sample)
 {
-    OpenDDS::DCPS::Encoding::Kind globalEncoding = QosDictionary::getEncodingKind();
-    //This used to be hard-coded to 4096.
-    ssize_t num_data_bytes = sample->getEncapsulationLength();
-    //if(globalEncoding !=  OpenDDS::DCPS::Encoding::KIND_XCDR1)
+    OpenDDS::DCPS::Message_Block_Ptr block = serializeSample(sample);
+    if (block)
     {
-        //add 2 bytes for encaspsulation header, 2 bytes for 'options'
-        //But for whatever reason that I do not understand that still isn't enough.
-        //I have spent more time on this than I have so i'm going to just add 1kb and hope that's enough.
-        num_data_bytes += sizeof(CORBA::ULong) + 1024;
+        publishSerialized(block.get());
     }
-    //std::cout << "DEBUG Size of new ace message block: " << num_data_bytes << std::endl;
-    ACE_Message_Block block(num_data_bytes);
+}
+
 
-    //num_data_bytes += sizeof(encap);
-    OpenDDS::DCPS::Serializer serial(&block, globalEncoding);
+//------------------------------------------------------------------------------
+OpenDDS::DCPS::Message_Block_Ptr TopicReplayer::serializeSample(const std::shared_ptr<OpenDynamicData>& sample)
+{
+    OpenDDS::DCPS::Encoding::Kind globalEncoding = QosDictionary::getEncodingKind();
+    const bool delimited = (globalEncoding != OpenDDS::DCPS::Encoding::KIND_XCDR1);
+
+    // The block holds exactly the encapsulation header, the XCDR2 delimiter
+    // header and the members
+    const size_t sampleBytes = sample->getSerializedSize();
+    const size_t num_data_bytes = OpenDDS::DCPS::EncapsulationHeader::serialized_size +
+                                  (delimited ? sizeof(CORBA::ULong) : 0) +
+                                  sampleBytes;
+    OpenDDS::DCPS::Message_Block_Ptr block(m_blockPool.acquire(num_data_bytes));
+
+    OpenDDS::DCPS::Serializer serial(block.get(), globalEncoding);
     bool pass = true;
 
     //Create Encoding and EncapsulationHeader
     OpenDDS::DCPS::Encoding enc(globalEncoding, OpenDDS::DCPS::ENDIAN_LITTLE);
     const OpenDDS::DCPS::EncapsulationHeader encap(enc, m_extensibility);
     if (!encap.is_good()) {
-        std::cerr << "TopicReplayer::publishSample "
+        std::cerr << "TopicReplayer::serializeSample "
                   <<"failed to initialize Encapsulation Header"
                   << std::endl;
-        return;
+        return OpenDDS::DCPS::Message_Block_Ptr();
     }
     //std::cout << "DEBUG CDR Encapsulation is " << encap.to_string() << std::endl;
 
     //Serialize the Encapsulation Header
     pass &= (serial << encap);
 
-    if(globalEncoding !=  OpenDDS::DCPS::Encoding::KIND_XCDR1)
+    if (delimited)
     {
-        CORBA::ULong delim_header= num_data_bytes; //sample->getEncapsulationLength();
+        CORBA::ULong delim_header = static_cast<CORBA::ULong>(sampleBytes);
         //std::cout << "DEBUG TopicReplayer::publishSample encapsulation length " << delim_header << std::endl;
         if (! (serial << delim_header)) {
-            std::cerr << "TopicReplayer::publishSample "
+            std::cerr << "TopicReplayer::serializeSample "
                         << "Could not serialize delimiter header"
                         << std::endl;
-            return;
+            return OpenDDS::DCPS::Message_Block_Ptr();
         }
     }
 
@@ -131,6 +190,26 @@ void TopicReplayer::publishSample(const std::shared_ptr<OpenDynamicData> sample)
             << sample->getName()
             << "'"
             << std::endl;
+        return OpenDDS::DCPS::Message_Block_Ptr();
+    }
+
+    if (block->length() != num_data_bytes)
+    {
+        std::cerr << "TopicReplayer::serializeSample "
+                  << "serialized " << block->length() << " bytes of '"
+                  << sample->getName() << "', expected " << num_data_bytes
+                  << std::endl;
+    }
+
+    return block;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicReplayer::publishSerialized(ACE_Message_Block* block)
+{
+    if (!m_replayer)
+    {
         return;
     }
 
@@ -152,7 +231,7 @@ void TopicReplayer::publishSample(const std::shared_ptr<OpenDynamicData> sample)
     OpenDDS::DCPS::DataSampleHeader sampleHdr;
     sampleHdr.message_id_ = OpenDDS::DCPS::SAMPLE_DATA;
     sampleHdr.publication_id_ = pubID;
-    sampleHdr.message_length_ = static_cast<uint32_t>(num_data_bytes);
+    sampleHdr.message_length_ = static_cast<uint32_t>(block->length());
 
 
     OpenDDS::DCPS::RawDataSample rawSample(
@@ -162,7 +241,7 @@ void TopicReplayer::publishSample(const std::shared_ptr<OpenDynamicData> sample)
         epochTimeNSec,
         pubID,
         true,  //use little endian
-        &block,
+        block,
         QosDictionary::getEncodingKind());
 
     //printf("\n=== TopicReplayer::publishSample ===\n");
@@ -170,7 +249,7 @@ void TopicReplayer::publishSample(const std::shared_ptr<OpenDynamicData> sample)
 
     m_replayer->write(rawSample);
 
-} // End TopicReplayer::publishSample
+} // End TopicReplayer::publishSerialized
 
 
 //------------------------------------------------------------------------------
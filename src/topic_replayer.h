@@ -8,14 +8,59 @@
 #include <dds/DCPS/EntityImpl.h>
 #include <dds/DCPS/RecorderImpl.h>
 #include <dds/DdsDcpsCoreC.h>
+#include <dds/DCPS/Message_Block_Ptr.h>
 
 #include <QString>
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 class OpenDynamicData;
 
 
+/**
+ * @brief Reusable buffers for serialized samples.
+ * @details The transport may keep a reference to a published block, for
+ *          example to resend it, so a block is only reused once every other
+ *          reference to its data was released. A steady stream of samples of
+ *          similar size publishes without allocating.
+ */
+class MessageBlockPool
+{
+public:
+
+    /**
+     * @brief Constructor for the block pool.
+     * @param[in] maxBlocks The maximum number of blocks kept for reuse.
+     */
+    explicit MessageBlockPool(size_t maxBlocks = 16);
+
+    /**
+     * @brief Get an empty block.
+     * @details A free pooled block is reused if it fits without wasting more
+     *          than half of its capacity. Otherwise a block of exactly the
+     *          requested size is allocated.
+     * @param[in] size The number of bytes needed.
+     * @return The block, with its read and write pointers at the start.
+     */
+    OpenDDS::DCPS::Message_Block_Ptr acquire(size_t size);
+
+private:
+
+    /// Protects m_blocks.
+    std::mutex m_mutex;
+
+    /// The maximum number of blocks kept for reuse.
+    const size_t m_maxBlocks;
+
+    /// The pooled blocks. A block is free while the pool holds the only
+    /// reference to its data.
+    std::vector<OpenDDS::DCPS::Message_Block_Ptr> m_blocks;
+
+}; // End class MessageBlockPool
+
+
 /**
  * @brief Topic replayer for sending raw DDS data samples.
  */
@@ -35,6 +80,20 @@ public:
      */
     void publishSample(const std::shared_ptr<OpenDynamicData> sample);
 
+    /**
+     * @brief Serialize a data sample for publishing later.
+     * @param[in] sample The data sample.
+     * @return The encapsulated sample, or nullptr if serialization failed.
+     */
+    OpenDDS::DCPS::Message_Block_Ptr serializeSample(const std::shared_ptr<OpenDynamicData>& sample);
+
+    /**
+     * @brief Publish a sample serialized by serializeSample.
+     * @details May be called from any thread.
+     * @param[in] block The encapsulated sample.
+     */
+    void publishSerialized(ACE_Message_Block* block);
+
     /**
     * @brief Destructor for the DDS topic replayer.
     */
@@ -56,6 +115,9 @@ private:
 
     /// The topic extensibility
     OpenDDS::DCPS::Extensibility m_extensibility;
+
+    /// Buffers for the serialized samples.
+    MessageBlockPool m_blockPool;
 };
 
 #endif
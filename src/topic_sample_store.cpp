@@ -0,0 +1,789 @@
+#include "topic_sample_store.h"
+#include "serialized_sample.h"
+#include "flat_sample.h"
+#include "member_accessor.h"
+#include "open_dynamic_data.h"
+#include "dds_data.h"
+
+#include <dds/DCPS/XTypes/Utils.h>
+
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+std::atomic<size_t> TopicSampleStore::m_totalBytes(0);
+std::atomic<uint64_t> TopicSampleStore::m_nextSequence(1);
+
+
+namespace
+{
+
+/// Size of a primitive XTypes kind, or 0 if the kind is not primitive.
+size_t primitiveSize(DDS::TypeKind kind)
+{
+    switch (kind)
+    {
+    case OpenDDS::XTypes::TK_BOOLEAN:
+    case OpenDDS::XTypes::TK_BYTE:
+    case OpenDDS::XTypes::TK_INT8:
+    case OpenDDS::XTypes::TK_UINT8:
+    case OpenDDS::XTypes::TK_CHAR8:
+        return 1;
+    case OpenDDS::XTypes::TK_INT16:
+    case OpenDDS::XTypes::TK_UINT16:
+    case OpenDDS::XTypes::TK_CHAR16:
+        return 2;
+    case OpenDDS::XTypes::TK_INT32:
+    case OpenDDS::XTypes::TK_UINT32:
+    case OpenDDS::XTypes::TK_FLOAT32:
+    case OpenDDS::XTypes::TK_ENUM:
+        return 4;
+    case OpenDDS::XTypes::TK_INT64:
+    case OpenDDS::XTypes::TK_UINT64:
+    case OpenDDS::XTypes::TK_FLOAT64:
+        return 8;
+    case OpenDDS::XTypes::TK_FLOAT128:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+/// Type of the item with the given id inside a DynamicData of the given type.
+DDS::DynamicType_var itemType(DDS::DynamicType_ptr type, DDS::MemberId id)
+{
+    const DDS::TypeKind kind = type->get_kind();
+    if (kind == OpenDDS::XTypes::TK_SEQUENCE || kind == OpenDDS::XTypes::TK_ARRAY)
+    {
+        DDS::TypeDescriptor_var td;
+        if (type->get_descriptor(td) != DDS::RETCODE_OK)
+        {
+            return DDS::DynamicType_var();
+        }
+        return OpenDDS::XTypes::get_base_type(td->element_type());
+    }
+
+    DDS::DynamicTypeMember_var dtm;
+    if (type->get_member(dtm, id) != DDS::RETCODE_OK)
+    {
+        return DDS::DynamicType_var();
+    }
+
+    DDS::MemberDescriptor_var md;
+    if (dtm->get_descriptor(md) != DDS::RETCODE_OK)
+    {
+        return DDS::DynamicType_var();
+    }
+    return OpenDDS::XTypes::get_base_type(md->type());
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+TopicSampleStore::TopicSampleStore(size_t capacity)
+    : m_history(capacity)
+    , m_bytes(0)
+    , m_trackedCount(0)
+{}
+
+
+//------------------------------------------------------------------------------
+TopicSampleStore::~TopicSampleStore()
+{
+    m_totalBytes -= m_bytes;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::storeSample(int64_t sourceTime,
+                                   int64_t receptionTime,
+                                   const std::shared_ptr<OpenDynamicData> sample,
+                                   const OpenDDS::DCPS::GUID_t& writer)
+{
+    TopicSample newSample;
+    newSample.sample = sample;
+    newSample.sourceTime = sourceTime;
+    newSample.receptionTime = receptionTime;
+    newSample.writer = writer;
+    newSample.bytes = sampleSize(sample);
+    store(newSample);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::storeSerializedSample(int64_t sourceTime,
+                                             int64_t receptionTime,
+                                             const std::shared_ptr<const SerializedSample> sample,
+                                             const OpenDDS::DCPS::GUID_t& writer)
+{
+    TopicSample newSample;
+    newSample.serialized = sample;
+    newSample.sourceTime = sourceTime;
+    newSample.receptionTime = receptionTime;
+    newSample.writer = writer;
+    newSample.bytes = sample ? sample->size() : 0;
+    store(newSample);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::storeFlatSample(int64_t sourceTime,
+                                       int64_t receptionTime,
+                                       const std::shared_ptr<const FlatSample> sample,
+                                       const OpenDDS::DCPS::GUID_t& writer)
+{
+    TopicSample newSample;
+    newSample.flat = sample;
+    newSample.sourceTime = sourceTime;
+    newSample.receptionTime = receptionTime;
+    newSample.writer = writer;
+    newSample.bytes = sample ? sample->size() : 0;
+    store(newSample);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::storeDynamicSample(int64_t sourceTime,
+                                          int64_t receptionTime,
+                                          const DDS::DynamicData_var sample,
+                                          const OpenDDS::DCPS::GUID_t& writer)
+{
+    TopicSample newSample;
+    newSample.dynamicSample = sample;
+    newSample.sourceTime = sourceTime;
+    newSample.receptionTime = receptionTime;
+    newSample.writer = writer;
+    newSample.bytes = sampleSize(sample.in());
+    store(newSample);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::storeDynamicSamples(std::vector<TopicSample>& batch)
+{
+    // Sized before locking, like a single sample, so the byte totals are
+    // right whenever a memory budget is applied
+    for (TopicSample& newSample : batch)
+    {
+        newSample.bytes = sampleSize(newSample.dynamicSample.in());
+    }
+    store(batch.data(), batch.size());
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::store(TopicSample& newSample)
+{
+    store(&newSample, 1);
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::store(TopicSample* samples, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint64_t sequence = m_nextSequence.fetch_add(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        samples[i].sequence = sequence++;
+    }
+
+    // Tracked topics keep a reference to the new samples, since each slot
+    // receives the sample it evicted
+    std::vector<TopicSample> tracked;
+    {
+        // The caller frees the evicted samples after unlocking
+        QWriteLocker locker(&m_lock);
+
+        // Checked under the history lock, which trackMember() takes to
+        // register a column, so a sample is either in the history it copies
+        // or appended below
+        if (m_trackedCount > 0)
+        {
+            tracked.assign(samples, samples + count);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t added = samples[i].bytes;
+            samples[i] = m_history.push(samples[i]);
+
+            m_bytes += added;
+            m_bytes -= samples[i].bytes;
+            m_totalBytes += added;
+            m_totalBytes -= samples[i].bytes;
+        }
+    }
+
+    // Append to the tracked columns outside the history lock, so readers of
+    // the history are never blocked by tracking
+    if (!tracked.empty())
+    {
+        QWriteLocker trackedLocker(&m_trackedLock);
+        for (const TopicSample& slot : tracked)
+        {
+            appendTracked(slot);
+        }
+    }
+
+    CommonData::enforceMemoryBudget();
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> TopicSampleStore::sample(size_t index) const
+{
+    TopicSample slot;
+    {
+        QReadLocker locker(&m_lock);
+        if (index >= m_history.size())
+        {
+            return std::shared_ptr<OpenDynamicData>();
+        }
+
+        const TopicSample& stored = m_history.at(index);
+        if (!stored.serialized && !stored.flat)
+        {
+            return stored.sample;
+        }
+        slot.serialized = stored.serialized;
+        slot.flat = stored.flat;
+        slot.sequence = stored.sequence;
+    }
+
+    // Decode outside of the history lock so ingest is never blocked
+    return decode(slot);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> TopicSampleStore::sample(const TopicSample& slot) const
+{
+    if (!slot.serialized && !slot.flat)
+    {
+        return slot.sample;
+    }
+    return decode(slot);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const FlatSample> TopicSampleStore::flatSample(size_t index) const
+{
+    QReadLocker locker(&m_lock);
+    if (index >= m_history.size())
+    {
+        return std::shared_ptr<const FlatSample>();
+    }
+    return m_history.at(index).flat;
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<OpenDynamicData> TopicSampleStore::decode(const TopicSample& slot) const
+{
+    const uint64_t sequence = slot.sequence;
+    {
+        QMutexLocker locker(&m_decodeCacheMutex);
+        for (auto it = m_decodeCache.begin(); it != m_decodeCache.end(); ++it)
+        {
+            if (it->first == sequence)
+            {
+                m_decodeCache.splice(m_decodeCache.begin(), m_decodeCache, it);
+                return m_decodeCache.front().second;
+            }
+        }
+    }
+
+    std::shared_ptr<OpenDynamicData> decoded = slot.flat ?
+        slot.flat->toOpenDynamicData() : slot.serialized->decode();
+    if (!decoded)
+    {
+        return decoded;
+    }
+
+    // Declared before the lock so a dropped sample is freed after unlocking
+    std::shared_ptr<OpenDynamicData> dropped;
+    QMutexLocker locker(&m_decodeCacheMutex);
+    for (const auto& entry : m_decodeCache)
+    {
+        // Another reader decoded the same sample first
+        if (entry.first == sequence)
+        {
+            return entry.second;
+        }
+    }
+
+    m_decodeCache.emplace_front(sequence, decoded);
+    if (m_decodeCache.size() > DECODE_CACHE_SIZE)
+    {
+        dropped = m_decodeCache.back().second;
+        m_decodeCache.pop_back();
+    }
+    return decoded;
+}
+
+
+//------------------------------------------------------------------------------
+DDS::DynamicData_var TopicSampleStore::dynamicSample(size_t index) const
+{
+    QReadLocker locker(&m_lock);
+    if (index >= m_history.size())
+    {
+        return DDS::DynamicData_var();
+    }
+    return m_history.at(index).dynamicSample;
+}
+
+
+//------------------------------------------------------------------------------
+std::vector<TopicSample> TopicSampleStore::copySlots(size_t first, size_t count) const
+{
+    std::vector<TopicSample> copied;
+    QReadLocker locker(&m_lock);
+
+    if (first >= m_history.size())
+    {
+        return copied;
+    }
+
+    const size_t last = first + std::min(count, m_history.size() - first);
+    copied.reserve(last - first);
+    for (size_t i = last; i-- > first;)
+    {
+        copied.push_back(m_history.at(i));
+    }
+    return copied;
+}
+
+
+//------------------------------------------------------------------------------
+std::vector<TopicSample> TopicSampleStore::copySlotsInTimeRange(int64_t fromTime, int64_t toTime) const
+{
+    std::vector<TopicSample> copied;
+    QReadLocker locker(&m_lock);
+
+    for (size_t i = m_history.size(); i-- > 0;)
+    {
+        const TopicSample& slot = m_history.at(i);
+        if (slot.sourceTime >= fromTime && slot.sourceTime <= toTime)
+        {
+            copied.push_back(slot);
+        }
+    }
+    return copied;
+}
+
+
+//------------------------------------------------------------------------------
+std::vector<TopicSample> TopicSampleStore::copySlotsSince(uint64_t sequence,
+                                                          size_t limit) const
+{
+    std::vector<TopicSample> copied;
+    QReadLocker locker(&m_lock);
+
+    // Sequences grow with every insert, so the new slots are the newest ones
+    const size_t available = std::min(limit, m_history.size());
+    size_t count = 0;
+    while (count < available && m_history.at(count).sequence > sequence)
+    {
+        ++count;
+    }
+
+    copied.reserve(count);
+    for (size_t i = count; i-- > 0;)
+    {
+        copied.push_back(m_history.at(i));
+    }
+    return copied;
+}
+
+
+//------------------------------------------------------------------------------
+bool TopicSampleStore::indexOf(uint64_t sequence, size_t& index) const
+{
+    QReadLocker locker(&m_lock);
+
+    // Sequences decrease with the index
+    size_t low = 0;
+    size_t high = m_history.size();
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (m_history.at(middle).sequence > sequence)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == m_history.size() || m_history.at(low).sequence != sequence)
+    {
+        return false;
+    }
+
+    index = low;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+QVector<int64_t> TopicSampleStore::sourceTimes() const
+{
+    QVector<int64_t> times;
+    QReadLocker locker(&m_lock);
+
+    times.reserve(static_cast<int>(m_history.size()));
+    for (size_t i = 0; i < m_history.size(); ++i)
+    {
+        times.push_back(m_history.at(i).sourceTime);
+    }
+    return times;
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicSampleStore::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_history.size();
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicSampleStore::capacity() const
+{
+    QReadLocker locker(&m_lock);
+    return m_history.capacity();
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::setCapacity(size_t capacity)
+{
+    // Declared before the lock so dropped samples are freed after unlocking
+    SampleRing<TopicSample> resized(capacity);
+    QWriteLocker locker(&m_lock);
+
+    if (capacity == m_history.capacity())
+    {
+        return;
+    }
+
+    // Copy the newest samples, oldest first, so the order is preserved
+    const size_t keep = std::min(m_history.size(), capacity);
+    size_t keptBytes = 0;
+    for (size_t i = keep; i-- > 0;)
+    {
+        const TopicSample& entry = m_history.at(i);
+        resized.push(entry);
+        keptBytes += entry.bytes;
+    }
+
+    m_totalBytes -= (m_bytes - keptBytes);
+    m_bytes = keptBytes;
+    std::swap(m_history, resized);
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicSampleStore::bytes() const
+{
+    QReadLocker locker(&m_lock);
+    return m_bytes;
+}
+
+
+//------------------------------------------------------------------------------
+bool TopicSampleStore::oldestSequence(uint64_t& sequence) const
+{
+    QReadLocker locker(&m_lock);
+    if (m_history.size() == 0)
+    {
+        return false;
+    }
+
+    sequence = m_history.at(m_history.size() - 1).sequence;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+bool TopicSampleStore::newestSequence(uint64_t& sequence) const
+{
+    QReadLocker locker(&m_lock);
+    if (m_history.size() == 0)
+    {
+        return false;
+    }
+
+    sequence = m_history.at(0).sequence;
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicSampleStore::evictOldest(size_t budget,
+                                     size_t quota,
+                                     uint64_t untilSequence,
+                                     size_t untilBytes)
+{
+    // Declared before the lock so the evicted samples are freed after unlocking
+    std::vector<TopicSample> evicted;
+    QWriteLocker locker(&m_lock);
+
+    evicted.reserve(std::min(quota, m_history.size()));
+    while (evicted.size() < quota &&
+           m_history.size() > 1 &&
+           m_bytes > untilBytes &&
+           m_totalBytes > budget &&
+           m_history.at(m_history.size() - 1).sequence < untilSequence)
+    {
+        evicted.push_back(m_history.popOldest());
+        m_bytes -= evicted.back().bytes;
+        m_totalBytes -= evicted.back().bytes;
+    }
+
+    return evicted.size();
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::clear()
+{
+    // Declared before the lock so the samples are freed after unlocking
+    std::vector<TopicSample> flushed;
+    QWriteLocker locker(&m_lock);
+
+    m_history.clear(flushed);
+    m_totalBytes -= m_bytes;
+    m_bytes = 0;
+    locker.unlock();
+
+    std::list<std::pair<uint64_t, std::shared_ptr<OpenDynamicData>>> decoded;
+    {
+        QMutexLocker cacheLocker(&m_decodeCacheMutex);
+        std::swap(m_decodeCache, decoded);
+    }
+
+    QWriteLocker trackedLocker(&m_trackedLock);
+    for (auto& entry : m_tracked)
+    {
+        entry.second.column->clear();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::trackMember(const std::shared_ptr<const MemberAccessor>& accessor,
+                                   ColumnType type,
+                                   size_t capacity)
+{
+    if (!accessor)
+    {
+        return;
+    }
+
+    // Register the column first, so every sample stored from now on is
+    // appended to it by the ingest path
+    std::shared_ptr<TrackedColumn> column;
+    {
+        QWriteLocker trackedLocker(&m_trackedLock);
+        TrackedEntry& entry = m_tracked[accessor->memberName()];
+        ++entry.users;
+        if (entry.column)
+        {
+            return;
+        }
+
+        column = std::make_shared<TrackedColumn>(accessor, type, capacity);
+        entry.column = column;
+
+        QWriteLocker locker(&m_lock);
+        m_trackedCount = m_tracked.size();
+    }
+
+    // Fill a separate column from the current history without holding any
+    // lock, since lazily stored samples may have to be decoded
+    TrackedColumn older(accessor, type, capacity);
+    const std::vector<TopicSample> history = copySlots(0, capacity);
+    for (const TopicSample& slot : history)
+    {
+        std::shared_ptr<OpenDynamicData> tree = slot.sample;
+        if (!tree && !slot.flat && slot.serialized)
+        {
+            tree = slot.serialized->decode();
+        }
+        older.append(slot, tree);
+    }
+
+    // Samples stored meanwhile are in both columns and are matched by sequence
+    QWriteLocker trackedLocker(&m_trackedLock);
+    const auto found = m_tracked.find(accessor->memberName());
+    if (found != m_tracked.end() && found->second.column == column)
+    {
+        column->backfill(older);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::untrackMember(const std::string& memberName)
+{
+    // Declared before the lock so the column is freed after unlocking
+    std::shared_ptr<TrackedColumn> removed;
+    QWriteLocker trackedLocker(&m_trackedLock);
+
+    const auto found = m_tracked.find(memberName);
+    if (found == m_tracked.end())
+    {
+        return;
+    }
+
+    if (--found->second.users <= 0)
+    {
+        removed = found->second.column;
+        m_tracked.erase(found);
+
+        QWriteLocker locker(&m_lock);
+        m_trackedCount = m_tracked.size();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool TopicSampleStore::isTracked(const std::string& memberName) const
+{
+    QReadLocker trackedLocker(&m_trackedLock);
+    return m_tracked.find(memberName) != m_tracked.end();
+}
+
+
+//------------------------------------------------------------------------------
+bool TopicSampleStore::hasTracked() const
+{
+    return m_trackedCount > 0;
+}
+
+
+//------------------------------------------------------------------------------
+void TopicSampleStore::appendTracked(const TopicSample& slot)
+{
+    // Never decode here. Topics with tracked members are not stored lazily,
+    // so only a sample serialized just before tracking started is skipped.
+    if (m_tracked.empty() || (slot.serialized && !slot.sample && !slot.flat))
+    {
+        return;
+    }
+
+    for (auto& entry : m_tracked)
+    {
+        entry.second.column->append(slot, slot.sample);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicSampleStore::totalBytes()
+{
+    return m_totalBytes;
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicSampleStore::sampleSize(const std::shared_ptr<OpenDynamicData>& sample)
+{
+    return sample ? sample->getDecodedSize() : 0;
+}
+
+
+//------------------------------------------------------------------------------
+size_t TopicSampleStore::sampleSize(DDS::DynamicData_ptr sample)
+{
+    if (!sample)
+    {
+        return 0;
+    }
+
+    DDS::DynamicType_var type = OpenDDS::XTypes::get_base_type(sample->type());
+    if (!type)
+    {
+        return 0;
+    }
+
+    size_t size = sizeof(DDS::DynamicData);
+    const CORBA::ULong count = sample->get_item_count();
+
+    // All elements of a collection share one type, so it is resolved once.
+    // Primitive elements are counted without visiting them.
+    const DDS::TypeKind kind = type->get_kind();
+    const bool collection = (kind == OpenDDS::XTypes::TK_SEQUENCE || kind == OpenDDS::XTypes::TK_ARRAY);
+    DDS::DynamicType_var elementType;
+    if (collection)
+    {
+        elementType = itemType(type, 0);
+        if (!elementType)
+        {
+            return size;
+        }
+
+        const size_t primitive = primitiveSize(elementType->get_kind());
+        if (primitive > 0)
+        {
+            return size + count * primitive;
+        }
+    }
+
+    for (CORBA::ULong i = 0; i < count; ++i)
+    {
+        const DDS::MemberId id = sample->get_member_id_at_index(i);
+        DDS::DynamicType_var memberType = collection ?
+            DDS::DynamicType::_duplicate(elementType.in()) : itemType(type, id);
+        if (!memberType)
+        {
+            continue;
+        }
+
+        const DDS::TypeKind memberKind = memberType->get_kind();
+        const size_t primitive = primitiveSize(memberKind);
+        if (primitive > 0)
+        {
+            size += primitive;
+        }
+        else if (memberKind == OpenDDS::XTypes::TK_STRING8)
+        {
+            CORBA::String_var value;
+            if (sample->get_string_value(value, id) == DDS::RETCODE_OK)
+            {
+                size += sizeof(CORBA::ULong) + std::strlen(value.in()) + 1;
+            }
+        }
+        else
+        {
+            DDS::DynamicData_var member;
+            if (sample->get_complex_value(member, id) == DDS::RETCODE_OK)
+            {
+                size += sampleSize(member.in());
+            }
+        }
+    }
+
+    return size;
+}
+
+
+/**
+ * @}
+ */
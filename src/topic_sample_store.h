@@ -0,0 +1,479 @@
+#ifndef __TOPIC_SAMPLE_STORE_H__
+#define __TOPIC_SAMPLE_STORE_H__
+
+#include "sample_ring.h"
+#include "tracked_column.h"
+
+#ifdef WIN32
+#pragma warning(push, 0)  //No DDS warnings
+#endif
+
+#include <dds/DdsDynamicDataC.h>
+#include <dds/DCPS/GuidUtils.h>
+
+#ifdef WIN32
+#pragma warning(pop)
+#endif
+
+#include <QReadWriteLock>
+#include <QReadLocker>
+#include <QVector>
+#include <QMutex>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class FlatSample;
+class MemberAccessor;
+class OpenDynamicData;
+class SerializedSample;
+
+
+/**
+ * @brief A single history slot of a topic.
+ * @details Only one of the sample members is set, depending on the type
+ *          discovery mode of the topic and whether lazy decoding is enabled.
+ */
+struct TopicSample
+{
+    /// The sample when the topic is monitored through a TypeCode recorder.
+    std::shared_ptr<OpenDynamicData> sample;
+
+    /// The undecoded sample when lazy decoding is enabled.
+    std::shared_ptr<const SerializedSample> serialized;
+
+    /// The compact decoded sample of an unfiltered TypeCode topic.
+    std::shared_ptr<const FlatSample> flat;
+
+    /// The sample when the topic is monitored through a DynamicDataReader.
+    DDS::DynamicData_var dynamicSample;
+
+    /// The source timestamp in nanoseconds since the Unix epoch.
+    int64_t sourceTime = 0;
+
+    /// The local reception time in nanoseconds since the Unix epoch.
+    int64_t receptionTime = 0;
+
+    /// The decoded size of the sample in bytes.
+    size_t bytes = 0;
+
+    /// The GUID of the data writer that published the sample, if known.
+    OpenDDS::DCPS::GUID_t writer = OpenDDS::DCPS::GUID_UNKNOWN;
+
+    /// Global insertion order across all topics, starting at 1. Lower is older.
+    uint64_t sequence = 0;
+};
+
+
+/**
+ * @brief Stores the sample history of one DDS topic.
+ * @details Every topic owns its own store and lock, so ingest on one topic
+ *          never blocks readers of another. A single listener thread writes
+ *          while any number of GUI readers may read concurrently.
+ * @remarks Stored samples are never modified after they are inserted, so
+ *          readers only hold the lock long enough to copy out a reference.
+ */
+class TopicSampleStore
+{
+public:
+
+    /**
+     * @brief Constructor for the topic sample store.
+     * @param[in] capacity The maximum number of samples to keep.
+     */
+    explicit TopicSampleStore(size_t capacity);
+
+    /**
+     * @brief Destructor for the topic sample store.
+     */
+    ~TopicSampleStore();
+
+    /**
+     * @brief Store a new sample, evicting the oldest one if full.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receptionTime The reception time in nanoseconds.
+     * @param[in] sample The data sample of the topic.
+     * @param[in] writer The GUID of the data writer.
+     */
+    void storeSample(int64_t sourceTime,
+                     int64_t receptionTime,
+                     const std::shared_ptr<OpenDynamicData> sample,
+                     const OpenDDS::DCPS::GUID_t& writer = OpenDDS::DCPS::GUID_UNKNOWN);
+
+    /**
+     * @brief Store a new undecoded sample, evicting the oldest one if full.
+     * @details The sample is decoded the first time it is read.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receptionTime The reception time in nanoseconds.
+     * @param[in] sample The serialized data sample of the topic.
+     * @param[in] writer The GUID of the data writer.
+     */
+    void storeSerializedSample(int64_t sourceTime,
+                               int64_t receptionTime,
+                               const std::shared_ptr<const SerializedSample> sample,
+                               const OpenDDS::DCPS::GUID_t& writer = OpenDDS::DCPS::GUID_UNKNOWN);
+
+    /**
+     * @brief Store a new flat sample, evicting the oldest one if full.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receptionTime The reception time in nanoseconds.
+     * @param[in] sample The flat data sample of the topic.
+     * @param[in] writer The GUID of the data writer.
+     */
+    void storeFlatSample(int64_t sourceTime,
+                         int64_t receptionTime,
+                         const std::shared_ptr<const FlatSample> sample,
+                         const OpenDDS::DCPS::GUID_t& writer = OpenDDS::DCPS::GUID_UNKNOWN);
+
+    /**
+     * @brief Store a new DynamicData sample, evicting the oldest one if full.
+     * @param[in] sourceTime The source timestamp in nanoseconds.
+     * @param[in] receptionTime The reception time in nanoseconds.
+     * @param[in] sample The data sample of the topic.
+     * @param[in] writer The GUID of the data writer.
+     */
+    void storeDynamicSample(int64_t sourceTime,
+                            int64_t receptionTime,
+                            const DDS::DynamicData_var sample,
+                            const OpenDDS::DCPS::GUID_t& writer = OpenDDS::DCPS::GUID_UNKNOWN);
+
+    /**
+     * @brief Store a batch of DynamicData samples with one lock acquisition.
+     * @details Each slot needs its dynamicSample, times and writer; the sizes
+     *          are filled in here. Evicted samples are released by the caller
+     *          when it clears the batch, outside of the lock.
+     * @param[in,out] batch The samples, oldest first. Holds the evicted
+     *                slots on return.
+     */
+    void storeDynamicSamples(std::vector<TopicSample>& batch);
+
+    /**
+     * @brief Get a stored sample as a tree.
+     * @details Samples stored serialized are decoded and flat samples are
+     *          converted on the first read.
+     * @param[in] index The sample index. 0 is the newest.
+     * @return The data sample or nullptr if the index wasn't found.
+     */
+    std::shared_ptr<OpenDynamicData> sample(size_t index) const;
+
+    /**
+     * @brief Get a slot copied out of this store as a tree.
+     * @param[in] slot The copied history slot.
+     * @return The data sample, or nullptr for DynamicData slots.
+     */
+    std::shared_ptr<OpenDynamicData> sample(const TopicSample& slot) const;
+
+    /**
+     * @brief Get a stored flat sample.
+     * @param[in] index The sample index. 0 is the newest.
+     * @return The flat sample or nullptr if the index wasn't found or the
+     *         sample was not stored flat.
+     */
+    std::shared_ptr<const FlatSample> flatSample(size_t index) const;
+
+    /**
+     * @brief Get a stored DynamicData sample.
+     * @param[in] index The sample index. 0 is the newest.
+     * @return The data sample or nil if the index wasn't found.
+     */
+    DDS::DynamicData_var dynamicSample(size_t index) const;
+
+    /**
+     * @brief Copy a range of history slots under a single lock.
+     * @details Only references are copied, so the samples are decoded and
+     *          read afterwards without holding the lock.
+     * @param[in] first The index of the newest slot to copy. 0 is the newest.
+     * @param[in] count The maximum number of slots to copy.
+     * @return The slots, oldest first.
+     */
+    std::vector<TopicSample> copySlots(size_t first, size_t count) const;
+
+    /**
+     * @brief Copy the history slots within a source time range under a single lock.
+     * @param[in] fromTime The earliest source timestamp in nanoseconds.
+     * @param[in] toTime The latest source timestamp in nanoseconds.
+     * @return The slots, oldest first.
+     */
+    std::vector<TopicSample> copySlotsInTimeRange(int64_t fromTime, int64_t toTime) const;
+
+    /**
+     * @brief Copy the history slots stored after a given sample under a single lock.
+     * @details Only the new slots are visited, so polling for new samples
+     *          costs nothing while none arrive.
+     * @param[in] sequence The sequence of the newest sample already seen.
+     *            0 copies the whole history.
+     * @param[in] limit The maximum number of slots to copy. The newest
+     *            ones are kept, so a consumer that only shows a fixed
+     *            window never copies more than it can show.
+     * @return The slots with a higher sequence, oldest first.
+     */
+    std::vector<TopicSample> copySlotsSince(uint64_t sequence,
+                                            size_t limit = SIZE_MAX) const;
+
+    /**
+     * @brief Find the current index of a stored sample.
+     * @details The history is ordered by sequence, so this is a binary search.
+     * @param[in] sequence The sequence of the sample.
+     * @param[out] index The sample index. 0 is the newest.
+     * @return True if the sample is still stored; false otherwise.
+     */
+    bool indexOf(uint64_t sequence, size_t& index) const;
+
+    /**
+     * @brief Get the source timestamps of the stored samples, newest first.
+     * @return The source timestamps in nanoseconds since the Unix epoch.
+     */
+    QVector<int64_t> sourceTimes() const;
+
+    /**
+     * @brief Get the number of stored samples.
+     * @return The number of stored samples.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the history depth of this topic.
+     * @return The maximum number of samples kept.
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Change the history depth of this topic.
+     * @details The newest samples are kept when the depth shrinks.
+     * @param[in] capacity The new maximum number of samples to keep.
+     */
+    void setCapacity(size_t capacity);
+
+    /**
+     * @brief Get the decoded size of all samples in this store.
+     * @return The size in bytes.
+     */
+    size_t bytes() const;
+
+    /**
+     * @brief Get the insertion order of the oldest sample.
+     * @param[out] sequence The sequence of the oldest sample.
+     * @return True if the store holds at least one sample; false otherwise.
+     */
+    bool oldestSequence(uint64_t& sequence) const;
+
+    /**
+     * @brief Get the insertion order of the newest sample.
+     * @param[out] sequence The sequence of the newest sample.
+     * @return True if the store holds at least one sample; false otherwise.
+     */
+    bool newestSequence(uint64_t& sequence) const;
+
+    /**
+     * @brief Evict a batch of the oldest samples under a single lock. Used to
+     *        enforce the memory budget. The newest sample is always kept.
+     * @details Eviction stops as soon as the total size of all stores is
+     *          within the budget, the quota is reached, the oldest sample
+     *          is not older than untilSequence, or this store has shrunk to
+     *          untilBytes.
+     * @param[in] budget The total size of all stores to reach.
+     * @param[in] quota The maximum number of samples to evict.
+     * @param[in] untilSequence Stop before evicting this sequence or newer.
+     * @param[in] untilBytes Stop once this store is no larger than this.
+     * @return The number of samples evicted.
+     */
+    size_t evictOldest(size_t budget,
+                       size_t quota,
+                       uint64_t untilSequence,
+                       size_t untilBytes);
+
+    /**
+     * @brief Delete all stored samples and tracked points.
+     */
+    void clear();
+
+    /**
+     * @brief Start recording a numeric member into a tracked column.
+     * @details Tracking is reference counted: each call must be matched by
+     *          untrackMember(). A new column is filled from the current
+     *          history outside the locks, then every stored sample appends
+     *          its value after leaving the history lock.
+     * @param[in] accessor The member to track.
+     * @param[in] type The storage type of the values.
+     * @param[in] capacity The maximum number of points to keep.
+     */
+    void trackMember(const std::shared_ptr<const MemberAccessor>& accessor,
+                     ColumnType type,
+                     size_t capacity);
+
+    /**
+     * @brief Stop recording a member once its last user is gone.
+     * @param[in] memberName The member path.
+     */
+    void untrackMember(const std::string& memberName);
+
+    /**
+     * @brief Check whether a member is tracked.
+     * @param[in] memberName The member path.
+     * @return True if the member has a tracked column; false otherwise.
+     */
+    bool isTracked(const std::string& memberName) const;
+
+    /**
+     * @brief Check whether any member is tracked.
+     * @details Lazy decoding is skipped for topics with tracked members, so
+     *          the ingest path never has to decode a serialized sample.
+     * @return True if at least one member is tracked; false otherwise.
+     */
+    bool hasTracked() const;
+
+    /**
+     * @brief Copy the newest points of a tracked member, oldest first.
+     * @param[in] memberName The member path.
+     * @param[out] times The source timestamps in nanoseconds.
+     * @param[out] values The values converted to T.
+     * @param[in] maxCount The maximum number of points to copy.
+     * @return The number of points copied, or -1 if the member isn't tracked.
+     */
+    template<typename T>
+    int readTracked(const std::string& memberName,
+                    QVector<int64_t>& times,
+                    QVector<T>& values,
+                    size_t maxCount) const
+    {
+        QReadLocker locker(&m_trackedLock);
+        const auto found = m_tracked.find(memberName);
+        if (found == m_tracked.end())
+        {
+            return -1;
+        }
+        return found->second.column->copy(times, values, maxCount);
+    }
+
+    /**
+     * @brief Copy the points of a tracked member stored after a cursor, oldest first.
+     * @param[in] memberName The member path.
+     * @param[in] sequence The sequence of the newest sample already read.
+     * @param[out] sequences The sequence of the sample of each point.
+     * @param[out] values The values converted to T.
+     * @return The number of points copied, or -1 if the member isn't tracked.
+     */
+    template<typename T>
+    int readTrackedSince(const std::string& memberName,
+                         uint64_t sequence,
+                         QVector<uint64_t>& sequences,
+                         QVector<T>& values) const
+    {
+        QReadLocker locker(&m_trackedLock);
+        const auto found = m_tracked.find(memberName);
+        if (found == m_tracked.end())
+        {
+            return -1;
+        }
+        return found->second.column->copySince(sequence, sequences, values);
+    }
+
+    /**
+     * @brief Get the decoded size of the samples in every store.
+     * @return The size in bytes.
+     */
+    static size_t totalBytes();
+
+    /**
+     * @brief Calculate the decoded size of a sample.
+     * @param[in] sample The data sample.
+     * @return The size in bytes.
+     */
+    static size_t sampleSize(const std::shared_ptr<OpenDynamicData>& sample);
+
+    /**
+     * @brief Calculate the decoded size of a DynamicData sample.
+     * @details Collections of primitives are counted as element count times
+     *          element size, so the cost grows with the number of members
+     *          rather than the number of elements.
+     * @param[in] sample The data sample.
+     * @return The size in bytes.
+     */
+    static size_t sampleSize(DDS::DynamicData_ptr sample);
+
+    /// The number of lazily decoded or converted samples kept per topic.
+    static const size_t DECODE_CACHE_SIZE = 8;
+
+private:
+
+    /**
+     * @brief Insert a prepared slot and enforce the memory budget.
+     * @param[in,out] newSample The slot to store. Holds the evicted slot on return.
+     */
+    void store(TopicSample& newSample);
+
+    /**
+     * @brief Insert prepared slots under one lock and enforce the memory budget.
+     * @param[in,out] samples The slots to store, oldest first. Each holds the
+     *                slot it evicted on return.
+     * @param[in] count The number of slots.
+     */
+    void store(TopicSample* samples, size_t count);
+
+    /**
+     * @brief Append a new sample to the tracked columns.
+     * @details Serialized samples are never decoded here and are skipped.
+     * @remarks The caller must hold m_trackedLock for writing.
+     * @param[in] slot The new history slot.
+     */
+    void appendTracked(const TopicSample& slot);
+
+    /**
+     * @brief Build the tree of a serialized or flat sample, reusing a recent
+     *        result if possible.
+     * @param[in] slot A copy of the history slot.
+     * @return The decoded sample.
+     */
+    std::shared_ptr<OpenDynamicData> decode(const TopicSample& slot) const;
+
+    /// Protects m_history and m_bytes. Written by the listener, read by the GUI.
+    mutable QReadWriteLock m_lock;
+
+    /// The sample history. Index 0 is the newest sample.
+    SampleRing<TopicSample> m_history;
+
+    /// The decoded size of the samples in m_history.
+    size_t m_bytes;
+
+    /// Protects m_decodeCache. Never held while decoding.
+    mutable QMutex m_decodeCacheMutex;
+
+    /// Recently decoded serialized or flat samples by sequence. The front is the newest.
+    mutable std::list<std::pair<uint64_t, std::shared_ptr<OpenDynamicData>>> m_decodeCache;
+
+    /// A tracked column and the number of consumers using it.
+    struct TrackedEntry
+    {
+        std::shared_ptr<TrackedColumn> column;
+        int users = 0;
+    };
+
+    /// Protects m_tracked. Taken before m_lock when both are needed.
+    mutable QReadWriteLock m_trackedLock;
+
+    /// The tracked columns by member path.
+    std::map<std::string, TrackedEntry> m_tracked;
+
+    /// The size of m_tracked. Written under both locks, so the ingest path
+    /// reads it under m_lock alone.
+    std::atomic<size_t> m_trackedCount;
+
+    /// The decoded size of the samples in every store.
+    static std::atomic<size_t> m_totalBytes;
+
+    /// Source of TopicSample::sequence.
+    static std::atomic<uint64_t> m_nextSequence;
+
+}; // End class TopicSampleStore
+
+#endif
+
+/**
+ * @}
+ */
@@ -73,10 +73,17 @@ void TopicTableModel::setSample(std::shared_ptr<OpenDynamicData> sample)
         return;
     }
 
+    m_sample = sample;
+
+    // Samples of the same shape only refresh the values that changed
+    if (updateRows([this]() { parseData(m_sample); }))
+    {
+        return;
+    }
+
     emit layoutAboutToBeChanged();
 
     cleanupDataRow();
-    m_sample = sample;
     parseData(m_sample);
 
     emit layoutChanged();
@@ -91,12 +98,18 @@ void TopicTableModel::setSample(DDS::DynamicData_var sample)
         return;
     }
 
+    // Store sample for reverting any changes to it.
+    m_dynamicSample = sample;
+
+    // Samples of the same shape only refresh the values that changed
+    if (updateRows([this]() { parseData(m_dynamicSample, ""); }))
+    {
+        return;
+    }
+
     emit layoutAboutToBeChanged();
 
     cleanupDataRow();
-
-    // Store sample for reverting any changes to it.
-    m_dynamicSample = sample;
     parseData(m_dynamicSample, "");
 
     emit layoutChanged();
@@ -105,12 +118,6 @@ void TopicTableModel::setSample(DDS::DynamicData_var sample)
 //------------------------------------------------------------------------------
 const std::shared_ptr<OpenDynamicData> TopicTableModel::commitSample()
 {
-    // Reset the edited state
-    for (size_t i = 0; i < m_data.size(); ++i)
-    {
-        m_data.at(i)->setEdited(false);
-    }
-
     // Create a new sample
     std::shared_ptr<TopicInfo> topicInfo = CommonData::getTopicInfo(m_topicName);
     if (!topicInfo || topicInfo->typeMode() != TypeDiscoveryMode::TypeCode)
@@ -130,7 +137,7 @@ const std::shared_ptr<OpenDynamicData> TopicTableModel::commitSample()
         populateSample(newSample, m_data.at(i));
     }
 
-    // Replace and delete the old sample
+    // Replace and delete the old sample. This also resets the edited state.
     setSample(newSample);
 
     return newSample;
@@ -373,22 +380,22 @@ void TopicTableModel::parseData(const std::shared_ptr<OpenDynamicData> data)
         if(child->isContainerType())
         {
             parseData(child);
+            if (m_shapeChanged)
+            {
+                return;
+            }
             continue;
         }
 
-        DataRow* dataRow = new DataRow(this,
-                                       child->getFullName().c_str(),
-                                       child->getKind(),
-                                       false, // TODO
-                                       false);
-
-        // Update the current editor delegate
         const int thisRow = static_cast<int>(m_data.size());
-        if (m_tableView->itemDelegateForRow(thisRow))
+        DataRow* dataRow = nextRow(child->getFullName().c_str(),
+                                   child->getKind(),
+                                   false, // TODO
+                                   false);
+        if (!dataRow)
         {
-            delete m_tableView->itemDelegateForRow(thisRow);
+            return;
         }
-        m_tableView->setItemDelegateForRow(thisRow, new LineEditDelegate(this));
 
         // Store the value into a QVariant
         // The tmpValue may seem redundant, but it's very helpful for debug
@@ -485,24 +492,28 @@ void TopicTableModel::parseData(const std::shared_ptr<OpenDynamicData> data)
                 break;
             }
 
-            // Remove the old delegate
-            if (m_tableView->itemDelegateForRow(thisRow))
+            // The delegate of an updated row already lists the enumerators
+            if (!m_updating)
             {
-                delete m_tableView->itemDelegateForRow(thisRow);
-            }
+                // Remove the old delegate
+                if (m_tableView->itemDelegateForRow(thisRow))
+                {
+                    delete m_tableView->itemDelegateForRow(thisRow);
+                }
 
-            // Install the new delegate
-            ComboDelegate *enumDelegate = new ComboDelegate(this);
-            for (CORBA::ULong enumIndex = 0; enumIndex < enumMemberCount; ++enumIndex)
-            {
-                QString stringValue = enumTypeCode->member_name(enumIndex);
-                if (!stringValue.isEmpty())
+                // Install the new delegate
+                ComboDelegate *enumDelegate = new ComboDelegate(this);
+                for (CORBA::ULong enumIndex = 0; enumIndex < enumMemberCount; ++enumIndex)
                 {
-                    enumDelegate->addItem(stringValue, static_cast<int>(enumIndex));
+                    QString stringValue = enumTypeCode->member_name(enumIndex);
+                    if (!stringValue.isEmpty())
+                    {
+                        enumDelegate->addItem(stringValue, static_cast<int>(enumIndex));
+                    }
                 }
-            }
 
-            m_tableView->setItemDelegateForRow(thisRow, enumDelegate);
+                m_tableView->setItemDelegateForRow(thisRow, enumDelegate);
+            }
             dataRow->setValue(enumTypeCode->member_name(enumValue));
             break;
         }
@@ -511,11 +522,99 @@ void TopicTableModel::parseData(const std::shared_ptr<OpenDynamicData> data)
             dataRow->setValue("NULL");
             break;
         }
+    }
+}
+
+//------------------------------------------------------------------------------
+TopicTableModel::DataRow* TopicTableModel::nextRow(const QString& name,
+                                                   CORBA::TCKind kind,
+                                                   bool isKey,
+                                                   bool isOptional)
+{
+    if (!m_updating)
+    {
+        DataRow* dataRow = new DataRow(this, name, kind, isKey, isOptional);
+
+        // Update the current editor delegate
+        const int thisRow = static_cast<int>(m_data.size());
+        if (m_tableView->itemDelegateForRow(thisRow))
+        {
+            delete m_tableView->itemDelegateForRow(thisRow);
+        }
+        m_tableView->setItemDelegateForRow(thisRow, new LineEditDelegate(this));
 
         m_data.push_back(dataRow);
+        return dataRow;
+    }
+
+    // Reuse the existing row if it holds the same member
+    if (m_shapeChanged ||
+        m_parseRow >= m_data.size() ||
+        m_data[m_parseRow]->getType() != kind ||
+        m_data[m_parseRow]->getName() != name)
+    {
+        m_shapeChanged = true;
+        return nullptr;
     }
+
+    DataRow* dataRow = m_data[m_parseRow++];
+
+    // A new sample discards unpublished edits, like a rebuild would
+    if (dataRow->getEdited())
+    {
+        dataRow->setEdited(false);
+        dataRow->setChanged(true);
+    }
+    return dataRow;
 }
 
+
+//------------------------------------------------------------------------------
+bool TopicTableModel::updateRows(const std::function<void()>& parse)
+{
+    if (m_data.empty())
+    {
+        return false;
+    }
+
+    for (DataRow* dataRow : m_data)
+    {
+        dataRow->setChanged(false);
+    }
+
+    m_updating = true;
+    m_shapeChanged = false;
+    m_parseRow = 0;
+    parse();
+    m_updating = false;
+
+    // A different member list, such as a resized sequence, needs new rows
+    if (m_shapeChanged || m_parseRow != m_data.size())
+    {
+        m_shapeChanged = false;
+        return false;
+    }
+
+    // Notify the view once per run of changed values
+    const int count = static_cast<int>(m_data.size());
+    int firstChanged = -1;
+    for (int row = 0; row <= count; ++row)
+    {
+        const bool changed = (row < count) && m_data[row]->getChanged();
+        if (changed && firstChanged < 0)
+        {
+            firstChanged = row;
+        }
+        else if (!changed && firstChanged >= 0)
+        {
+            emit dataChanged(index(firstChanged, VALUE_COLUMN), index(row - 1, VALUE_COLUMN));
+            firstChanged = -1;
+        }
+    }
+    return true;
+}
+
+
 //------------------------------------------------------------------------------
 CORBA::TCKind TopicTableModel::typekind_to_tckind(DDS::TypeKind tk)
 {
@@ -777,6 +876,10 @@ void TopicTableModel::parseCollection(const DDS::DynamicData_var& data, const st
             } else {
                 std::string scoped_elem_name = namePrefix + "[" + std::to_string(i) + "]";
                 parseData(nested_data, scoped_elem_name);
+                if (m_shapeChanged)
+                {
+                    return;
+                }
             }
             continue;
         }
@@ -785,23 +888,17 @@ void TopicTableModel::parseCollection(const DDS::DynamicData_var& data, const st
         const std::string scoped_elem_name = namePrefix + "[" + std::to_string(i) + "]";
 
         // DataRow for each element
-        DataRow* data_row = new DataRow(this,
-                                        scoped_elem_name.c_str(),
-                                        typekind_to_tckind(elem_tk),
-                                        false, // TODO: Get the right value from the containing type
-                                        false // TODO: Get the right value from the containing type
-                                        );
-
-        // Update the current editor delegate
-        const int thisRow = static_cast<int>(m_data.size());
-        if (m_tableView->itemDelegateForRow(thisRow))
+        DataRow* data_row = nextRow(scoped_elem_name.c_str(),
+                                    typekind_to_tckind(elem_tk),
+                                    false, // TODO: Get the right value from the containing type
+                                    false // TODO: Get the right value from the containing type
+                                    );
+        if (!data_row)
         {
-            delete m_tableView->itemDelegateForRow(thisRow);
+            return;
         }
-        m_tableView->setItemDelegateForRow(thisRow, new LineEditDelegate(this));
 
         setDataRow(data_row, data, id);
-        m_data.push_back(data_row);
     }
 }
 
@@ -844,28 +941,26 @@ void TopicTableModel::parseAggregated(const DDS::DynamicData_var& data, const st
                 std::cerr << "get_complex_value for member Id " << id << " failed" << std::endl;
             } else {
                 parseData(nested_data, scoped_member_name);
+                if (m_shapeChanged)
+                {
+                    return;
+                }
             }
             continue;
         }
         }
 
         // DataRow for each member
-        DataRow* data_row = new DataRow(this,
-                                        scoped_member_name.c_str(),
-                                        typekind_to_tckind(member_tk),
-                                        md->is_key(), // TODO: Handle implicit key case
-                                        md->is_optional());
-
-        // Update the current editor delegate
-        const int thisRow = static_cast<int>(m_data.size());
-        if (m_tableView->itemDelegateForRow(thisRow))
+        DataRow* data_row = nextRow(scoped_member_name.c_str(),
+                                    typekind_to_tckind(member_tk),
+                                    md->is_key(), // TODO: Handle implicit key case
+                                    md->is_optional());
+        if (!data_row)
         {
-            delete m_tableView->itemDelegateForRow(thisRow);
+            return;
         }
-        m_tableView->setItemDelegateForRow(thisRow, new LineEditDelegate(this));
 
         setDataRow(data_row, data, id);
-        m_data.push_back(data_row);
     }
 }
 
@@ -1067,6 +1162,7 @@ TopicTableModel::DataRow::DataRow(TopicTableModel* parent, QString name,
     , m_isKey(isKey)
     , m_isOptional(isOptional)
     , m_edited(false)
+    , m_changed(false)
 {}
 
 
@@ -1231,6 +1327,10 @@ bool TopicTableModel::DataRow::setValue(const QVariant& newValue)
 
     if (pass)
     {
+        if (m_value != origValue)
+        {
+            m_changed = true;
+        }
         m_value = origValue;
         m_displayedValue = dispValue;
         return true;
@@ -12,6 +12,7 @@
 #include <QHeaderView>
 #include <QTableView>
 
+#include <functional>
 #include <memory>
 
 class OpenDynamicData;
@@ -274,6 +275,16 @@ private:
             m_edited = edited;
         }
 
+        bool getChanged() const
+        {
+            return m_changed;
+        }
+
+        void setChanged(bool changed)
+        {
+            m_changed = changed;
+        }
+
         void updateDisplayedValue();
 
     private:
@@ -303,8 +314,34 @@ private:
 
         /// The topic member edited flag.
         bool m_edited;
+
+        /// Set when setValue() stores a different value.
+        bool m_changed;
     };
 
+    /**
+     * @brief Get the row for the next member found while parsing a sample.
+     * @details While rebuilding, a new row is appended with a line edit
+     *          delegate. While updating, the existing row at the parse
+     *          position is reused if it holds the same member.
+     * @param[in] name The full member name.
+     * @param[in] kind The member type.
+     * @param[in] isKey The member key flag.
+     * @param[in] isOptional The member is optional flag.
+     * @return The row to fill, or nullptr if the sample has a different shape.
+     */
+    DataRow* nextRow(const QString& name, CORBA::TCKind kind, bool isKey, bool isOptional);
+
+    /**
+     * @brief Refresh the values of the existing rows from a new sample.
+     * @details Only the runs of rows whose value changed are reported with
+     *          dataChanged, so the view keeps its rows and delegates.
+     * @param[in] parse Parses the new sample through nextRow().
+     * @return True if the sample matched the rows and was applied; false if
+     *         the rows must be rebuilt.
+     */
+    bool updateRows(const std::function<void()>& parse);
+
     /**
      * @brief Recursively parse a dynamic data structure and copy the contents
      *        into m_data;
@@ -353,6 +390,15 @@ private:
     /// The name of the topic for this data model
     QString m_topicName;
 
+    /// True while updateRows() reuses the existing rows.
+    bool m_updating = false;
+
+    /// Set while updating if the sample doesn't match the existing rows.
+    bool m_shapeChanged = false;
+
+    /// The row reused for the next member while updating.
+    size_t m_parseRow = 0;
+
 };
 
 #endif
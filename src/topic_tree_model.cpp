@@ -0,0 +1,410 @@
+#include "topic_tree_model.h"
+#include "open_dynamic_data.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <unordered_set>
+
+
+namespace
+{
+
+/// True if the member kind has children.
+bool isContainer(CORBA::TCKind kind)
+{
+    switch (kind)
+    {
+    case CORBA::tk_struct:
+    case CORBA::tk_union:
+    case CORBA::tk_sequence:
+    case CORBA::tk_array:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Get the name of a member type for the type column.
+QString typeName(CORBA::TCKind kind)
+{
+    switch (kind)
+    {
+    case CORBA::tk_short: return "int16";
+    case CORBA::tk_long: return "int32";
+    case CORBA::tk_ushort: return "uint16";
+    case CORBA::tk_ulong: return "uint32";
+    case CORBA::tk_longlong: return "int64";
+    case CORBA::tk_ulonglong: return "uint64";
+    case CORBA::tk_float: return "float32";
+    case CORBA::tk_double: return "float64";
+    case CORBA::tk_boolean: return "boolean";
+    case CORBA::tk_char: return "char";
+    case CORBA::tk_wchar: return "wchar";
+    case CORBA::tk_octet: return "uint8";
+    case CORBA::tk_enum: return "enum";
+    case CORBA::tk_string: return "string";
+    case CORBA::tk_struct: return "struct";
+    case CORBA::tk_union: return "union";
+    case CORBA::tk_sequence: return "sequence";
+    case CORBA::tk_array: return "array";
+    default: return "?";
+    }
+}
+
+/**
+ * @brief Read the value of a member for the value column.
+ * @details Collections show their length, which is known without reading
+ *          any element.
+ * @param[in] member The member. Either OpenDynamicData or FlatSample::Member.
+ * @return The value to display.
+ */
+template<typename Member>
+QVariant memberValue(const Member& member)
+{
+    switch (member.getKind())
+    {
+    case CORBA::tk_short: return static_cast<int>(member.template getValue<int16_t>());
+    case CORBA::tk_long: return member.template getValue<int32_t>();
+    case CORBA::tk_ushort: return static_cast<uint32_t>(member.template getValue<uint16_t>());
+    case CORBA::tk_ulong: return member.template getValue<uint32_t>();
+    case CORBA::tk_longlong: return static_cast<qint64>(member.template getValue<int64_t>());
+    case CORBA::tk_ulonglong: return static_cast<quint64>(member.template getValue<uint64_t>());
+    case CORBA::tk_float: return member.template getValue<float>();
+    case CORBA::tk_double: return member.template getValue<double>();
+    case CORBA::tk_boolean: return member.template getValue<bool>();
+    case CORBA::tk_char: return QChar(member.template getValue<char>());
+    case CORBA::tk_wchar: return QChar(static_cast<ushort>(member.template getValue<uint16_t>()));
+    case CORBA::tk_octet: return static_cast<uint32_t>(member.template getValue<uint8_t>());
+    case CORBA::tk_string: return QString(member.getStringValue());
+    case CORBA::tk_enum:
+    {
+        const CORBA::ULong value = member.template getValue<CORBA::ULong>();
+        const CORBA::TypeCode_var enumTypeCode = member.getTypeCode();
+        if (!enumTypeCode || value >= enumTypeCode->member_count())
+        {
+            return QString("INVALID");
+        }
+        return QString(enumTypeCode->member_name(value));
+    }
+    case CORBA::tk_sequence:
+    case CORBA::tk_array:
+        return QString::number(member.getLength()) + " elements";
+    default:
+        return QVariant();
+    }
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+TopicTreeModel::TopicTreeModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{
+    m_columnHeaders << "Name" << "Type" << "Value";
+}
+
+
+//------------------------------------------------------------------------------
+TopicTreeModel::~TopicTreeModel()
+{}
+
+
+//------------------------------------------------------------------------------
+void TopicTreeModel::setSample(const std::shared_ptr<OpenDynamicData>& sample)
+{
+    if (!sample)
+    {
+        return;
+    }
+
+    std::unique_ptr<Node> root(new Node);
+    root->tree = sample;
+    setRoot(std::move(root));
+
+    m_flatSample.reset();
+}
+
+
+//------------------------------------------------------------------------------
+void TopicTreeModel::setSample(const std::shared_ptr<const FlatSample>& sample)
+{
+    if (!sample)
+    {
+        return;
+    }
+
+    // Keep the previous sample alive until no node refers to it
+    const std::shared_ptr<const FlatSample> previous = m_flatSample;
+    m_flatSample = sample;
+
+    std::unique_ptr<Node> root(new Node);
+    root->flat = sample->root();
+    setRoot(std::move(root));
+}
+
+
+//------------------------------------------------------------------------------
+QModelIndex TopicTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (!hasIndex(row, column, parent))
+    {
+        return QModelIndex();
+    }
+    return createIndex(row, column, child(nodeAt(parent), row));
+}
+
+
+//------------------------------------------------------------------------------
+QModelIndex TopicTreeModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid())
+    {
+        return QModelIndex();
+    }
+
+    Node* parentNode = static_cast<Node*>(index.internalPointer())->parent;
+    if (!parentNode || parentNode == m_root.get())
+    {
+        return QModelIndex();
+    }
+    return createIndex(parentNode->row, 0, parentNode);
+}
+
+
+//------------------------------------------------------------------------------
+int TopicTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0)
+    {
+        return 0;
+    }
+
+    const Node* node = nodeAt(parent);
+    return node ? node->childCount : 0;
+}
+
+
+//------------------------------------------------------------------------------
+int TopicTreeModel::columnCount(const QModelIndex&) const
+{
+    return MAX_eColumnIds_VALUE;
+}
+
+
+//------------------------------------------------------------------------------
+QVariant TopicTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid())
+    {
+        return QVariant();
+    }
+
+    const Node* node = static_cast<const Node*>(index.internalPointer());
+    if (role == FULL_NAME_ROLE)
+    {
+        return node->fullName;
+    }
+
+    if (role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+
+    switch (index.column())
+    {
+    case NAME_COLUMN:
+        return node->name;
+    case TYPE_COLUMN:
+        return typeName(node->kind);
+    case VALUE_COLUMN:
+        if (node->tree)
+        {
+            return memberValue(*node->tree);
+        }
+        if (node->flat)
+        {
+            return memberValue(node->flat);
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+QVariant TopicTreeModel::headerData(int section,
+                                    Qt::Orientation orientation,
+                                    int role) const
+{
+    if (role == Qt::DisplayRole &&
+        orientation == Qt::Horizontal &&
+        section < m_columnHeaders.count())
+    {
+        return m_columnHeaders.at(section);
+    }
+    return QVariant();
+}
+
+
+//------------------------------------------------------------------------------
+void TopicTreeModel::readNode(Node& node) const
+{
+    if (node.tree)
+    {
+        node.name = QString::fromStdString(node.tree->getName());
+        node.kind = node.tree->getKind();
+        node.childCount = isContainer(node.kind) ?
+            static_cast<int>(std::min<size_t>(node.tree->getLength(), std::numeric_limits<int>::max())) : 0;
+    }
+    else if (node.flat)
+    {
+        node.name = QString::fromStdString(node.flat.getName());
+        node.kind = node.flat.getKind();
+        node.childCount = isContainer(node.kind) ?
+            static_cast<int>(std::min<size_t>(node.flat.getLength(), std::numeric_limits<int>::max())) : 0;
+    }
+    else
+    {
+        node.name = "?";
+        node.kind = CORBA::tk_null;
+        node.childCount = 0;
+    }
+
+    // Same naming as OpenDynamicData::getFullName: struct paths end with '.'
+    if (!node.parent)
+    {
+        node.fullName.clear();
+    }
+    else if (node.parent->kind == CORBA::tk_struct && node.parent->parent)
+    {
+        node.fullName = node.parent->fullName + "." + node.name;
+    }
+    else
+    {
+        node.fullName = node.parent->fullName + node.name;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TopicTreeModel::rebind(Node& node, std::vector<std::unique_ptr<Node>>& removed)
+{
+    const CORBA::TCKind previousKind = node.kind;
+    readNode(node);
+
+    for (auto it = node.children.begin(); it != node.children.end();)
+    {
+        Node& childNode = *it->second;
+        if (node.kind != previousKind || childNode.row >= node.childCount)
+        {
+            removed.push_back(std::move(it->second));
+            it = node.children.erase(it);
+            continue;
+        }
+
+        // Only one view may be set, since the readers prefer the tree
+        if (node.tree)
+        {
+            childNode.tree = node.tree->getMember(static_cast<size_t>(childNode.row));
+            childNode.flat = FlatSample::Member();
+        }
+        else
+        {
+            childNode.flat = node.flat.getMember(static_cast<size_t>(childNode.row));
+            childNode.tree.reset();
+        }
+
+        rebind(childNode, removed);
+        ++it;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void TopicTreeModel::setRoot(std::unique_ptr<Node> root)
+{
+    if (!m_root)
+    {
+        beginResetModel();
+        m_root = std::move(root);
+        readNode(*m_root);
+        endResetModel();
+        return;
+    }
+
+    // Point the nodes created so far at the new sample. The nodes themselves
+    // are kept, so the view keeps its expanded rows and selection.
+    emit layoutAboutToBeChanged();
+
+    m_root->tree = root->tree;
+    m_root->flat = root->flat;
+    std::vector<std::unique_ptr<Node>> removed;
+    rebind(*m_root, removed);
+
+    // Invalidate the indexes of members that shrank out of the new sample
+    if (!removed.empty())
+    {
+        std::unordered_set<const Node*> gone;
+        std::function<void(const Node&)> collect = [&](const Node& node)
+        {
+            gone.insert(&node);
+            for (const auto& entry : node.children)
+            {
+                collect(*entry.second);
+            }
+        };
+        for (const std::unique_ptr<Node>& node : removed)
+        {
+            collect(*node);
+        }
+
+        const QModelIndexList indexes = persistentIndexList();
+        for (const QModelIndex& index : indexes)
+        {
+            if (gone.count(static_cast<const Node*>(index.internalPointer())) > 0)
+            {
+                changePersistentIndex(index, QModelIndex());
+            }
+        }
+    }
+
+    emit layoutChanged();
+}
+
+
+//------------------------------------------------------------------------------
+TopicTreeModel::Node* TopicTreeModel::nodeAt(const QModelIndex& index) const
+{
+    return index.isValid() ? static_cast<Node*>(index.internalPointer()) : m_root.get();
+}
+
+
+//------------------------------------------------------------------------------
+TopicTreeModel::Node* TopicTreeModel::child(Node* parent, int row) const
+{
+    std::unique_ptr<Node>& slot = parent->children[row];
+    if (!slot)
+    {
+        slot.reset(new Node);
+        slot->parent = parent;
+        slot->row = row;
+        if (parent->tree)
+        {
+            slot->tree = parent->tree->getMember(static_cast<size_t>(row));
+        }
+        else if (parent->flat)
+        {
+            slot->flat = parent->flat.getMember(static_cast<size_t>(row));
+        }
+        readNode(*slot);
+    }
+    return slot.get();
+}
+
+
+/**
+ * @}
+ */
@@ -0,0 +1,205 @@
+#ifndef DDS_TOPIC_TREE_MODEL_H
+#define DDS_TOPIC_TREE_MODEL_H
+
+#include "first_define.h"
+#include "flat_sample.h"
+
+#include <QAbstractItemModel>
+#include <QStringList>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class OpenDynamicData;
+
+
+/**
+ * @brief Hierarchical, read-only item model for DDS topic samples.
+ * @details Unlike TopicTableModel, which flattens the whole sample into one
+ *          row per primitive, this model mirrors the sample structure and only
+ *          creates the node of a member when the view asks for it, which it
+ *          does for the visible rows of expanded parents. Collection sizes are
+ *          read from the member length, so nothing is walked ahead of time and
+ *          setting a sample costs the same no matter how large it is.
+ *
+ *          Flat samples are read in place. When a new sample of the topic is
+ *          set, the nodes created so far are pointed at the new sample, so the
+ *          expanded rows stay expanded while the values update.
+ */
+class TopicTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+
+    /// Table column IDs for this data model
+    enum eColumnIds
+    {
+        NAME_COLUMN,
+        TYPE_COLUMN,
+        VALUE_COLUMN,
+        MAX_eColumnIds_VALUE
+    };
+
+    /// The item role holding the full member name, such as "a.b[3].c".
+    static const int FULL_NAME_ROLE = Qt::UserRole;
+
+    /**
+     * @brief Constructor for the DDS sample tree model.
+     * @param[in] parent The parent for this data model.
+     */
+    explicit TopicTreeModel(QObject* parent = 0);
+
+    /**
+     * @brief Destructor for the DDS sample tree model.
+     */
+    ~TopicTreeModel();
+
+    /**
+     * @brief Show a decoded sample.
+     * @param[in] sample The new DDS data sample.
+     */
+    void setSample(const std::shared_ptr<OpenDynamicData>& sample);
+
+    /**
+     * @brief Show a flat sample without building its tree.
+     * @param[in] sample The new DDS data sample.
+     */
+    void setSample(const std::shared_ptr<const FlatSample>& sample);
+
+    /**
+     * @brief Standard index lookup. Creates the node on first use.
+     * @param[in] row The child row.
+     * @param[in] column The column.
+     * @param[in] parent The parent model index.
+     * @return The model index.
+     */
+    QModelIndex index(int row,
+                      int column,
+                      const QModelIndex& parent = QModelIndex()) const override;
+
+    /**
+     * @brief Standard parent lookup.
+     * @param[in] index The child model index.
+     * @return The parent model index.
+     */
+    QModelIndex parent(const QModelIndex& index) const override;
+
+    /**
+     * @brief Standard row count, read from the member length.
+     * @param[in] parent The parent model index.
+     * @return The number of children of the parent.
+     */
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    /**
+     * @brief Standard column count.
+     * @param[in] parent The parent model index.
+     * @return The total number of columns.
+     */
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    /**
+     * @brief Return the data for a specific tree cell.
+     * @param[in] index Obtain data for this model index.
+     * @param[in] role The item data role. FULL_NAME_ROLE returns the
+     *            member path.
+     * @return The cell data.
+     */
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Method to obtain the column headers.
+     * @param[in] section The column number to return the header for.
+     * @param[in] orientation Only Qt::Horizontal has headers.
+     * @param[in] role The item data role.
+     * @return Returns the string for the column header.
+     */
+    QVariant headerData(int section,
+                        Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+private:
+
+    /// One member of the sample that the view has asked for.
+    struct Node
+    {
+        /// The parent node, or nullptr for the root.
+        Node* parent = nullptr;
+
+        /// The row of this node under its parent.
+        int row = 0;
+
+        /// The member, for decoded samples.
+        std::shared_ptr<OpenDynamicData> tree;
+
+        /// The member, for flat samples.
+        FlatSample::Member flat;
+
+        /// The member name, or "[i]" for an element.
+        QString name;
+
+        /// The member path, as used by CommonData::readValue.
+        QString fullName;
+
+        /// The member type.
+        CORBA::TCKind kind = CORBA::tk_null;
+
+        /// The number of children of the member.
+        int childCount = 0;
+
+        /// The children created so far, by row.
+        std::unordered_map<int, std::unique_ptr<Node>> children;
+    };
+
+    /**
+     * @brief Point a node at the current sample and read its name and size.
+     * @param[in,out] node The node. Its tree or flat member must be set.
+     */
+    void readNode(Node& node) const;
+
+    /**
+     * @brief Point the created nodes at the members of a new sample.
+     * @param[in,out] node The node to update. Its member is already set.
+     * @param[out] removed Receives the nodes that no longer exist.
+     */
+    void rebind(Node& node, std::vector<std::unique_ptr<Node>>& removed);
+
+    /**
+     * @brief Replace the root after a new sample was set.
+     * @param[in] root The root of the new sample.
+     */
+    void setRoot(std::unique_ptr<Node> root);
+
+    /**
+     * @brief Get the node of a model index.
+     * @param[in] index The model index.
+     * @return The node, or the root for an invalid index.
+     */
+    Node* nodeAt(const QModelIndex& index) const;
+
+    /**
+     * @brief Get a child node, creating it on first use.
+     * @param[in] parent The parent node.
+     * @param[in] row The child row.
+     * @return The child node.
+     */
+    Node* child(Node* parent, int row) const;
+
+    /// Stores the names of all column titles
+    QStringList m_columnHeaders;
+
+    /// Keeps the flat sample alive while its members are shown.
+    std::shared_ptr<const FlatSample> m_flatSample;
+
+    /// The root struct of the sample. Not shown as a row.
+    std::unique_ptr<Node> m_root;
+
+}; // End class TopicTreeModel
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,126 @@
+#include "tracked_column.h"
+#include "member_accessor.h"
+#include "topic_sample_store.h"
+
+
+//------------------------------------------------------------------------------
+TrackedColumn::TrackedColumn(const std::shared_ptr<const MemberAccessor>& accessor,
+                             ColumnType type,
+                             size_t capacity)
+    : m_accessor(accessor)
+    , m_type(type)
+    , m_points(capacity)
+{}
+
+
+//------------------------------------------------------------------------------
+void TrackedColumn::append(const TopicSample& slot, const std::shared_ptr<OpenDynamicData>& tree)
+{
+    if (m_points.size() > 0 && slot.sequence <= m_points.at(0).sequence)
+    {
+        return;
+    }
+
+    Point point;
+    point.time = slot.sourceTime;
+    point.sequence = slot.sequence;
+
+    switch (m_type)
+    {
+    case ColumnType::Double:
+    case ColumnType::Float:
+    {
+        double value = 0;
+        if (!m_accessor->readNumber(slot, tree, value))
+        {
+            return;
+        }
+        std::memcpy(&point.bits, &value, sizeof(value));
+        break;
+    }
+    case ColumnType::Int64:
+    {
+        int64_t value = 0;
+        if (!m_accessor->readNumber(slot, tree, value))
+        {
+            return;
+        }
+        point.bits = static_cast<uint64_t>(value);
+        break;
+    }
+    case ColumnType::UInt64:
+        if (!m_accessor->readNumber(slot, tree, point.bits))
+        {
+            return;
+        }
+        break;
+    }
+
+    m_points.push(point);
+}
+
+
+//------------------------------------------------------------------------------
+void TrackedColumn::backfill(const TrackedColumn& older)
+{
+    // Everything at or after the oldest point here is already in this column
+    const uint64_t first = m_points.size() == 0
+        ? UINT64_MAX
+        : m_points.at(m_points.size() - 1).sequence;
+
+    SampleRing<Point> merged(m_points.capacity());
+    for (size_t i = older.m_points.size(); i > 0; --i)
+    {
+        const Point& point = older.m_points.at(i - 1);
+        if (point.sequence < first)
+        {
+            merged.push(point);
+        }
+    }
+    for (size_t i = m_points.size(); i > 0; --i)
+    {
+        merged.push(m_points.at(i - 1));
+    }
+
+    std::swap(m_points, merged);
+}
+
+
+//------------------------------------------------------------------------------
+const std::shared_ptr<const MemberAccessor>& TrackedColumn::accessor() const
+{
+    return m_accessor;
+}
+
+
+//------------------------------------------------------------------------------
+ColumnType TrackedColumn::type() const
+{
+    return m_type;
+}
+
+
+//------------------------------------------------------------------------------
+size_t TrackedColumn::size() const
+{
+    return m_points.size();
+}
+
+
+//------------------------------------------------------------------------------
+size_t TrackedColumn::bytes() const
+{
+    return sizeof(TrackedColumn) + m_points.allocated() * sizeof(Point);
+}
+
+
+//------------------------------------------------------------------------------
+void TrackedColumn::clear()
+{
+    m_points.clear();
+}
+
+
+/**
+ * @}
+ */
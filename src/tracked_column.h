@@ -0,0 +1,204 @@
+#ifndef __TRACKED_COLUMN_H__
+#define __TRACKED_COLUMN_H__
+
+#include "sample_ring.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+class MemberAccessor;
+class OpenDynamicData;
+struct TopicSample;
+
+
+/// The storage type of a tracked member column.
+enum class ColumnType
+{
+    Double,
+    /// Stored as a double. Tells consumers to format the values as float.
+    Float,
+    Int64,
+    UInt64
+};
+
+
+/**
+ * @brief Time series of one numeric topic member, filled as samples arrive.
+ * @details Each point is a source timestamp and the raw 8-byte value, stored
+ *          in a ring that grows up to the column capacity, so a tracked
+ *          member costs 24 bytes per point, sequence included, no matter
+ *          how large the sample is. Consumers read the points without
+ *          walking any sample.
+ * @remarks This class is not thread safe. TopicSampleStore serializes access.
+ */
+class TrackedColumn
+{
+public:
+
+    /**
+     * @brief Constructor for the tracked column.
+     * @param[in] accessor The member to track.
+     * @param[in] type The storage type of the values.
+     * @param[in] capacity The maximum number of points to keep.
+     */
+    TrackedColumn(const std::shared_ptr<const MemberAccessor>& accessor,
+                  ColumnType type,
+                  size_t capacity);
+
+    /**
+     * @brief Append the value of a new sample. Missing values are skipped.
+     * @details A sample that is not newer than the last point, by sequence,
+     *          is skipped too, so the points stay ordered and unique while
+     *          the column is backfilled.
+     * @param[in] slot The new history slot.
+     * @param[in] tree The decoded tree of the slot, if it is not stored flat.
+     */
+    void append(const TopicSample& slot, const std::shared_ptr<OpenDynamicData>& tree);
+
+    /**
+     * @brief Insert the points of an older column before the current ones.
+     * @details Points of samples that are already in this column, matched by
+     *          sequence, are skipped. The newest points are kept if the
+     *          result exceeds the capacity.
+     * @param[in] older A column filled from samples stored before the first
+     *            point of this column.
+     */
+    void backfill(const TrackedColumn& older);
+
+    /**
+     * @brief Copy the newest points, oldest first.
+     * @param[out] times The source timestamps in nanoseconds.
+     * @param[out] values The values converted to T.
+     * @param[in] maxCount The maximum number of points to copy.
+     * @return The number of points copied.
+     */
+    template<typename T>
+    int copy(QVector<int64_t>& times, QVector<T>& values, size_t maxCount) const
+    {
+        const size_t count = std::min(maxCount, m_points.size());
+        times.resize(static_cast<int>(count));
+        values.resize(static_cast<int>(count));
+
+        int64_t* timeData = times.data();
+        T* valueData = values.data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Point& point = m_points.at(count - 1 - i);
+            timeData[i] = point.time;
+            valueData[i] = convert<T>(point.bits);
+        }
+        return static_cast<int>(count);
+    }
+
+    /**
+     * @brief Copy the points of the samples stored after a cursor, oldest first.
+     * @param[in] sequence The sequence of the newest sample already read.
+     * @param[out] sequences The sequence of the sample of each point.
+     * @param[out] values The values converted to T.
+     * @return The number of points copied.
+     */
+    template<typename T>
+    int copySince(uint64_t sequence, QVector<uint64_t>& sequences, QVector<T>& values) const
+    {
+        // The points are ordered by sequence, so only the new ones are visited
+        size_t count = 0;
+        while (count < m_points.size() && m_points.at(count).sequence > sequence)
+        {
+            ++count;
+        }
+
+        sequences.resize(static_cast<int>(count));
+        values.resize(static_cast<int>(count));
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Point& point = m_points.at(count - 1 - i);
+            sequences[static_cast<int>(i)] = point.sequence;
+            values[static_cast<int>(i)] = convert<T>(point.bits);
+        }
+        return static_cast<int>(count);
+    }
+
+    /**
+     * @brief Get the tracked member.
+     * @return The member accessor.
+     */
+    const std::shared_ptr<const MemberAccessor>& accessor() const;
+
+    /**
+     * @brief Get the storage type of the values.
+     * @return The column type.
+     */
+    ColumnType type() const;
+
+    /**
+     * @brief Get the number of stored points.
+     * @return The number of points.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the memory held by the column.
+     * @return The size in bytes.
+     */
+    size_t bytes() const;
+
+    /**
+     * @brief Delete all points while keeping the storage.
+     */
+    void clear();
+
+private:
+
+    /// One timestamped value. The value bits are interpreted through m_type.
+    struct Point
+    {
+        int64_t time = 0;
+        uint64_t bits = 0;
+        uint64_t sequence = 0;
+    };
+
+    /**
+     * @brief Convert the stored bits of a value.
+     * @param[in] bits The stored bits.
+     * @return The value converted to T.
+     */
+    template<typename T>
+    T convert(uint64_t bits) const
+    {
+        switch (m_type)
+        {
+        case ColumnType::Double:
+        case ColumnType::Float:
+        {
+            double value = 0;
+            std::memcpy(&value, &bits, sizeof(value));
+            return static_cast<T>(value);
+        }
+        case ColumnType::Int64:
+            return static_cast<T>(static_cast<int64_t>(bits));
+        case ColumnType::UInt64:
+        default:
+            return static_cast<T>(bits);
+        }
+    }
+
+    /// The tracked member.
+    std::shared_ptr<const MemberAccessor> m_accessor;
+
+    /// The storage type of the values.
+    ColumnType m_type;
+
+    /// The points. Index 0 is the newest.
+    SampleRing<Point> m_points;
+
+}; // End class TrackedColumn
+
+#endif
+
+/**
+ * @}
+ */
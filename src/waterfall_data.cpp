@@ -0,0 +1,184 @@
+#include "waterfall_data.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+//------------------------------------------------------------------------------
+WaterfallData::WaterfallData(size_t width, size_t capacity)
+    : m_width(std::max<size_t>(width, 1))
+    , m_capacity(std::max<size_t>(capacity, 1))
+    , m_cells(m_width * m_capacity, 0.0)
+    , m_newestRow(0)
+    , m_times(m_capacity)
+    , m_minValue(std::numeric_limits<double>::infinity())
+    , m_maxValue(-std::numeric_limits<double>::infinity())
+    , m_lastY(std::numeric_limits<double>::quiet_NaN())
+    , m_lastRow(-1)
+{
+    updateIntervals();
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallData::appendRow(double time, const double* values)
+{
+    m_newestRow = (m_times.size() == 0) ? 0 : (m_newestRow + 1) % m_capacity;
+    m_times.push(time);
+
+    double* row = m_cells.data() + m_newestRow * m_width;
+    for (size_t i = 0; i < m_width; ++i)
+    {
+        const double value = values[i];
+        row[i] = value;
+        if (std::isfinite(value))
+        {
+            m_minValue = std::min(m_minValue, value);
+            m_maxValue = std::max(m_maxValue, value);
+        }
+    }
+
+    // Every stored index moved by one
+    m_lastY = std::numeric_limits<double>::quiet_NaN();
+}
+
+
+//------------------------------------------------------------------------------
+size_t WaterfallData::width() const
+{
+    return m_width;
+}
+
+
+//------------------------------------------------------------------------------
+size_t WaterfallData::rowCount() const
+{
+    return m_times.size();
+}
+
+
+//------------------------------------------------------------------------------
+double WaterfallData::time(size_t index) const
+{
+    return m_times.at(index);
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallData::clear()
+{
+    m_times.clear();
+    m_newestRow = 0;
+    m_minValue = std::numeric_limits<double>::infinity();
+    m_maxValue = -std::numeric_limits<double>::infinity();
+    m_lastY = std::numeric_limits<double>::quiet_NaN();
+    updateIntervals();
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallData::updateIntervals()
+{
+    m_intervals[Qt::XAxis] = QwtInterval(0.0, static_cast<double>(m_width));
+
+    if (m_times.size() > 0)
+    {
+        m_intervals[Qt::YAxis] = QwtInterval(m_times.at(m_times.size() - 1), m_times.at(0));
+    }
+    else
+    {
+        m_intervals[Qt::YAxis] = QwtInterval(0.0, 1.0);
+    }
+
+    m_intervals[Qt::ZAxis] = valueRange();
+
+#if QWT_VERSION < 0x060200
+    setInterval(Qt::XAxis, m_intervals[Qt::XAxis]);
+    setInterval(Qt::YAxis, m_intervals[Qt::YAxis]);
+    setInterval(Qt::ZAxis, m_intervals[Qt::ZAxis]);
+#endif
+}
+
+
+//------------------------------------------------------------------------------
+QwtInterval WaterfallData::valueRange() const
+{
+    if (m_minValue > m_maxValue)
+    {
+        return QwtInterval(0.0, 1.0);
+    }
+
+    // A flat row still needs a range to map colors over
+    if (m_minValue == m_maxValue)
+    {
+        return QwtInterval(m_minValue - 0.5, m_maxValue + 0.5);
+    }
+    return QwtInterval(m_minValue, m_maxValue);
+}
+
+
+//------------------------------------------------------------------------------
+double WaterfallData::value(double x, double y) const
+{
+    const double column = std::floor(x);
+    if (!(column >= 0.0 && column < static_cast<double>(m_width)))
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const long index = rowAt(y);
+    if (index < 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const size_t row = (m_newestRow + m_capacity - static_cast<size_t>(index)) % m_capacity;
+    return m_cells[row * m_width + static_cast<size_t>(column)];
+}
+
+
+#if QWT_VERSION >= 0x060200
+//------------------------------------------------------------------------------
+QwtInterval WaterfallData::interval(Qt::Axis axis) const
+{
+    return m_intervals[axis];
+}
+#endif
+
+
+//------------------------------------------------------------------------------
+long WaterfallData::rowAt(double y) const
+{
+    if (y == m_lastY)
+    {
+        return m_lastRow;
+    }
+
+    // Row i covers the time from its own timestamp to that of the next row.
+    // The times decrease with the index, so find the newest row at or before y.
+    const size_t count = m_times.size();
+    size_t low = 0;
+    size_t high = count;
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (m_times.at(middle) > y)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    m_lastY = y;
+    m_lastRow = (low < count) ? static_cast<long>(low) : -1;
+    return m_lastRow;
+}
+
+
+/**
+ * @}
+ */
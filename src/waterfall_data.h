@@ -0,0 +1,149 @@
+#ifndef __WATERFALL_DATA_H__
+#define __WATERFALL_DATA_H__
+
+#include "sample_ring.h"
+
+#ifdef __GNUG__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+#include <qwt_raster_data.h>
+#include <qwt_interval.h>
+#ifdef __GNUG__
+#pragma GCC diagnostic pop
+#endif
+
+#include <vector>
+
+
+/**
+ * @brief Circular row history of an array member, drawn as a spectrogram.
+ * @details Each row holds every element of one sample. The rows are stored
+ *          back to back in one preallocated buffer, and new rows overwrite
+ *          the oldest ones once the history is full, so adding a row is
+ *          O(width) and nothing is shifted. The x axis is the element index
+ *          and the y axis is the source time of the row in seconds.
+ * @remarks The raster is read from one thread at a time. QwtPlotSpectrogram
+ *          renders with one thread by default.
+ */
+class WaterfallData : public QwtRasterData
+{
+public:
+
+    /**
+     * @brief Constructor for the waterfall data.
+     * @param[in] width The number of elements per row.
+     * @param[in] capacity The maximum number of rows to keep.
+     */
+    WaterfallData(size_t width, size_t capacity);
+
+    /**
+     * @brief Add a new row, replacing the oldest one if the history is full.
+     * @param[in] time The source time of the row in seconds.
+     * @param[in] values The row elements. Must hold width() values.
+     */
+    void appendRow(double time, const double* values);
+
+    /**
+     * @brief Get the number of elements per row.
+     * @return The row width.
+     */
+    size_t width() const;
+
+    /**
+     * @brief Get the number of stored rows.
+     * @return The number of rows in the history.
+     */
+    size_t rowCount() const;
+
+    /**
+     * @brief Get the source time of a stored row.
+     * @param[in] index The row index. 0 is the newest.
+     * @return The time in seconds. The index must be less than rowCount().
+     */
+    double time(size_t index) const;
+
+    /**
+     * @brief Delete all rows and reset the value range.
+     */
+    void clear();
+
+    /**
+     * @brief Update the intervals of the axes from the stored rows.
+     * @details Called once per frame after new rows were added.
+     */
+    void updateIntervals();
+
+    /**
+     * @brief Get the range of the values seen since the last clear.
+     * @return The value interval.
+     */
+    QwtInterval valueRange() const;
+
+    /**
+     * @brief Get the value of the element at a point.
+     * @remarks Reimplemented from QwtRasterData.
+     * @param[in] x The element index.
+     * @param[in] y The time in seconds.
+     * @return The element value, or NaN outside of the history.
+     */
+    double value(double x, double y) const override;
+
+#if QWT_VERSION >= 0x060200
+    /**
+     * @brief Get the bounding interval of an axis.
+     * @remarks Reimplemented from QwtRasterData.
+     * @param[in] axis The axis.
+     * @return The interval.
+     */
+    QwtInterval interval(Qt::Axis axis) const override;
+#endif
+
+private:
+
+    /**
+     * @brief Find the row displayed at a time.
+     * @details The raster is drawn one pixel row at a time, so the last
+     *          lookup is cached and most calls skip the search.
+     * @param[in] y The time in seconds.
+     * @return The row index, or -1 if the time is older than the history.
+     */
+    long rowAt(double y) const;
+
+    /// The number of elements per row.
+    size_t m_width;
+
+    /// The maximum number of rows.
+    size_t m_capacity;
+
+    /// The rows, m_width values each, in ring order.
+    std::vector<double> m_cells;
+
+    /// The position of the newest row in m_cells.
+    size_t m_newestRow;
+
+    /// The row times in seconds. Index 0 is the newest.
+    SampleRing<double> m_times;
+
+    /// The lowest value seen since the last clear.
+    double m_minValue;
+
+    /// The highest value seen since the last clear.
+    double m_maxValue;
+
+    /// The axis intervals, indexed by Qt::Axis.
+    QwtInterval m_intervals[3];
+
+    /// The time of the last row lookup.
+    mutable double m_lastY;
+
+    /// The row found by the last lookup.
+    mutable long m_lastRow;
+
+}; // End class WaterfallData
+
+#endif
+
+/**
+ * @}
+ */
@@ -0,0 +1,217 @@
+#include "waterfall_page.h"
+#include "waterfall_data.h"
+#include "member_accessor.h"
+#include "dds_data.h"
+
+#include <QDateTime>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QIcon>
+
+#ifdef __GNUG__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+#include <qwt_plot_layout.h>
+#include <qwt_scale_widget.h>
+#include <qwt_scale_draw.h>
+#include <qwt_color_map.h>
+#ifdef __GNUG__
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+
+
+namespace
+{
+
+/**
+ * @brief Axis labels showing a source timestamp in seconds as the time of day.
+ */
+class TimeOfDayScaleDraw : public QwtScaleDraw
+{
+public:
+
+    /**
+     * @brief Return the label string for the passed in value.
+     * @remarks Reimplemented from QwtAbstractScaleDraw.
+     * @param[in] value The time in seconds since the Unix epoch.
+     * @return The label string for the passed in value.
+     */
+    QwtText label(double value) const override
+    {
+        const QDateTime time =
+            QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(value * 1000.0));
+        return QwtText(time.toString("hh:mm:ss.zzz"));
+    }
+};
+
+/**
+ * @brief Create the color map shared by the heat map and its color bar.
+ * @return The color map. The caller takes ownership.
+ */
+QwtLinearColorMap* newColorMap()
+{
+    QwtLinearColorMap* colorMap = new QwtLinearColorMap(Qt::darkBlue, Qt::red);
+    colorMap->addColorStop(0.25, Qt::cyan);
+    colorMap->addColorStop(0.5, Qt::green);
+    colorMap->addColorStop(0.75, Qt::yellow);
+    return colorMap;
+}
+
+} // End namespace
+
+
+//------------------------------------------------------------------------------
+WaterfallPage::WaterfallPage(const QString& topicName,
+                             const QString& memberName,
+                             QWidget* parent) :
+    QWidget(parent),
+    m_topicName(topicName),
+    m_accessor(CommonData::compileMember(topicName, memberName)),
+    m_cursor(0),
+    m_matrix(new SampleMatrix),
+    m_plot(NULL),
+    m_spectrogram(NULL),
+    m_data(NULL),
+    m_colorRange(0.0, 1.0),
+    m_statusLabel(NULL),
+    m_clearButton(NULL),
+    m_refreshTimer(this)
+{
+    //--------------------------------------------------------------------------
+    // Build the plot
+    m_plot = new QwtPlot(this);
+    m_plot->setCanvasBackground(Qt::white);
+    m_plot->plotLayout()->setAlignCanvasToScales(true);
+    m_plot->setAxisTitle(QwtPlot::xBottom, memberName);
+    m_plot->setAxisScaleDraw(QwtPlot::yLeft, new TimeOfDayScaleDraw);
+
+    m_spectrogram = new QwtPlotSpectrogram(memberName);
+    m_spectrogram->setRenderThreadCount(1);
+    m_spectrogram->setColorMap(newColorMap());
+    m_spectrogram->attach(m_plot);
+
+    // Show the value range as a color bar on the right
+    QwtScaleWidget* colorBar = m_plot->axisWidget(QwtPlot::yRight);
+    colorBar->setColorBarEnabled(true);
+    m_plot->enableAxis(QwtPlot::yRight);
+    updateColorBar(m_colorRange);
+
+    m_statusLabel = new QLabel(this);
+    m_clearButton = new QPushButton(this);
+    m_clearButton->setIcon(QIcon(":/images/edit-clear.png"));
+    m_clearButton->setToolTip("Clear the history and the color range");
+    m_clearButton->setMaximumSize(35, 35);
+
+    QHBoxLayout* controlLayout = new QHBoxLayout;
+    controlLayout->addWidget(m_clearButton);
+    controlLayout->addWidget(m_statusLabel, 1);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->addWidget(m_plot, 1);
+    layout->addLayout(controlLayout);
+
+    if (!m_accessor || !m_accessor->isValid())
+    {
+        m_statusLabel->setText("Unknown member: " + memberName);
+    }
+
+
+    //--------------------------------------------------------------------------
+    // Connect all Qt signals and slots
+    connect(&m_refreshTimer, SIGNAL(timeout()),
+        this, SLOT(updateView()));
+    connect(m_clearButton, SIGNAL(clicked()),
+        this, SLOT(clearHistory()));
+
+    m_refreshTimer.start(REFRESH_TIMEOUT);
+
+} // End WaterfallPage::WaterfallPage
+
+
+//------------------------------------------------------------------------------
+WaterfallPage::~WaterfallPage()
+{
+    m_refreshTimer.stop();
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallPage::updateView()
+{
+    if (!m_accessor || !m_accessor->isValid())
+    {
+        return;
+    }
+
+    const int rows = CommonData::readMatrixSince(m_topicName, *m_accessor, m_cursor, *m_matrix);
+    if (rows == 0)
+    {
+        return;
+    }
+
+    // The member width is known once the first sample was read
+    const int width = m_matrix->width;
+    if (!m_data)
+    {
+        m_data = new WaterfallData(static_cast<size_t>(width), HISTORY_ROWS);
+        m_spectrogram->setData(m_data);
+        m_plot->setAxisScale(QwtPlot::xBottom, 0.0, width);
+    }
+
+    // Older rows of a large batch would be overwritten right away
+    const int firstRow = std::max(0, rows - HISTORY_ROWS);
+    const double* values = m_matrix->values.constData();
+    for (int row = firstRow; row < rows; ++row)
+    {
+        m_data->appendRow(m_matrix->sourceTimes.at(row) / 1.0e9,
+                          values + static_cast<size_t>(row) * width);
+    }
+    m_data->updateIntervals();
+
+    const QwtInterval timeRange = m_data->interval(Qt::YAxis);
+    m_plot->setAxisScale(QwtPlot::yLeft, timeRange.minValue(), timeRange.maxValue());
+
+    const QwtInterval valueRange = m_data->valueRange();
+    if (valueRange != m_colorRange)
+    {
+        updateColorBar(valueRange);
+    }
+
+    m_statusLabel->setText(QString::number(m_data->rowCount()) + " samples x " +
+                           QString::number(width) + " elements");
+    m_plot->replot();
+
+} // End WaterfallPage::updateView
+
+
+//------------------------------------------------------------------------------
+void WaterfallPage::clearHistory()
+{
+    if (!m_data)
+    {
+        return;
+    }
+
+    // Keep the cursor, so only new samples are shown
+    m_data->clear();
+    updateColorBar(m_data->valueRange());
+    m_statusLabel->clear();
+    m_plot->replot();
+}
+
+
+//------------------------------------------------------------------------------
+void WaterfallPage::updateColorBar(const QwtInterval& range)
+{
+    m_colorRange = range;
+    m_plot->axisWidget(QwtPlot::yRight)->setColorMap(range, newColorMap());
+    m_plot->setAxisScale(QwtPlot::yRight, range.minValue(), range.maxValue());
+}
+
+
+/**
+ * @}
+ */
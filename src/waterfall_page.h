@@ -0,0 +1,129 @@
+#ifndef DEF_WATERFALL_PAGE_WIDGET
+#define DEF_WATERFALL_PAGE_WIDGET
+
+#include "first_define.h"
+
+#include <QPushButton>
+#include <QString>
+#include <QWidget>
+#include <QLabel>
+#include <QTimer>
+
+#ifdef __GNUG__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+#include <qwt_plot_spectrogram.h>
+#include <qwt_interval.h>
+#include <qwt_plot.h>
+#ifdef __GNUG__
+#pragma GCC diagnostic pop
+#endif
+
+#include <cstdint>
+#include <memory>
+
+class MemberAccessor;
+class WaterfallData;
+struct SampleMatrix;
+
+
+//------------------------------------------------------------------------------
+// class WaterfallPage
+//------------------------------------------------------------------------------
+/**
+ * @brief Scrolling heat map of an array or sequence topic member.
+ * @details Each sample adds one row holding every element of the member, with
+ *          the element index along the x axis and the source time along the
+ *          y axis, newest at the top. The rows are read in bulk with
+ *          CommonData::readMatrixSince, one contiguous run per sample, and
+ *          the plot is redrawn at most once per refresh.
+ */
+class WaterfallPage : public QWidget
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Constructor for WaterfallPage.
+     * @param[in] topicName The DDS topic name.
+     * @param[in] memberName The array or sequence member, such as "a.data".
+     * @param[in] parent The parent of this Qt object.
+     */
+    WaterfallPage(const QString& topicName,
+                  const QString& memberName,
+                  QWidget* parent = 0);
+
+    /**
+     * @brief Destructor for WaterfallPage.
+     */
+    ~WaterfallPage();
+
+private slots:
+
+    /**
+     * @brief Add the rows of every sample that arrived since the last refresh.
+     * @remarks This is called from the m_refreshTimer timer.
+     */
+    void updateView();
+
+    /**
+     * @brief Delete the stored rows and reset the color range.
+     */
+    void clearHistory();
+
+private:
+
+    /**
+     * @brief Update the color bar after the value range changed.
+     * @param[in] range The value range.
+     */
+    void updateColorBar(const QwtInterval& range);
+
+    /// The number of MS to wait between refreshes.
+    static const int REFRESH_TIMEOUT = 33;
+
+    /// The maximum number of rows kept.
+    static const int HISTORY_ROWS = 1024;
+
+    /// The name of the displayed topic.
+    QString m_topicName;
+
+    /// The displayed member.
+    std::shared_ptr<const MemberAccessor> m_accessor;
+
+    /// The sequence of the newest sample read.
+    uint64_t m_cursor;
+
+    /// Receives the rows read on each refresh. Keeps the member width.
+    std::unique_ptr<SampleMatrix> m_matrix;
+
+    /// The plot widget.
+    QwtPlot* m_plot;
+
+    /// Draws the rows as a heat map.
+    QwtPlotSpectrogram* m_spectrogram;
+
+    /// The row history. Owned by m_spectrogram; created with the first row.
+    WaterfallData* m_data;
+
+    /// The value range shown on the color bar.
+    QwtInterval m_colorRange;
+
+    /// Shows the size of the stored history.
+    QLabel* m_statusLabel;
+
+    /// Deletes the stored rows.
+    QPushButton* m_clearButton;
+
+    /// Refresh timer for the view.
+    QTimer m_refreshTimer;
+
+}; // End class WaterfallPage
+
+#endif
+
+/**
+ * @}
+ */
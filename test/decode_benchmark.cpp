@@ -0,0 +1,173 @@
+#include "common.h"
+
+#include "testTypeSupportImpl.h"
+
+#include <decode_plan.h>
+#include <flat_sample.h>
+#include <open_dynamic_data.h>
+#include <serialized_sample.h>
+
+#include <dds/DCPS/Message_Block_Ptr.h>
+
+#include <tao/CDR.h>
+
+#include <ace/OS_main.h>
+#include <ace/OS_NS_stdlib.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+// Compares the per-sample OpenDynamicData decoding used before decode plans
+// with DecodePlan and FlatSample on the test topic types, and checks all of
+// them give equal trees.
+
+namespace {
+
+const OpenDDS::DCPS::Encoding::Kind encoding_kind = OpenDDS::DCPS::Encoding::KIND_XCDR2;
+const OpenDDS::DCPS::Endianness endianness = OpenDDS::DCPS::ENDIAN_NATIVE;
+const OpenDDS::DCPS::Extensibility extensibility = OpenDDS::DCPS::Extensibility::APPENDABLE;
+
+template <typename T>
+OpenDDS::DCPS::Message_Block_Ptr serialize(const T& message)
+{
+  const OpenDDS::DCPS::Encoding encoding(encoding_kind, endianness);
+  OpenDDS::DCPS::Message_Block_Ptr block(
+    new ACE_Message_Block(OpenDDS::DCPS::serialized_size(encoding, message)));
+  OpenDDS::DCPS::Serializer serializer(block.get(), encoding);
+  if (!(serializer << message)) {
+    std::cerr << "Error: failed to serialize sample" << std::endl;
+    std::exit(1);
+  }
+  return block;
+}
+
+// A TypeCode read back from CDR, like TopicInfo extracts it from the topic
+// user data. Unlike the static _tc_ codes it is reference counted, so decoding
+// with it catches references that are released without being owned.
+CORBA::TypeCode_var round_trip(CORBA::TypeCode_ptr tc)
+{
+  TAO_OutputCDR out;
+  if (!(out << tc)) {
+    std::cerr << "Error: failed to serialize TypeCode" << std::endl;
+    std::exit(1);
+  }
+
+  TAO_InputCDR in(out);
+  CORBA::TypeCode_ptr result = CORBA::TypeCode::_nil();
+  if (!(in >> result)) {
+    std::cerr << "Error: failed to deserialize TypeCode" << std::endl;
+    std::exit(1);
+  }
+  return result;
+}
+
+// The decoding TopicMonitor did for every sample before decode plans existed
+std::shared_ptr<OpenDynamicData> legacy_decode(const ACE_Message_Block& block, const CORBA::TypeCode_var& type_code)
+{
+  OpenDDS::DCPS::Message_Block_Ptr payload(block.duplicate());
+  OpenDDS::DCPS::Serializer serializer(payload.get(), encoding_kind, endianness);
+
+  std::shared_ptr<OpenDynamicData> sample = CreateOpenDynamicData(type_code, encoding_kind, extensibility);
+  uint32_t delim_header = 0;
+  if (!(serializer >> delim_header)) {
+    return std::shared_ptr<OpenDynamicData>();
+  }
+  (*sample) << serializer;
+  return sample;
+}
+
+std::shared_ptr<OpenDynamicData> plan_decode(const ACE_Message_Block& block, const DecodePlan& plan)
+{
+  OpenDDS::DCPS::Message_Block_Ptr payload(block.duplicate());
+  return SerializedSample::decode(payload.get(), plan, endianness);
+}
+
+std::shared_ptr<FlatSample> flat_decode(const ACE_Message_Block& block, const DecodePlan& plan,
+                                        const std::shared_ptr<FlatSamplePool>& pool)
+{
+  OpenDDS::DCPS::Message_Block_Ptr payload(block.duplicate());
+  return SerializedSample::decodeFlat(payload.get(), plan, pool, endianness);
+}
+
+template <typename Decode>
+double time_decodes(int iterations, Decode decode)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    if (!decode()) {
+      std::cerr << "Error: decode failed" << std::endl;
+      std::exit(1);
+    }
+  }
+  const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+bool run(const char* name, const ACE_Message_Block& block, CORBA::TypeCode_ptr tc, int iterations)
+{
+  const CORBA::TypeCode_var type_code = CORBA::TypeCode::_duplicate(tc);
+  const std::shared_ptr<const DecodePlan> plan =
+    std::make_shared<DecodePlan>(type_code, encoding_kind, extensibility);
+  const std::shared_ptr<FlatSamplePool> pool = std::make_shared<FlatSamplePool>();
+
+  std::shared_ptr<OpenDynamicData> expected = legacy_decode(block, type_code);
+  std::shared_ptr<OpenDynamicData> actual = plan_decode(block, *plan);
+  if (!expected || !actual || !(*expected == *actual)) {
+    std::cerr << "Error: " << name << " decodes differ" << std::endl;
+    return false;
+  }
+
+  std::shared_ptr<FlatSample> flat = flat_decode(block, *plan, pool);
+  if (!flat || !(*expected == *flat->toOpenDynamicData())) {
+    std::cerr << "Error: " << name << " flat decode differs" << std::endl;
+    return false;
+  }
+  flat.reset();
+
+  const double legacy_us = time_decodes(iterations, [&]() { return legacy_decode(block, type_code) != nullptr; });
+  const double plan_us = time_decodes(iterations, [&]() { return plan_decode(block, *plan) != nullptr; });
+  const double flat_us = time_decodes(iterations, [&]() { return flat_decode(block, *plan, pool) != nullptr; });
+
+  std::cout << name << " (" << block.length() << " bytes): "
+            << "operator<< " << legacy_us << " us, "
+            << "DecodePlan " << plan_us << " us, "
+            << "FlatSample " << flat_us << " us, "
+            << "speedup " << (plan_us > 0 ? legacy_us / plan_us : 0) << "x / "
+            << (flat_us > 0 ? legacy_us / flat_us : 0) << "x" << std::endl;
+  return true;
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  const int iterations = argc > 1 ? ACE_OS::atoi(argv[1]) : 100000;
+
+  std::mt19937 mt;
+  mt.seed(42);
+
+  test::BasicMessage basic_message{};
+  basic_message.origin = "decode_benchmark";
+  test::ComplexMessage complex_message{};
+  complex_message.origin = "decode_benchmark";
+
+  // A recursion limit of 1 leaves the union sequence empty, since
+  // OpenDynamicData does not decode unions.
+  generate_samples(mt, 1, 0, basic_message, complex_message);
+  generate_bt(mt, 1, complex_message.ct.bt);
+
+  const OpenDDS::DCPS::Message_Block_Ptr basic_block = serialize(basic_message);
+  const OpenDDS::DCPS::Message_Block_Ptr complex_block = serialize(complex_message);
+
+  bool ok = true;
+  ok &= run("test::BasicMessage", *basic_block, test::_tc_BasicMessage, iterations);
+  ok &= run("test::ComplexMessage", *complex_block, test::_tc_ComplexMessage, iterations);
+
+  const CORBA::TypeCode_var basic_tc = round_trip(test::_tc_BasicMessage);
+  const CORBA::TypeCode_var complex_tc = round_trip(test::_tc_ComplexMessage);
+  ok &= run("test::BasicMessage (CDR TypeCode)", *basic_block, basic_tc.in(), iterations);
+  ok &= run("test::ComplexMessage (CDR TypeCode)", *complex_block, complex_tc.in(), iterations);
+  return ok ? 0 : 1;
+}